@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <Visitable.hpp>
+#include <Visitor.hpp>
+
+// Argument passing benchmark: visit the same shuffled objects with 3 and 4
+// scalar arguments passed by value (default policy) and by rvalue reference
+// (arguments declared T &&, materialized in memory for the indirect call).
+// The objects are sorted by type so the indirect calls are well predicted and
+// the cost of the arguments is not hidden by mispredictions
+
+static constexpr std::size_t ObjectCount = 1u << 12; // Fits in the cache
+static constexpr int Passes = 5000;
+
+class Shape : public Visitable<Shape>
+{
+    public:
+        META_BaseVisitable(Shape)
+};
+
+template <int N>
+class Derived : public Shape
+{
+    public:
+        META_Visitable(Derived, Shape)
+};
+
+// Visitor taking the arguments as declared by Params
+template <typename ...Params>
+class SumVisitor : public Visitor<Shape, float, Params...>
+{
+    public:
+        META_Visitor(SumVisitor, visit)
+
+        SumVisitor()
+        {
+            VisitorVTableSetter<
+                SumVisitor, typename visitor_invoker_details::InvokerType,
+                Derived<0>, Derived<1>, Derived<2>, Derived<3>
+            >::SetVTable(*this);
+        }
+
+        float visit(Shape &, float x, float y, float z)
+        {
+            return x - y * z;
+        }
+
+        template <int N>
+        float visit(Derived<N> &, float x, float y, float z)
+        {
+            return x * (N + 1) + y * z;
+        }
+
+        float visit(Shape &, float x, float y, float z, int w)
+        {
+            return x - y * z - w;
+        }
+
+        template <int N>
+        float visit(Derived<N> &, float x, float y, float z, int w)
+        {
+            return x * (N + 1) + y * z + w;
+        }
+};
+
+std::vector<std::unique_ptr<Shape>> MakeObjects()
+{
+    std::mt19937 random(42u);
+    std::vector<std::unique_ptr<Shape>> objects;
+    objects.reserve(ObjectCount);
+
+    for(std::size_t i = 0; i < ObjectCount; ++i)
+    {
+        switch(random() % 5u)
+        {
+            case 0: objects.emplace_back(new Shape()); break;
+            case 1: objects.emplace_back(new Derived<0>()); break;
+            case 2: objects.emplace_back(new Derived<1>()); break;
+            case 3: objects.emplace_back(new Derived<2>()); break;
+            case 4: objects.emplace_back(new Derived<3>()); break;
+        }
+    }
+
+    std::sort(objects.begin(), objects.end(), [](
+        std::unique_ptr<Shape> const & a, std::unique_ptr<Shape> const & b
+    )
+    {
+        return a->visitable_tag() < b->visitable_tag();
+    });
+
+    return objects;
+}
+
+template <typename Visitor, typename ...Values>
+void Run(
+    char const * name,
+    std::vector<std::unique_ptr<Shape>> const & objects,
+    Values ...values
+)
+{
+    Visitor visitor;
+
+    auto const start = std::chrono::steady_clock::now();
+
+    double checksum = 0.0;
+    for(int pass = 0; pass < Passes; ++pass)
+    {
+        for(std::unique_ptr<Shape> const & object : objects)
+        {
+            checksum += visitor(*object, Values(values)...);
+        }
+    }
+
+    auto const end = std::chrono::steady_clock::now();
+
+    double const ns =
+        std::chrono::duration<double, std::nano>(end - start).count();
+
+    std::cout << name << ": " << ns / (Passes * ObjectCount)
+              << " ns per visit (checksum " << checksum << ")" << std::endl;
+}
+
+int main()
+{
+    std::vector<std::unique_ptr<Shape>> const objects = MakeObjects();
+
+    Run<SumVisitor<float, float, float>>(
+        "3 arguments, by value           ", objects, 1.f, 2.f, 0.5f
+    );
+    Run<SumVisitor<float &&, float &&, float &&>>(
+        "3 arguments, by rvalue reference", objects, 1.f, 2.f, 0.5f
+    );
+    Run<SumVisitor<float, float, float, int>>(
+        "4 arguments, by value           ", objects, 1.f, 2.f, 0.5f, 3
+    );
+    Run<SumVisitor<float &&, float &&, float &&, int &&>>(
+        "4 arguments, by rvalue reference", objects, 1.f, 2.f, 0.5f, 3
+    );
+
+    return 0;
+}
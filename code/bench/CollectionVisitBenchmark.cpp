@@ -0,0 +1,121 @@
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <Visitable.hpp>
+#include <VisitableCollection.hpp>
+#include <Visitor.hpp>
+
+// Visitation benchmark of 10M small nodes: one heap allocation per node
+// visited one by one, the same nodes visited by batch, and the nodes stored by
+// type in a VisitableCollection
+
+static constexpr std::size_t NodeCount = 10000000u;
+static constexpr int Passes = 5;
+
+class Node : public Visitable<Node>
+{
+    public:
+        META_BaseVisitable(Node)
+
+        virtual ~Node() { }
+
+        float value = 1.f;
+};
+
+template <int N>
+class Derived : public Node
+{
+    public:
+        META_Visitable(Derived, Node)
+};
+
+class UpdateVisitor : public Visitor<Node, void>
+{
+    public:
+        META_Visitor(UpdateVisitor, update)
+
+        UpdateVisitor()
+        {
+            META_Visitables(Derived<0>, Derived<1>, Derived<2>);
+        }
+
+        double sum = 0.0;
+
+    private:
+        void update(Node & node) { sum += node.value; }
+
+        template <int N>
+        void update(Derived<N> & node) { sum += node.value * (N + 2); }
+};
+
+template <typename Visit>
+void Run(char const * name, Visit visit)
+{
+    UpdateVisitor visitor;
+
+    auto const start = std::chrono::steady_clock::now();
+
+    for(int pass = 0; pass < Passes; ++pass) visit(visitor);
+
+    auto const end = std::chrono::steady_clock::now();
+
+    double const ns =
+        std::chrono::duration<double, std::nano>(end - start).count();
+
+    std::cout << name << ": " << ns / (Passes * NodeCount)
+              << " ns per visit (checksum " << visitor.sum << ")" << std::endl;
+}
+
+int main()
+{
+    std::mt19937 random(42u);
+
+    std::vector<std::unique_ptr<Node>> nodes;
+    VisitableCollection<Node> collection;
+
+    nodes.reserve(NodeCount);
+
+    for(std::size_t i = 0; i < NodeCount; ++i)
+    {
+        switch(random() % 4u)
+        {
+            case 0:
+                nodes.emplace_back(new Node());
+                collection.emplace<Node>();
+                break;
+            case 1:
+                nodes.emplace_back(new Derived<0>());
+                collection.emplace<Derived<0>>();
+                break;
+            case 2:
+                nodes.emplace_back(new Derived<1>());
+                collection.emplace<Derived<1>>();
+                break;
+            case 3:
+                nodes.emplace_back(new Derived<2>());
+                collection.emplace<Derived<2>>();
+                break;
+        }
+    }
+
+    Run("pointers  ", [&](UpdateVisitor & visitor)
+    {
+        for(std::unique_ptr<Node> const & node : nodes) visitor(*node);
+    });
+
+    Run("batch     ", [&](UpdateVisitor & visitor)
+    {
+        visitor.visitRange(nodes.begin(), nodes.end());
+    });
+
+    Run("collection", [&](UpdateVisitor & visitor)
+    {
+        visitor.visitCollection(collection);
+    });
+
+    return 0;
+}
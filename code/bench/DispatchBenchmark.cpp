@@ -0,0 +1,804 @@
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if __cplusplus >= 201703L
+    #include <variant>
+#endif
+
+#include <Visitable.hpp>
+#include <Visitor.hpp>
+
+// Dispatch benchmark suite: compare the cooperative visitor with a cyclic
+// visitor, an acyclic visitor based on dynamic_cast and std::visit (built in
+// C++17 only), over the depth and the width of the hierarchy, the number of
+// arguments of the visit methods and the entropy of the mix of visited types.
+//
+// Every hierarchy is made of a root class and <Width> chains of <Depth>
+// classes. The visitors handle the root and the first class of every chain,
+// so the deeper classes fall back to the first class of their chain.
+// The results are written as JSON on the standard output (or in the file
+// given as first argument).
+
+static constexpr std::size_t ObjectCount = 4096u;
+static constexpr std::size_t VisitsPerRun = 1u << 20;
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Configurations
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename ...>
+struct Types { };
+
+template <std::size_t ...>
+struct Indices { };
+
+template <std::size_t N, std::size_t ...I>
+struct MakeIndices: MakeIndices<N - 1, N - 1, I...> { };
+
+template <std::size_t ...I>
+struct MakeIndices<0, I...>
+{
+    using Type = Indices<I...>;
+};
+
+template <int N, typename ...A>
+struct FloatArgs
+{
+    using Type = typename FloatArgs<N - 1, float, A...>::Type;
+};
+
+template <typename ...A>
+struct FloatArgs<0, A...>
+{
+    using Type = Types<A...>;
+};
+
+template <int DepthValue, int WidthValue, int ArgCountValue>
+struct Config
+{
+    static constexpr int Depth = DepthValue;
+    static constexpr int Width = WidthValue;
+    static constexpr int ArgCount = ArgCountValue;
+
+    //! Number of classes of the hierarchy
+    static constexpr std::size_t Classes = 1u + DepthValue * WidthValue;
+
+    using Args = typename FloatArgs<ArgCountValue>::Type;
+};
+
+//! Level of the class of index K (0 is the root)
+template <typename C, std::size_t K>
+struct LevelOf
+{
+    static constexpr int value = K == 0u ? 0 : 1 + int(K - 1u) / C::Width;
+};
+
+//! Index in its level of the class of index K
+template <typename C, std::size_t K>
+struct IndexOf
+{
+    static constexpr int value = K == 0u ? 0 : int(K - 1u) % C::Width;
+};
+
+//! Work of the handler of a class: Handler is 0 for the root, the index of the
+/// chain + 1 for the other classes
+inline int Work(int value, int handler)
+{
+    return value * (handler + 1);
+}
+
+template <typename ...A>
+inline int Work(int value, int handler, float arg, A ...args)
+{
+    return Work(value, handler, args...) + static_cast<int>(arg);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Cooperative visitor
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename C, int L, int I>
+class CoopNode;
+
+template <typename C, int L, int I>
+struct CoopParent
+{
+    using Type = CoopNode<C, L - 1, I>;
+};
+
+template <typename C, int I>
+struct CoopParent<C, 1, I>
+{
+    using Type = CoopNode<C, 0, 0>;
+};
+
+template <typename C>
+class CoopNode<C, 0, 0> : public Visitable<CoopNode<C, 0, 0>>
+{
+    public:
+        META_BaseVisitable(CoopNode)
+
+        virtual ~CoopNode() { }
+
+        int value = 1;
+};
+
+template <typename C, int L, int I>
+class CoopNode : public CoopParent<C, L, I>::Type
+{
+    public:
+        using Parent = typename CoopParent<C, L, I>::Type;
+
+        META_Visitable(CoopNode, Parent)
+};
+
+template <typename C, typename ArgList = typename C::Args>
+class CoopVisitor;
+
+template <typename C, typename ...A>
+class CoopVisitor<C, Types<A...>> : public Visitor<CoopNode<C, 0, 0>, int, A...>
+{
+    public:
+        META_Visitor(CoopVisitor)
+
+        CoopVisitor()
+        {
+            this->setVTable(typename MakeIndices<C::Width>::Type());
+        }
+
+        int visit(CoopNode<C, 0, 0> & node, A ...args)
+        {
+            return Work(node.value, 0, args...);
+        }
+
+        template <int I>
+        int visit(CoopNode<C, 1, I> & node, A ...args)
+        {
+            return Work(node.value, I + 1, args...);
+        }
+
+    private:
+        // META_Visitables with the visitables generated from the indices
+        template <std::size_t ...I>
+        void setVTable(Indices<I...>)
+        {
+            VisitorVTableSetter<
+                CoopVisitor,
+                typename visitor_invoker_details::InvokerType,
+                CoopNode<C, 1, I>...
+            >::SetVTable(*this);
+        }
+};
+
+template <typename C>
+struct Cooperative
+{
+    using Base = CoopNode<C, 0, 0>;
+
+    template <std::size_t K>
+    using Node = CoopNode<C, LevelOf<C, K>::value, IndexOf<C, K>::value>;
+
+    static char const * Name() { return "cooperative"; }
+
+    template <typename ...A>
+    static int Visit(CoopVisitor<C> & visitor, Base & node, A ...args)
+    {
+        return visitor(node, std::move(args)...);
+    }
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Cyclic visitor (an interface method per class of the hierarchy)
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename C, int L, int I>
+class CyclicNode;
+
+//! Visit method of a class in the cyclic visitor interface
+template <typename Class, typename ArgList>
+struct CyclicVisitOf;
+
+template <typename Class, typename ...A>
+struct CyclicVisitOf<Class, Types<A...>>
+{
+    virtual ~CyclicVisitOf() { }
+    virtual int visit(Class & node, A ...args) = 0;
+};
+
+template <typename C, typename Classes>
+struct CyclicInterfaceOf;
+
+template <typename C, std::size_t ...K>
+struct CyclicInterfaceOf<C, Indices<K...>>
+{
+    struct Type : CyclicVisitOf<
+        CyclicNode<C, LevelOf<C, K>::value, IndexOf<C, K>::value>, typename C::Args
+    >... { };
+};
+
+//! Interface of the cyclic visitors: knows every class of the hierarchy
+template <typename C>
+using CyclicInterface =
+    typename CyclicInterfaceOf<C, typename MakeIndices<C::Classes>::Type>::Type;
+
+template <typename C, typename ArgList = typename C::Args>
+class CyclicRoot;
+
+template <typename C, typename ...A>
+class CyclicRoot<C, Types<A...>>
+{
+    public:
+        virtual ~CyclicRoot() { }
+        virtual int accept(CyclicInterface<C> & visitor, A ...args) = 0;
+
+        int value = 1;
+};
+
+//! Implement accept in every class
+template <typename Self, typename Parent, typename C, typename ArgList = typename C::Args>
+class CyclicAccept;
+
+template <typename Self, typename Parent, typename C, typename ...A>
+class CyclicAccept<Self, Parent, C, Types<A...>> : public Parent
+{
+    public:
+        int accept(CyclicInterface<C> & visitor, A ...args) override
+        {
+            return static_cast<CyclicVisitOf<Self, Types<A...>> &>(visitor).visit(
+                static_cast<Self &>(*this), args...
+            );
+        }
+};
+
+template <typename C, int L, int I>
+struct CyclicParent
+{
+    using Type = CyclicNode<C, L - 1, I>;
+};
+
+template <typename C, int I>
+struct CyclicParent<C, 1, I>
+{
+    using Type = CyclicNode<C, 0, 0>;
+};
+
+template <typename C>
+class CyclicNode<C, 0, 0> :
+    public CyclicAccept<CyclicNode<C, 0, 0>, CyclicRoot<C>, C>
+{
+
+};
+
+template <typename C, int L, int I>
+class CyclicNode :
+    public CyclicAccept<CyclicNode<C, L, I>, typename CyclicParent<C, L, I>::Type, C>
+{
+
+};
+
+//! Override the visit method of every class, forwarding to Impl::handle
+template <typename Impl, typename C, typename Classes, typename ArgList = typename C::Args>
+class CyclicChain;
+
+template <typename Impl, typename C, typename ...A>
+class CyclicChain<Impl, C, Indices<>, Types<A...>> : public CyclicInterface<C>
+{
+
+};
+
+template <typename Impl, typename C, std::size_t K, std::size_t ...Tail, typename ...A>
+class CyclicChain<Impl, C, Indices<K, Tail...>, Types<A...>> :
+    public CyclicChain<Impl, C, Indices<Tail...>, Types<A...>>
+{
+    public:
+        using Node = CyclicNode<C, LevelOf<C, K>::value, IndexOf<C, K>::value>;
+
+        int visit(Node & node, A ...args) override
+        {
+            return static_cast<Impl &>(*this).handle(node, args...);
+        }
+};
+
+template <typename C, typename ArgList = typename C::Args>
+class CyclicVisitor;
+
+template <typename C, typename ...A>
+class CyclicVisitor<C, Types<A...>> :
+    public CyclicChain<CyclicVisitor<C>, C, typename MakeIndices<C::Classes>::Type>
+{
+    public:
+        template <int L, int I>
+        int handle(CyclicNode<C, L, I> & node, A ...args)
+        {
+            return Work(node.value, L == 0 ? 0 : I + 1, args...);
+        }
+};
+
+template <typename C>
+struct Cyclic
+{
+    using Base = CyclicRoot<C>;
+
+    template <std::size_t K>
+    using Node = CyclicNode<C, LevelOf<C, K>::value, IndexOf<C, K>::value>;
+
+    static char const * Name() { return "cyclic"; }
+
+    template <typename ...A>
+    static int Visit(CyclicVisitor<C> & visitor, Base & node, A ...args)
+    {
+        return node.accept(visitor, args...);
+    }
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Acyclic visitor (dynamic_cast to the visit interface of every ancestor)
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename C, int L, int I>
+class AcyclicNode;
+
+struct AcyclicVisitorBase
+{
+    virtual ~AcyclicVisitorBase() { }
+};
+
+template <typename Class, typename ArgList>
+struct AcyclicVisitOf;
+
+template <typename Class, typename ...A>
+struct AcyclicVisitOf<Class, Types<A...>>
+{
+    virtual ~AcyclicVisitOf() { }
+    virtual int visit(Class & node, A ...args) = 0;
+};
+
+template <typename C, typename ArgList = typename C::Args>
+class AcyclicRoot;
+
+template <typename C, typename ...A>
+class AcyclicRoot<C, Types<A...>>
+{
+    public:
+        virtual ~AcyclicRoot() { }
+        virtual int accept(AcyclicVisitorBase & visitor, A ...args) = 0;
+
+        int value = 1;
+};
+
+//! Accept the visitor if it visits the class, fall back to the parent otherwise
+template <typename Self, typename Parent, typename C, typename ArgList = typename C::Args>
+class AcyclicAccept;
+
+template <typename Self, typename Parent, typename C, typename ...A>
+class AcyclicAccept<Self, Parent, C, Types<A...>> : public Parent
+{
+    public:
+        int accept(AcyclicVisitorBase & visitor, A ...args) override
+        {
+            using Visit = AcyclicVisitOf<Self, Types<A...>>;
+
+            if(Visit * v = dynamic_cast<Visit *>(&visitor))
+            {
+                return v->visit(static_cast<Self &>(*this), args...);
+            }
+
+            return this->acceptParent(visitor, args...);
+        }
+
+    private:
+        int acceptParent(AcyclicVisitorBase & visitor, A ...args)
+        {
+            return this->Parent::accept(visitor, args...);
+        }
+};
+
+// The root has no parent to fall back to
+template <typename Self, typename C, typename ...A>
+class AcyclicAccept<Self, AcyclicRoot<C>, C, Types<A...>> : public AcyclicRoot<C>
+{
+    public:
+        int accept(AcyclicVisitorBase & visitor, A ...args) override
+        {
+            using Visit = AcyclicVisitOf<Self, Types<A...>>;
+
+            return dynamic_cast<Visit &>(visitor).visit(static_cast<Self &>(*this), args...);
+        }
+};
+
+template <typename C, int L, int I>
+struct AcyclicParent
+{
+    using Type = AcyclicNode<C, L - 1, I>;
+};
+
+template <typename C, int I>
+struct AcyclicParent<C, 1, I>
+{
+    using Type = AcyclicNode<C, 0, 0>;
+};
+
+template <typename C>
+class AcyclicNode<C, 0, 0> :
+    public AcyclicAccept<AcyclicNode<C, 0, 0>, AcyclicRoot<C>, C>
+{
+
+};
+
+template <typename C, int L, int I>
+class AcyclicNode :
+    public AcyclicAccept<AcyclicNode<C, L, I>, typename AcyclicParent<C, L, I>::Type, C>
+{
+
+};
+
+//! Visit interfaces of the visited classes (root and first class of every chain)
+template <typename C, typename Chains>
+struct AcyclicVisitsOf;
+
+template <typename C, std::size_t ...I>
+struct AcyclicVisitsOf<C, Indices<I...>>
+{
+    struct Type :
+        AcyclicVisitorBase,
+        AcyclicVisitOf<AcyclicNode<C, 0, 0>, typename C::Args>,
+        AcyclicVisitOf<AcyclicNode<C, 1, int(I)>, typename C::Args>... { };
+};
+
+template <typename Impl, typename C, typename Chains, typename ArgList = typename C::Args>
+class AcyclicChain;
+
+template <typename Impl, typename C, typename ...A>
+class AcyclicChain<Impl, C, Indices<>, Types<A...>> :
+    public AcyclicVisitsOf<C, typename MakeIndices<C::Width>::Type>::Type
+{
+    public:
+        int visit(AcyclicNode<C, 0, 0> & node, A ...args) override
+        {
+            return Work(node.value, 0, args...);
+        }
+};
+
+template <typename Impl, typename C, std::size_t I, std::size_t ...Tail, typename ...A>
+class AcyclicChain<Impl, C, Indices<I, Tail...>, Types<A...>> :
+    public AcyclicChain<Impl, C, Indices<Tail...>, Types<A...>>
+{
+    public:
+        int visit(AcyclicNode<C, 1, int(I)> & node, A ...args) override
+        {
+            return Work(node.value, int(I) + 1, args...);
+        }
+};
+
+template <typename C>
+class AcyclicVisitor :
+    public AcyclicChain<AcyclicVisitor<C>, C, typename MakeIndices<C::Width>::Type>
+{
+
+};
+
+template <typename C>
+struct Acyclic
+{
+    using Base = AcyclicRoot<C>;
+
+    template <std::size_t K>
+    using Node = AcyclicNode<C, LevelOf<C, K>::value, IndexOf<C, K>::value>;
+
+    static char const * Name() { return "dynamic_cast"; }
+
+    template <typename ...A>
+    static int Visit(AcyclicVisitor<C> & visitor, Base & node, A ...args)
+    {
+        return node.accept(visitor, args...);
+    }
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Runner
+////////////////////////////////////////////////////////////////////////////////
+
+//! Mix of the visited types
+struct TypeMix
+{
+    char const * name;
+    std::vector<double> weights; ///< Weight of every class
+    double entropy;              ///< Shannon entropy in bits
+};
+
+inline TypeMix MakeTypeMix(char const * name, std::vector<double> weights)
+{
+    double total = 0.0;
+    for(double weight : weights) total += weight;
+
+    double entropy = 0.0;
+    for(double & weight : weights)
+    {
+        weight /= total;
+        if(weight > 0.0) entropy -= weight * std::log2(weight);
+    }
+
+    return TypeMix{name, weights, entropy};
+}
+
+//! Mixes: a single (deepest) class, two dominant classes, uniform
+inline std::vector<TypeMix> MakeTypeMixes(std::size_t classes)
+{
+    std::vector<double> single(classes, 0.0);
+    single[classes - 1] = 1.0;
+
+    std::vector<double> skewed(classes, 0.1 / double(classes));
+    skewed[classes - 1] += 0.45;
+    skewed[classes / 2] += 0.45;
+
+    return {
+        MakeTypeMix("single", single),
+        MakeTypeMix("skewed", skewed),
+        MakeTypeMix("uniform", std::vector<double>(classes, 1.0))
+    };
+}
+
+//! Classes of the objects to visit (same sequence for every visitor)
+inline std::vector<std::size_t> MakeClassSequence(TypeMix const & mix)
+{
+    std::mt19937 random(42u);
+    std::discrete_distribution<std::size_t> distribution(mix.weights.begin(), mix.weights.end());
+
+    std::vector<std::size_t> sequence(ObjectCount);
+    for(std::size_t & k : sequence) k = distribution(random);
+
+    return sequence;
+}
+
+//! Create an object of the class of index K
+template <typename Family, std::size_t K>
+typename Family::Base * MakeNode()
+{
+    return new typename Family::template Node<K>();
+}
+
+template <typename Family, std::size_t ...K>
+std::vector<typename Family::Base * (*)()> MakeFactories(Indices<K...>)
+{
+    return { &MakeNode<Family, K>... };
+}
+
+template <typename C, typename Family, typename VisitorType, typename ArgList = typename C::Args>
+struct Runner;
+
+template <typename C, typename Family, typename VisitorType, typename ...A>
+struct Runner<C, Family, VisitorType, Types<A...>>
+{
+    //! Return the duration of a visit in nanoseconds
+    static double Run(std::vector<std::size_t> const & sequence, int & checksum)
+    {
+        using Base = typename Family::Base;
+
+        std::vector<Base * (*)()> const factories =
+            MakeFactories<Family>(typename MakeIndices<C::Classes>::Type());
+
+        std::vector<std::unique_ptr<Base>> objects;
+        for(std::size_t k : sequence) objects.emplace_back(factories[k]());
+
+        VisitorType visitor;
+
+        auto const start = std::chrono::steady_clock::now();
+
+        int sum = 0;
+        for(std::size_t visits = 0; visits < VisitsPerRun; visits += objects.size())
+        {
+            for(std::unique_ptr<Base> const & object : objects)
+            {
+                sum += Family::Visit(visitor, *object, A(1)...);
+            }
+        }
+
+        auto const end = std::chrono::steady_clock::now();
+
+        checksum += sum;
+
+        std::size_t const visits =
+            (VisitsPerRun + objects.size() - 1) / objects.size() * objects.size();
+
+        return std::chrono::duration<double, std::nano>(end - start).count() / visits;
+    }
+};
+
+
+#if __cplusplus >= 201703L
+
+////////////////////////////////////////////////////////////////////////////////
+// std::visit (the objects are stored by value in the variants)
+////////////////////////////////////////////////////////////////////////////////
+
+template <int L, int I>
+struct VariantNode
+{
+    int value = 1;
+};
+
+template <typename C, typename Classes>
+struct VariantOf;
+
+template <typename C, std::size_t ...K>
+struct VariantOf<C, Indices<K...>>
+{
+    using Type = std::variant<VariantNode<LevelOf<C, K>::value, IndexOf<C, K>::value>...>;
+};
+
+template <typename C>
+using VariantType = typename VariantOf<C, typename MakeIndices<C::Classes>::Type>::Type;
+
+template <typename ...A>
+struct VariantVisitor
+{
+    std::tuple<A...> args;
+
+    template <int L, int I>
+    int operator()(VariantNode<L, I> & node) const
+    {
+        return std::apply([&](A ...a) { return Work(node.value, L == 0 ? 0 : I + 1, a...); }, args);
+    }
+};
+
+template <typename C, typename ArgList = typename C::Args>
+struct VariantRunner;
+
+template <typename C, typename ...A>
+struct VariantRunner<C, Types<A...>>
+{
+    static double Run(std::vector<std::size_t> const & sequence, int & checksum)
+    {
+        std::vector<VariantType<C>> objects;
+        for(std::size_t k : sequence) objects.push_back(Make(k, typename MakeIndices<C::Classes>::Type()));
+
+        VariantVisitor<A...> visitor{std::tuple<A...>(A(1)...)};
+
+        auto const start = std::chrono::steady_clock::now();
+
+        int sum = 0;
+        for(std::size_t visits = 0; visits < VisitsPerRun; visits += objects.size())
+        {
+            for(VariantType<C> & object : objects)
+            {
+                sum += std::visit(visitor, object);
+            }
+        }
+
+        auto const end = std::chrono::steady_clock::now();
+
+        checksum += sum;
+
+        std::size_t const visits =
+            (VisitsPerRun + objects.size() - 1) / objects.size() * objects.size();
+
+        return std::chrono::duration<double, std::nano>(end - start).count() / visits;
+    }
+
+    template <std::size_t ...K>
+    static VariantType<C> Make(std::size_t k, Indices<K...>)
+    {
+        VariantType<C> const alternatives[] = {
+            VariantType<C>(std::in_place_index<K>)...
+        };
+
+        return alternatives[k];
+    }
+};
+
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Suite
+////////////////////////////////////////////////////////////////////////////////
+
+struct Results
+{
+    std::ostringstream json;
+    bool first = true;
+    int checksum = 0;
+
+    void add(
+        char const * sweep, char const * visitor,
+        int depth, int width, int args, TypeMix const & mix, double ns
+    )
+    {
+        json << (first ? "\n" : ",\n")
+             << "    {\"sweep\": \"" << sweep << "\", \"visitor\": \"" << visitor
+             << "\", \"depth\": " << depth << ", \"width\": " << width
+             << ", \"args\": " << args << ", \"mix\": \"" << mix.name
+             << "\", \"entropy\": " << mix.entropy
+             << ", \"nsPerVisit\": " << ns << "}";
+
+        first = false;
+    }
+};
+
+template <int Depth, int Width, int ArgCount>
+void RunConfig(Results & results, char const * sweep)
+{
+    using C = Config<Depth, Width, ArgCount>;
+
+    for(TypeMix const & mix : MakeTypeMixes(C::Classes))
+    {
+        std::vector<std::size_t> const sequence = MakeClassSequence(mix);
+
+        results.add(
+            sweep, Cooperative<C>::Name(), Depth, Width, ArgCount, mix,
+            Runner<C, Cooperative<C>, CoopVisitor<C>>::Run(sequence, results.checksum)
+        );
+
+        results.add(
+            sweep, Cyclic<C>::Name(), Depth, Width, ArgCount, mix,
+            Runner<C, Cyclic<C>, CyclicVisitor<C>>::Run(sequence, results.checksum)
+        );
+
+        results.add(
+            sweep, Acyclic<C>::Name(), Depth, Width, ArgCount, mix,
+            Runner<C, Acyclic<C>, AcyclicVisitor<C>>::Run(sequence, results.checksum)
+        );
+
+#if __cplusplus >= 201703L
+        results.add(
+            sweep, "std::visit", Depth, Width, ArgCount, mix,
+            VariantRunner<C>::Run(sequence, results.checksum)
+        );
+#endif
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    Results results;
+
+    // Depth of the hierarchy
+    RunConfig<1, 4, 1>(results, "depth");
+    RunConfig<4, 4, 1>(results, "depth");
+    RunConfig<8, 4, 1>(results, "depth");
+
+    // Width of the hierarchy
+    RunConfig<1, 2, 1>(results, "width");
+    RunConfig<1, 16, 1>(results, "width");
+    RunConfig<1, 32, 1>(results, "width");
+
+    // Number of arguments
+    RunConfig<2, 4, 0>(results, "args");
+    RunConfig<2, 4, 2>(results, "args");
+    RunConfig<2, 4, 4>(results, "args");
+
+    std::ostringstream json;
+    json << "{\n  \"benchmark\": \"dispatch\","
+         << "\n  \"objects\": " << ObjectCount << ","
+#if defined(__OPTIMIZE__) || defined(NDEBUG)
+         << "\n  \"optimized\": true,"
+#else
+         << "\n  \"optimized\": false,"
+#endif
+         << "\n  \"checksum\": " << results.checksum << ","
+         << "\n  \"results\": [" << results.json.str() << "\n  ]\n}\n";
+
+    if(argc > 1)
+    {
+        std::ofstream(argv[1]) << json.str();
+    }
+    else
+    {
+        std::cout << json.str();
+    }
+
+    return 0;
+}
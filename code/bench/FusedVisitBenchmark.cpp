@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <FusedVisitor.hpp>
+#include <Visitable.hpp>
+#include <Visitor.hpp>
+
+// Benchmark of 4 visitors over 10M heap nodes in a shuffled order: the
+// visitors run back to back (4 passes over the nodes), fused (1 pass, 1 tag
+// resolution per node) and fused with fused thunks for every node type
+
+static constexpr std::size_t NodeCount = 10000000u;
+static constexpr int Passes = 3;
+
+class Node : public Visitable<Node>
+{
+    public:
+        META_BaseVisitable(Node)
+
+        virtual ~Node() { }
+
+        float value = 1.f;
+        float velocity = 0.5f;
+        float radius = 2.f;
+        unsigned flags = 0u;
+};
+
+template <int N>
+class Derived : public Node
+{
+    public:
+        META_Visitable(Derived, Node)
+};
+
+class UpdateVisitor : public Visitor<Node, void, float>
+{
+    public:
+        META_Visitor(UpdateVisitor, update)
+
+        UpdateVisitor()
+        {
+            META_Visitables(Node, Derived<0>, Derived<1>, Derived<2>);
+        }
+
+    private:
+        void update(Node & node, float dt) { node.value += node.velocity * dt; }
+
+        template <int N>
+        void update(Derived<N> & node, float dt) { node.value += node.velocity * dt * (N + 1); }
+};
+
+class CullVisitor : public Visitor<Node, bool, float>
+{
+    public:
+        META_Visitor(CullVisitor, cull)
+
+        CullVisitor()
+        {
+            META_Visitables(Node, Derived<0>, Derived<1>, Derived<2>);
+        }
+
+        std::size_t visible = 0u;
+
+    private:
+        bool cull(Node & node, float)
+        {
+            bool const isVisible = node.value < 1e6f + node.radius;
+            visible += isVisible;
+            return isVisible;
+        }
+
+        bool cull(Derived<2> & node, float)
+        {
+            node.flags |= 1u;
+            return true;
+        }
+};
+
+class StatsVisitor : public Visitor<Node, void, float>
+{
+    public:
+        META_Visitor(StatsVisitor, count)
+
+        StatsVisitor()
+        {
+            META_Visitables(Node, Derived<0>, Derived<1>, Derived<2>);
+        }
+
+        std::size_t counts[4] = { };
+
+    private:
+        void count(Node &, float) { ++counts[0]; }
+
+        template <int N>
+        void count(Derived<N> &, float) { ++counts[N + 1]; }
+};
+
+class BoundsVisitor : public Visitor<Node, float, float>
+{
+    public:
+        META_Visitor(BoundsVisitor, bound)
+
+        BoundsVisitor()
+        {
+            META_Visitables(Node, Derived<1>);
+        }
+
+        float maxRadius = 0.f;
+
+    private:
+        float bound(Node & node, float)
+        {
+            maxRadius = std::max(maxRadius, node.radius);
+            return node.radius;
+        }
+
+        float bound(Derived<1> & node, float)
+        {
+            maxRadius = std::max(maxRadius, node.radius * 2.f);
+            return node.radius * 2.f;
+        }
+};
+
+struct Visitors
+{
+    UpdateVisitor update;
+    CullVisitor cull;
+    StatsVisitor stats;
+    BoundsVisitor bounds;
+};
+
+template <typename Visit>
+void Run(char const * name, Visit visit)
+{
+    Visitors visitors;
+
+    auto const start = std::chrono::steady_clock::now();
+
+    for(int pass = 0; pass < Passes; ++pass) visit(visitors);
+
+    auto const end = std::chrono::steady_clock::now();
+
+    double const ns =
+        std::chrono::duration<double, std::nano>(end - start).count();
+
+    std::cout << name << ": " << ns / (Passes * NodeCount)
+              << " ns per node (checksum " << visitors.cull.visible + visitors.stats.counts[3]
+              << ", " << visitors.bounds.maxRadius << ")" << std::endl;
+}
+
+int main()
+{
+    std::mt19937 random(42u);
+
+    std::vector<std::unique_ptr<Node>> nodes;
+    nodes.reserve(NodeCount);
+
+    for(std::size_t i = 0; i < NodeCount; ++i)
+    {
+        switch(random() % 4u)
+        {
+            case 0: nodes.emplace_back(new Node()); break;
+            case 1: nodes.emplace_back(new Derived<0>()); break;
+            case 2: nodes.emplace_back(new Derived<1>()); break;
+            case 3: nodes.emplace_back(new Derived<2>()); break;
+        }
+    }
+
+    // Visit order unrelated to the allocation order
+    std::shuffle(nodes.begin(), nodes.end(), random);
+
+    float const dt = 0.016f;
+
+    Run("back to back ", [&](Visitors & visitors)
+    {
+        visitors.update.visitRange(nodes.begin(), nodes.end(), dt);
+        visitors.cull.visitRange(nodes.begin(), nodes.end(), dt);
+        visitors.stats.visitRange(nodes.begin(), nodes.end(), dt);
+        visitors.bounds.visitRange(nodes.begin(), nodes.end(), dt);
+    });
+
+    Run("fused        ", [&](Visitors & visitors)
+    {
+        FusedVisitor<UpdateVisitor, CullVisitor, StatsVisitor, BoundsVisitor> fused(
+            visitors.update, visitors.cull, visitors.stats, visitors.bounds
+        );
+
+        fused.visitRange(nodes.begin(), nodes.end(), dt);
+    });
+
+    Run("fused thunks ", [&](Visitors & visitors)
+    {
+        FusedVisitor<UpdateVisitor, CullVisitor, StatsVisitor, BoundsVisitor> fused(
+            visitors.update, visitors.cull, visitors.stats, visitors.bounds
+        );
+
+        fused.fuse<Node, Derived<0>, Derived<1>, Derived<2>>();
+        fused.visitRange(nodes.begin(), nodes.end(), dt);
+    });
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <Visitable.hpp>
+#include <VisitableHandle.hpp>
+#include <Visitor.hpp>
+
+// Batch visitation benchmark: bucket and dispatch scattered objects from raw
+// pointers (the tag is read from every object) and from handles (the tag is
+// read from the handles)
+
+static constexpr std::size_t ObjectCount = 1u << 21;
+static constexpr int Passes = 10;
+
+class Shape : public Visitable<Shape>
+{
+    public:
+        META_BaseVisitable(Shape)
+
+        virtual ~Shape() { }
+
+        char payload[200]; // One object per few cache lines
+};
+
+template <int N>
+class Derived : public Shape
+{
+    public:
+        META_Visitable(Derived, Shape)
+};
+
+class CountVisitor : public Visitor<Shape, std::size_t>
+{
+    public:
+        META_Visitor(CountVisitor, visit)
+
+        CountVisitor()
+        {
+            META_Visitables(Derived<0>, Derived<1>, Derived<2>, Derived<3>);
+        }
+
+    private:
+        // The objects are not touched: only the dispatch is measured
+        std::size_t visit(Shape &) { return 0u; }
+
+        template <int N>
+        std::size_t visit(Derived<N> &) { return N + 1u; }
+};
+
+template <typename Range>
+void Run(char const * name, Range const & range)
+{
+    CountVisitor visitor;
+    std::vector<std::size_t> results(range.size());
+
+    auto const start = std::chrono::steady_clock::now();
+
+    std::size_t checksum = 0u;
+    for(int pass = 0; pass < Passes; ++pass)
+    {
+        visitor.transformRange(range.begin(), range.end(), results.begin());
+        checksum += results[pass];
+    }
+
+    auto const end = std::chrono::steady_clock::now();
+
+    double const ns =
+        std::chrono::duration<double, std::nano>(end - start).count();
+
+    std::cout << name << ": " << ns / (Passes * range.size())
+              << " ns per visit (checksum " << checksum << ")" << std::endl;
+}
+
+int main()
+{
+    std::mt19937 random(42u);
+
+    std::vector<std::unique_ptr<Shape>> objects;
+    objects.reserve(ObjectCount);
+
+    for(std::size_t i = 0; i < ObjectCount; ++i)
+    {
+        switch(random() % 5u)
+        {
+            case 0: objects.emplace_back(new Shape()); break;
+            case 1: objects.emplace_back(new Derived<0>()); break;
+            case 2: objects.emplace_back(new Derived<1>()); break;
+            case 3: objects.emplace_back(new Derived<2>()); break;
+            case 4: objects.emplace_back(new Derived<3>()); break;
+        }
+    }
+
+    // Visit in a random order to defeat the prefetcher
+    std::vector<Shape *> pointers;
+    for(std::unique_ptr<Shape> const & object : objects) pointers.push_back(object.get());
+    std::shuffle(pointers.begin(), pointers.end(), random);
+
+    VisitableHandleVector<Shape> handles(pointers.begin(), pointers.end());
+
+    Run("pointers", pointers);
+    Run("handles ", handles);
+
+    return 0;
+}
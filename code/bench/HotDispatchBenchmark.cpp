@@ -0,0 +1,130 @@
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <Visitable.hpp>
+#include <Visitor.hpp>
+
+// Dispatch benchmark: visit a skewed mix of shuffled objects (90% of the
+// visits go to two classes) through the vtable and through hot visitables
+
+static constexpr std::size_t ObjectCount = 1u << 20;
+static constexpr int Passes = 20;
+
+class Shape : public Visitable<Shape>
+{
+    public:
+        META_BaseVisitable(Shape)
+};
+
+template <int N>
+class Derived : public Shape
+{
+    public:
+        META_Visitable(Derived, Shape)
+};
+
+class CountVisitor : public Visitor<Shape, std::size_t>
+{
+    public:
+        META_Visitor(CountVisitor, visit)
+
+        CountVisitor()
+        {
+            META_Visitables(
+                Derived<0>, Derived<1>, Derived<2>, Derived<3>,
+                Derived<4>, Derived<5>, Derived<6>, Derived<7>
+            );
+        }
+
+    private:
+        std::size_t visit(Shape &) { return 0u; }
+
+        template <int N>
+        std::size_t visit(Derived<N> &) { return N + 1u; }
+};
+
+class HotCountVisitor : public Visitor<Shape, std::size_t>
+{
+    public:
+        META_Visitor(HotCountVisitor, visit)
+        META_HotVisitables(Derived<0>, Derived<1>)
+
+        HotCountVisitor()
+        {
+            META_Visitables(
+                Derived<0>, Derived<1>, Derived<2>, Derived<3>,
+                Derived<4>, Derived<5>, Derived<6>, Derived<7>
+            );
+        }
+
+    private:
+        std::size_t visit(Shape &) { return 0u; }
+
+        template <int N>
+        std::size_t visit(Derived<N> &) { return N + 1u; }
+};
+
+std::vector<std::unique_ptr<Shape>> MakeObjects()
+{
+    std::mt19937 random(42u);
+    std::vector<std::unique_ptr<Shape>> objects;
+    objects.reserve(ObjectCount);
+
+    for(std::size_t i = 0; i < ObjectCount; ++i)
+    {
+        unsigned const draw = random() % 100u;
+
+        if(draw < 60u) objects.emplace_back(new Derived<0>());
+        else if(draw < 90u) objects.emplace_back(new Derived<1>());
+        else switch(draw % 6u)
+        {
+            case 0: objects.emplace_back(new Derived<2>()); break;
+            case 1: objects.emplace_back(new Derived<3>()); break;
+            case 2: objects.emplace_back(new Derived<4>()); break;
+            case 3: objects.emplace_back(new Derived<5>()); break;
+            case 4: objects.emplace_back(new Derived<6>()); break;
+            case 5: objects.emplace_back(new Derived<7>()); break;
+        }
+    }
+
+    return objects;
+}
+
+template <typename CountVisitor>
+void Run(char const * name, std::vector<std::unique_ptr<Shape>> const & objects)
+{
+    CountVisitor visitor;
+
+    auto const start = std::chrono::steady_clock::now();
+
+    std::size_t checksum = 0u;
+    for(int pass = 0; pass < Passes; ++pass)
+    {
+        for(std::unique_ptr<Shape> const & object : objects)
+        {
+            checksum += visitor(*object);
+        }
+    }
+
+    auto const end = std::chrono::steady_clock::now();
+
+    double const ns =
+        std::chrono::duration<double, std::nano>(end - start).count();
+
+    std::cout << name << ": " << ns / (Passes * ObjectCount)
+              << " ns per visit (checksum " << checksum << ")" << std::endl;
+}
+
+int main()
+{
+    std::vector<std::unique_ptr<Shape>> const objects = MakeObjects();
+
+    Run<CountVisitor>("vtable", objects);
+    Run<HotCountVisitor>("hot   ", objects);
+
+    return 0;
+}
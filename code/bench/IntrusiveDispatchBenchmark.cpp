@@ -0,0 +1,138 @@
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <IntrusiveVisitable.hpp>
+#include <Visitable.hpp>
+#include <Visitor.hpp>
+
+// Dispatch benchmark: visit the same shuffled objects through the virtual
+// visitable_tag() and through the tag stored in the objects
+
+static constexpr std::size_t ObjectCount = 1u << 20;
+static constexpr int Passes = 20;
+
+// Hierarchy with a virtual tag
+class Shape : public Visitable<Shape>
+{
+    public:
+        META_BaseVisitable(Shape)
+};
+
+template <int N>
+class Derived : public Shape
+{
+    public:
+        META_Visitable(Derived, Shape)
+};
+
+// Same hierarchy with an intrusive tag
+class IntrusiveShape : public IntrusiveVisitable<IntrusiveShape>
+{
+    public:
+        META_IntrusiveBaseVisitable(IntrusiveShape)
+};
+
+template <int N>
+class IntrusiveDerived : public IntrusiveShape
+{
+    public:
+        META_IntrusiveVisitable(IntrusiveDerived, IntrusiveShape)
+};
+
+class CountVisitor : public Visitor<Shape, std::size_t>
+{
+    public:
+        META_Visitor(CountVisitor, visit)
+
+        CountVisitor()
+        {
+            META_Visitables(Derived<0>, Derived<1>, Derived<2>, Derived<3>);
+        }
+
+    private:
+        std::size_t visit(Shape &) { return 0u; }
+
+        template <int N>
+        std::size_t visit(Derived<N> &) { return N + 1u; }
+};
+
+class IntrusiveCountVisitor : public Visitor<IntrusiveShape, std::size_t>
+{
+    public:
+        META_Visitor(IntrusiveCountVisitor, visit)
+
+        IntrusiveCountVisitor()
+        {
+            META_Visitables(
+                IntrusiveDerived<0>, IntrusiveDerived<1>,
+                IntrusiveDerived<2>, IntrusiveDerived<3>
+            );
+        }
+
+    private:
+        std::size_t visit(IntrusiveShape &) { return 0u; }
+
+        template <int N>
+        std::size_t visit(IntrusiveDerived<N> &) { return N + 1u; }
+};
+
+template <typename Base, template <int> class Class>
+std::vector<std::unique_ptr<Base>> MakeObjects()
+{
+    std::mt19937 random(42u);
+    std::vector<std::unique_ptr<Base>> objects;
+    objects.reserve(ObjectCount);
+
+    for(std::size_t i = 0; i < ObjectCount; ++i)
+    {
+        switch(random() % 5u)
+        {
+            case 0: objects.emplace_back(new Base()); break;
+            case 1: objects.emplace_back(new Class<0>()); break;
+            case 2: objects.emplace_back(new Class<1>()); break;
+            case 3: objects.emplace_back(new Class<2>()); break;
+            case 4: objects.emplace_back(new Class<3>()); break;
+        }
+    }
+
+    return objects;
+}
+
+template <typename Base, template <int> class Class, typename CountVisitor>
+void Run(char const * name)
+{
+    std::vector<std::unique_ptr<Base>> const objects = MakeObjects<Base, Class>();
+    CountVisitor visitor;
+
+    auto const start = std::chrono::steady_clock::now();
+
+    std::size_t checksum = 0u;
+    for(int pass = 0; pass < Passes; ++pass)
+    {
+        for(std::unique_ptr<Base> const & object : objects)
+        {
+            checksum += visitor(*object);
+        }
+    }
+
+    auto const end = std::chrono::steady_clock::now();
+
+    double const ns =
+        std::chrono::duration<double, std::nano>(end - start).count();
+
+    std::cout << name << ": " << ns / (Passes * ObjectCount)
+              << " ns per visit (checksum " << checksum << ", "
+              << sizeof(Class<0>) << " bytes per object)" << std::endl;
+}
+
+int main()
+{
+    Run<Shape, Derived, CountVisitor>("virtual tag  ");
+    Run<IntrusiveShape, IntrusiveDerived, IntrusiveCountVisitor>("intrusive tag");
+
+    return 0;
+}
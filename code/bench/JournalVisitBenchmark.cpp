@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <Visitable.hpp>
+#include <VisitJournal.hpp>
+#include <Visitor.hpp>
+
+// Frame update of 1M heap nodes where 1% of the nodes change per frame: every
+// node visited, the changed nodes collected from a journal (in the recorded
+// order, by tag and by depth)
+
+static constexpr std::size_t NodeCount = 1000000u;
+static constexpr std::size_t ChangesPerFrame = NodeCount / 100u;
+static constexpr int Frames = 20;
+
+class Node : public Visitable<Node>
+{
+    public:
+        META_BaseVisitable(Node)
+
+        virtual ~Node() { }
+
+        float value = 1.f;
+        float world = 0.f;
+        unsigned depth = 0u;
+};
+
+template <int N>
+class Derived : public Node
+{
+    public:
+        META_Visitable(Derived, Node)
+};
+
+class UpdateVisitor : public Visitor<Node, void>
+{
+    public:
+        META_Visitor(UpdateVisitor, update)
+
+        UpdateVisitor()
+        {
+            META_Visitables(Derived<0>, Derived<1>, Derived<2>);
+        }
+
+        double sum = 0.0;
+
+    private:
+        void update(Node & node) { node.world = node.value; sum += node.world; }
+
+        template <int N>
+        void update(Derived<N> & node) { node.world = node.value * (N + 2); sum += node.world; }
+};
+
+template <typename Frame>
+void Run(char const * name, std::vector<Node *> const & nodes, VisitJournal<Node> & journal, Frame frame)
+{
+    std::mt19937 random(7u);
+    UpdateVisitor visitor;
+
+    auto const start = std::chrono::steady_clock::now();
+
+    for(int i = 0; i < Frames; ++i)
+    {
+        for(std::size_t j = 0; j < ChangesPerFrame; ++j)
+        {
+            Node & node = *nodes[random() % NodeCount];
+
+            node.value += 1.f;
+            journal.record(node);
+        }
+
+        frame(visitor);
+    }
+
+    auto const end = std::chrono::steady_clock::now();
+
+    double const ms =
+        std::chrono::duration<double, std::milli>(end - start).count();
+
+    std::cout << name << ": " << ms / Frames
+              << " ms per frame (checksum " << visitor.sum << ")" << std::endl;
+}
+
+int main()
+{
+    std::mt19937 random(42u);
+
+    std::vector<std::unique_ptr<Node>> storage;
+    std::vector<Node *> nodes;
+
+    for(std::size_t i = 0; i < NodeCount; ++i)
+    {
+        switch(random() % 4u)
+        {
+            case 0: storage.emplace_back(new Node()); break;
+            case 1: storage.emplace_back(new Derived<0>()); break;
+            case 2: storage.emplace_back(new Derived<1>()); break;
+            case 3: storage.emplace_back(new Derived<2>()); break;
+        }
+
+        storage.back()->depth = random() % 16u;
+        nodes.push_back(storage.back().get());
+    }
+
+    std::shuffle(nodes.begin(), nodes.end(), random);
+
+    VisitJournal<Node> journal;
+    VisitableHandleVector<Node> changed;
+
+    Run("every node       ", nodes, journal, [&](UpdateVisitor & visitor)
+    {
+        journal.clear();
+        visitor.visitRange(nodes.begin(), nodes.end());
+    });
+
+    Run("journal          ", nodes, journal, [&](UpdateVisitor & visitor)
+    {
+        journal.visit(visitor);
+    });
+
+    Run("journal by tag   ", nodes, journal, [&](UpdateVisitor & visitor)
+    {
+        journal.collect(changed, JournalOrder::ByTag);
+        visitor.visitRange(changed.begin(), changed.end());
+    });
+
+    Run("journal by depth ", nodes, journal, [&](UpdateVisitor & visitor)
+    {
+        journal.collectByDepth(changed, [](Node & node) { return node.depth; });
+
+        for(VisitableHandle<Node> const & node : changed) visitor(node);
+    });
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <LambdaVisitor.hpp>
+#include <Visitable.hpp>
+#include <Visitor.hpp>
+
+// Dispatch of 10M visits over 1M small nodes grouped by type (so the dispatch
+// is predicted and the call overhead shows): a visitor class, a visitor
+// created from lambdas by MakeVisitor, and a visitor class forwarding to
+// std::function members (the usual ad-hoc visitor)
+
+static constexpr std::size_t NodeCount = 1000000u;
+static constexpr int Passes = 10;
+
+class Node : public Visitable<Node>
+{
+    public:
+        META_BaseVisitable(Node)
+
+        virtual ~Node() { }
+
+        float value = 1.f;
+};
+
+template <int N>
+class Derived : public Node
+{
+    public:
+        META_Visitable(Derived, Node)
+};
+
+class SumVisitor : public Visitor<Node, void, float>
+{
+    public:
+        META_Visitor(SumVisitor, sum)
+
+        SumVisitor(double & total):
+            m_total(total)
+        {
+            META_Visitables(Node, Derived<0>, Derived<1>);
+        }
+
+    private:
+        void sum(Node & node, float scale) { m_total += node.value * scale; }
+        void sum(Derived<0> & node, float scale) { m_total += node.value * scale * 2.f; }
+        void sum(Derived<1> & node, float scale) { m_total -= node.value * scale; }
+
+        double & m_total;
+};
+
+class FunctionVisitor : public Visitor<Node, void, float>
+{
+    public:
+        META_Visitor(FunctionVisitor, call)
+
+        FunctionVisitor(
+            std::function<void (Node &, float)> node,
+            std::function<void (Derived<0> &, float)> derived0,
+            std::function<void (Derived<1> &, float)> derived1
+        ):
+            m_node(node), m_derived0(derived0), m_derived1(derived1)
+        {
+            META_Visitables(Node, Derived<0>, Derived<1>);
+        }
+
+    private:
+        void call(Node & node, float scale) { m_node(node, scale); }
+        void call(Derived<0> & node, float scale) { m_derived0(node, scale); }
+        void call(Derived<1> & node, float scale) { m_derived1(node, scale); }
+
+        std::function<void (Node &, float)> m_node;
+        std::function<void (Derived<0> &, float)> m_derived0;
+        std::function<void (Derived<1> &, float)> m_derived1;
+};
+
+template <typename Visit>
+void Run(char const * name, std::vector<Node *> const & nodes, Visit visit)
+{
+    double total = 0.0;
+
+    auto const start = std::chrono::steady_clock::now();
+
+    for(int pass = 0; pass < Passes; ++pass) visit(total);
+
+    auto const end = std::chrono::steady_clock::now();
+
+    double const ns =
+        std::chrono::duration<double, std::nano>(end - start).count();
+
+    std::cout << name << ": " << ns / (Passes * nodes.size())
+              << " ns per visit (checksum " << total << ")" << std::endl;
+}
+
+int main()
+{
+    std::vector<std::unique_ptr<Node>> storage;
+    std::vector<Node *> nodes;
+
+    for(std::size_t i = 0; i < NodeCount; ++i)
+    {
+        switch(i * 3u / NodeCount)
+        {
+            case 0: storage.emplace_back(new Node()); break;
+            case 1: storage.emplace_back(new Derived<0>()); break;
+            case 2: storage.emplace_back(new Derived<1>()); break;
+        }
+
+        nodes.push_back(storage.back().get());
+    }
+
+    float const scale = 0.5f;
+
+    Run("visitor class   ", nodes, [&](double & total)
+    {
+        SumVisitor visitor(total);
+        for(Node * node : nodes) visitor(*node, scale);
+    });
+
+    Run("MakeVisitor     ", nodes, [&](double & total)
+    {
+        auto visitor = MakeVisitor<Node, void, float>(
+            [&](Node & node, float s) { total += node.value * s; },
+            [&](Derived<0> & node, float s) { total += node.value * s * 2.f; },
+            [&](Derived<1> & node, float s) { total -= node.value * s; }
+        );
+
+        for(Node * node : nodes) visitor(*node, scale);
+    });
+
+    Run("std::function   ", nodes, [&](double & total)
+    {
+        FunctionVisitor visitor(
+            [&](Node & node, float s) { total += node.value * s; },
+            [&](Derived<0> & node, float s) { total += node.value * s * 2.f; },
+            [&](Derived<1> & node, float s) { total -= node.value * s; }
+        );
+
+        for(Node * node : nodes) visitor(*node, scale);
+    });
+
+    return 0;
+}
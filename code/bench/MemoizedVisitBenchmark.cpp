@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <MemoizingVisitor.hpp>
+#include <ParallelVisit.hpp>
+#include <Visitable.hpp>
+#include <Visitor.hpp>
+
+// Benchmark of a pure visitor computing the bounds of 250k objects (256 points
+// each) per frame, where 1% of the objects change between two frames: the
+// visitor alone, memoized, and memoized in a parallel visitation. The hits,
+// misses and invalidations are checked first, and the memoized results are
+// checked against the visitor after the runs.
+
+static constexpr std::size_t ObjectCount = 250000u;
+static constexpr std::size_t PointCount = 256u;
+static constexpr int Frames = 10;
+
+struct Box
+{
+    float min = 1e30f;
+    float max = -1e30f;
+};
+
+Box Merge(Box const & a, Box const & b)
+{
+    Box box;
+    box.min = std::min(a.min, b.min);
+    box.max = std::max(a.max, b.max);
+
+    return box;
+}
+
+class Object : public Visitable<Object>, public MemoizedVisitable
+{
+    public:
+        META_BaseVisitable(Object)
+
+        virtual ~Object() { }
+
+        float points[PointCount];
+};
+
+class Mesh : public Object
+{
+    public:
+        META_Visitable(Mesh, Object)
+};
+
+class BoundsVisitor : public Visitor<Object, Box, float>
+{
+    public:
+        META_Visitor(BoundsVisitor, bounds)
+
+        BoundsVisitor()
+        {
+            META_Visitables(Object, Mesh);
+        }
+
+    private:
+        Box bounds(Object & object, float scale)
+        {
+            Box box;
+
+            for(float point : object.points)
+            {
+                box.min = std::min(box.min, point * scale);
+                box.max = std::max(box.max, point * scale);
+            }
+
+            return box;
+        }
+
+        Box bounds(Mesh & mesh, float scale)
+        {
+            Box box = this->bounds(static_cast<Object &>(mesh), scale);
+            box.max += 1.f;
+
+            return box;
+        }
+};
+
+static bool Equal(Box const & a, Box const & b)
+{
+    return a.min == b.min && a.max == b.max;
+}
+
+//! Check that the memoized results of every object are the visited ones
+template <typename Memoizing>
+bool CheckResults(Memoizing & memoized, std::vector<Object *> const & objects, float scale)
+{
+    BoundsVisitor visitor;
+
+    for(Object * object : objects)
+    {
+        if(!Equal(memoized(*object, scale), visitor(*object, scale))) return false;
+    }
+
+    return true;
+}
+
+//! Check the hits, misses and invalidations of a memoizing visitor
+static bool CheckMemoization()
+{
+    MemoizingVisitor<BoundsVisitor> memoized(64u);
+    BoundsVisitor visitor;
+
+    Mesh mesh;
+    for(std::size_t i = 0; i < PointCount; ++i) mesh.points[i] = float(i);
+
+    bool ok = Equal(memoized(mesh, 1.f), visitor(mesh, 1.f)); // Miss
+    ok = ok && Equal(memoized(mesh, 1.f), visitor(mesh, 1.f)); // Hit
+    ok = ok && Equal(memoized(mesh, 2.f), visitor(mesh, 2.f)); // Miss (other key)
+
+    mesh.points[0] = -10.f;
+    mesh.visitable_touch();
+    ok = ok && Equal(memoized(mesh, 1.f), visitor(mesh, 1.f)); // Miss (touched)
+
+    memoized.invalidate();
+    ok = ok && Equal(memoized(mesh, 1.f), visitor(mesh, 1.f)); // Miss (invalidated)
+    ok = ok && Equal(memoized(mesh, 1.f), visitor(mesh, 1.f)); // Hit
+
+    MemoStats const stats = memoized.stats();
+
+    return ok && stats.hits == 2u && stats.misses == 4u && stats.evictions == 0u;
+}
+
+template <typename Frame>
+void Run(char const * name, std::vector<Object *> const & objects, Frame frame)
+{
+    std::mt19937 random(7u);
+    float checksum = 0.f;
+
+    auto const start = std::chrono::steady_clock::now();
+
+    for(int i = 0; i < Frames; ++i)
+    {
+        // 1% of the objects change
+        for(std::size_t j = 0; j < ObjectCount / 100u; ++j)
+        {
+            Object & object = *objects[random() % ObjectCount];
+
+            object.points[j % PointCount] += 1.f;
+            object.visitable_touch();
+        }
+
+        checksum += frame();
+    }
+
+    auto const end = std::chrono::steady_clock::now();
+
+    double const ns =
+        std::chrono::duration<double, std::nano>(end - start).count();
+
+    std::cout << name << ": " << ns / (Frames * ObjectCount)
+              << " ns per object (checksum " << checksum << ")" << std::endl;
+}
+
+int main()
+{
+    int failures = 0;
+
+    if(!CheckMemoization())
+    {
+        std::cout << "memoization check FAILED" << std::endl;
+        ++failures;
+    }
+
+    std::mt19937 random(42u);
+    std::uniform_real_distribution<float> coordinate(-100.f, 100.f);
+
+    std::vector<std::unique_ptr<Object>> storage;
+    std::vector<Object *> objects;
+
+    for(std::size_t i = 0; i < ObjectCount; ++i)
+    {
+        storage.emplace_back(random() % 2u ? new Object() : new Mesh());
+
+        for(float & point : storage.back()->points) point = coordinate(random);
+
+        objects.push_back(storage.back().get());
+    }
+
+    float const scale = 2.f;
+
+    Run("visitor         ", objects, [&]()
+    {
+        BoundsVisitor visitor;
+        Box bounds;
+
+        for(Object * object : objects) bounds = Merge(bounds, visitor(*object, scale));
+
+        return bounds.max - bounds.min;
+    });
+
+    MemoizingVisitor<BoundsVisitor> memoized(2u * ObjectCount);
+
+    Run("memoized        ", objects, [&]()
+    {
+        Box bounds;
+
+        for(Object * object : objects) bounds = Merge(bounds, memoized(*object, scale));
+
+        return bounds.max - bounds.min;
+    });
+
+    MemoStats const stats = memoized.stats();
+
+    std::cout << "  hits " << stats.hits << ", misses " << stats.misses
+              << ", evictions " << stats.evictions << std::endl;
+
+    if(!CheckResults(memoized, objects, scale))
+    {
+        std::cout << "  memoized results FAILED" << std::endl;
+        ++failures;
+    }
+
+    MemoizingVisitor<BoundsVisitor> shared(2u * ObjectCount);
+    VisitThreadPool pool;
+
+    Run("memoized (pool) ", objects, [&]()
+    {
+        Box const bounds = ParallelReduce(
+            pool, shared, objects.begin(), objects.end(), Box(), Merge, scale
+        );
+
+        return bounds.max - bounds.min;
+    });
+
+    if(!CheckResults(shared, objects, scale))
+    {
+        std::cout << "  memoized results (pool) FAILED" << std::endl;
+        ++failures;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <MessageChannel.hpp>
+#include <Visitable.hpp>
+#include <Visitor.hpp>
+
+// Message channel benchmark: 1, 4 and 16 producers send messages of 3 types
+// to a single consumer draining them in batches. Every message carries its
+// send time, so the consumer measures the latency from the send to the visit
+// (queuing included) along with the throughput
+
+static constexpr std::size_t MessagesPerRun = 1u << 20;
+static constexpr std::size_t Capacity = 1u << 12;
+static constexpr std::size_t BatchSize = 64u;
+
+using Clock = std::chrono::steady_clock;
+
+class Message : public Visitable<Message>
+{
+    public:
+        META_BaseVisitable(Message)
+
+        explicit Message(std::int64_t sent = 0): sent(sent) { }
+
+        std::int64_t sent; ///< Send time (ns)
+};
+
+class Move : public Message
+{
+    public:
+        META_Visitable(Move, Message)
+
+        Move(std::int64_t sent, float x, float y): Message(sent), x(x), y(y) { }
+
+        float x, y;
+};
+
+class Damage : public Message
+{
+    public:
+        META_Visitable(Damage, Message)
+
+        Damage(std::int64_t sent, int amount): Message(sent), amount(amount) { }
+
+        int amount;
+};
+
+class Spawn : public Message
+{
+    public:
+        META_Visitable(Spawn, Message)
+
+        Spawn(std::int64_t sent, int kind): Message(sent), kind(kind) { }
+
+        int kind;
+        float transform[12] = { };
+};
+
+std::int64_t Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now().time_since_epoch()
+    ).count();
+}
+
+// Consumer: applies the messages and records their latency
+class Handler : public Visitor<Message, void, std::int64_t>
+{
+    public:
+        META_Visitor(Handler, handle)
+
+        Handler()
+        {
+            META_Visitables(Move, Damage, Spawn);
+
+            latencies.reserve(MessagesPerRun);
+        }
+
+        void handle(Message & message, std::int64_t now)
+        {
+            latencies.push_back(now - message.sent);
+        }
+
+        void handle(Move & move, std::int64_t now)
+        {
+            position += move.x - move.y;
+            this->handle(static_cast<Message &>(move), now);
+        }
+
+        void handle(Damage & damage, std::int64_t now)
+        {
+            health -= damage.amount;
+            this->handle(static_cast<Message &>(damage), now);
+        }
+
+        void handle(Spawn & spawn, std::int64_t now)
+        {
+            spawned += spawn.kind;
+            this->handle(static_cast<Message &>(spawn), now);
+        }
+
+        float position = 0.f;
+        long health = 0;
+        long spawned = 0;
+        std::vector<std::int64_t> latencies;
+};
+
+void Run(std::size_t producerCount)
+{
+    MessageChannel<Message> channel(Capacity);
+    Handler handler;
+
+    std::size_t const perProducer = MessagesPerRun / producerCount;
+    std::size_t const total = perProducer * producerCount;
+
+    std::atomic<bool> go(false);
+    std::vector<std::thread> producers;
+
+    for(std::size_t p = 0; p < producerCount; ++p)
+    {
+        producers.emplace_back([&channel, &go, perProducer, p]()
+        {
+            while(!go.load(std::memory_order_acquire)) std::this_thread::yield();
+
+            for(std::size_t i = 0; i < perProducer; ++i)
+            {
+                switch((i + p) % 3u)
+                {
+                    case 0: channel.emplace<Move>(Now(), 1.f, 0.5f); break;
+                    case 1: channel.emplace<Damage>(Now(), 2); break;
+                    case 2: channel.emplace<Spawn>(Now(), 3); break;
+                }
+            }
+        });
+    }
+
+    auto const start = Clock::now();
+    go.store(true, std::memory_order_release);
+
+    std::size_t received = 0u;
+    while(received < total)
+    {
+        std::size_t const count = channel.drain(handler, BatchSize, Now());
+
+        // Let the producers run (a single core is shared)
+        if(count == 0u) std::this_thread::yield();
+
+        received += count;
+    }
+
+    auto const end = Clock::now();
+
+    for(std::thread & producer : producers) producer.join();
+
+    double const seconds = std::chrono::duration<double>(end - start).count();
+
+    std::vector<std::int64_t> & latencies = handler.latencies;
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << producerCount << " producer(s): "
+              << total / seconds / 1e6 << " M messages/s, latency p50 "
+              << latencies[latencies.size() / 2] / 1e3 << " us, p99 "
+              << latencies[latencies.size() * 99 / 100] / 1e3 << " us (checksum "
+              << handler.position + handler.health + handler.spawned << ")"
+              << std::endl;
+}
+
+int main()
+{
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency()
+              << std::endl;
+
+    for(std::size_t producers : { 1u, 4u, 16u })
+    {
+        Run(producers);
+    }
+
+    return 0;
+}
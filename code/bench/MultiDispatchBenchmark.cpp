@@ -0,0 +1,185 @@
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <MultiVisitor.hpp>
+#include <Visitable.hpp>
+
+// Double dispatch benchmark and check of the MultiVisitor fallbacks: the pairs
+// of shapes fall back to their nearest registered pair, second axis first,
+// e.g. (Circle, Square) to (Circle, Polygon). The collision visitor is built
+// by a static initializer, so most classes are registered after its vtable
+// (late tags, resolved through the cache of the vtable). Returns 1 if a pair
+// is dispatched to the wrong collide method.
+
+static constexpr std::size_t PairCount = 1u << 20;
+static constexpr int Passes = 10;
+
+class Shape : public Visitable<Shape>
+{
+    public:
+        META_BaseVisitable(Shape)
+
+        virtual ~Shape() { }
+};
+
+class Circle : public Shape
+{
+    public:
+        META_Visitable(Circle, Shape)
+};
+
+class Polygon : public Shape
+{
+    public:
+        META_Visitable(Polygon, Shape)
+};
+
+class Ellipse : public Circle
+{
+    public:
+        META_Visitable(Ellipse, Circle)
+};
+
+template <int N>
+class Regular : public Polygon
+{
+    public:
+        META_Visitable(Regular, Polygon)
+};
+
+using Square = Regular<4>;
+using Triangle = Regular<3>;
+
+//! Handlers, returned by the collide methods
+enum Handler { ShapeShape, CircleCircle, CirclePolygon, PolygonCircle };
+
+class CollisionVisitor : public MultiVisitor<Shape, Shape, int>
+{
+    public:
+        META_Visitor(CollisionVisitor, collide)
+
+        CollisionVisitor()
+        {
+            META_Visitables(
+                VisitablePair<Circle, Circle>,
+                VisitablePair<Circle, Polygon>,
+                VisitablePair<Polygon, Circle>
+            );
+        }
+
+    private:
+        int collide(Shape &, Shape &) { return ShapeShape; }
+        int collide(Circle &, Circle &) { return CircleCircle; }
+        int collide(Circle &, Polygon &) { return CirclePolygon; }
+        int collide(Polygon &, Circle &) { return PolygonCircle; }
+};
+
+//! Number of tags of the hierarchy when the vtable was built
+static std::size_t s_tagCount = 0u;
+
+// Run from a static initializer, as a visitor created before main
+static bool const s_built = (
+    CollisionVisitor(), s_tagCount = visitor_details::RegisterVisitableTags<Shape>(), true
+);
+
+//! Pair of shapes with the handler expected from the CollisionVisitor
+struct Sample
+{
+    std::unique_ptr<Shape> a;
+    std::unique_ptr<Shape> b;
+    int expected;
+};
+
+static std::vector<Sample> MakeSamples()
+{
+    std::vector<Sample> samples;
+
+    auto add = [&samples](Shape * a, Shape * b, int expected)
+    {
+        samples.push_back(Sample{std::unique_ptr<Shape>(a), std::unique_ptr<Shape>(b), expected});
+    };
+
+    add(new Shape(), new Shape(), ShapeShape);
+    add(new Circle(), new Circle(), CircleCircle);
+    add(new Circle(), new Polygon(), CirclePolygon);
+    add(new Polygon(), new Circle(), PolygonCircle);
+    add(new Circle(), new Square(), CirclePolygon);
+    add(new Ellipse(), new Triangle(), CirclePolygon);
+    add(new Ellipse(), new Ellipse(), CircleCircle);
+    add(new Square(), new Circle(), PolygonCircle);
+    add(new Triangle(), new Ellipse(), PolygonCircle);
+    add(new Regular<5>(), new Circle(), PolygonCircle);
+    add(new Circle(), new Regular<6>(), CirclePolygon);
+    add(new Square(), new Triangle(), ShapeShape);
+    add(new Polygon(), new Square(), ShapeShape);
+    add(new Shape(), new Circle(), ShapeShape);
+    add(new Circle(), new Shape(), ShapeShape);
+
+    return samples;
+}
+
+int main()
+{
+    std::vector<Sample> const samples = MakeSamples();
+    CollisionVisitor visitor;
+    int failures = 0;
+
+    (void) s_built;
+
+    std::size_t lateTags = 0u;
+
+    for(Sample const & sample : samples)
+    {
+        if(sample.a->visitable_tag() >= s_tagCount) ++lateTags;
+        if(sample.b->visitable_tag() >= s_tagCount) ++lateTags;
+
+        if(visitor(*sample.a, *sample.b) != sample.expected) ++failures;
+    }
+
+    std::cout << samples.size() << " pairs (" << lateTags << " late tags): " << failures
+              << " wrong fallbacks" << std::endl;
+
+    // Random pairs of the samples
+    std::mt19937 random(42u);
+    std::vector<std::pair<Shape *, Shape *>> pairs;
+    pairs.reserve(PairCount);
+
+    std::size_t expected = 0u;
+
+    for(std::size_t i = 0; i < PairCount; ++i)
+    {
+        Sample const & a = samples[random() % samples.size()];
+        Sample const & b = samples[random() % samples.size()];
+
+        pairs.emplace_back(a.a.get(), b.b.get());
+        expected += static_cast<std::size_t>(visitor(*a.a, *b.b));
+    }
+
+    auto const start = std::chrono::steady_clock::now();
+
+    std::size_t checksum = 0u;
+    for(int pass = 0; pass < Passes; ++pass)
+    {
+        for(std::pair<Shape *, Shape *> const & pair : pairs)
+        {
+            checksum += static_cast<std::size_t>(visitor(*pair.first, *pair.second));
+        }
+    }
+
+    double const ns = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start
+    ).count();
+
+    if(checksum != expected * Passes) ++failures;
+
+    std::cout << "dispatch: " << ns / (Passes * PairCount) << " ns per pair (checksum "
+              << checksum << "), vtable " << visitor.vtableFootprint() << " bytes"
+              << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ParallelVisit.hpp>
+#include <Visitable.hpp>
+#include <Visitor.hpp>
+
+// Scaling benchmark of ParallelReduce: 4M heap nodes reduced by pools of 1 to
+// N workers (N hardware threads, or the argument), checked against a serial
+// visit. The results are integers, so every reduction order gives the same
+// sum. Also checks that an exception thrown by a visit is rethrown by
+// ParallelVisit.
+
+static constexpr std::size_t NodeCount = 4u << 20;
+static constexpr int Passes = 5;
+
+class Node : public Visitable<Node>
+{
+    public:
+        META_BaseVisitable(Node)
+
+        virtual ~Node() { }
+
+        std::uint64_t value = 1u;
+};
+
+template <int N>
+class Derived : public Node
+{
+    public:
+        META_Visitable(Derived, Node)
+};
+
+class HashVisitor : public Visitor<Node, std::uint64_t>
+{
+    public:
+        META_Visitor(HashVisitor, hash)
+
+        HashVisitor()
+        {
+            META_Visitables(Derived<0>, Derived<1>, Derived<2>);
+        }
+
+    private:
+        //! A few dozen cycles of work per node
+        static std::uint64_t Mix(std::uint64_t x, int rounds)
+        {
+            for(int i = 0; i < rounds; ++i) x = (x ^ (x >> 31)) * 0x9E3779B97F4A7C15ull;
+            return x & 0xFFFFu;
+        }
+
+        std::uint64_t hash(Node & node) { return Mix(node.value, 8); }
+
+        template <int N>
+        std::uint64_t hash(Derived<N> & node) { return Mix(node.value + N, 8 + 4 * N); }
+};
+
+//! Visitor throwing on a node
+class ThrowingVisitor : public Visitor<Node, void>
+{
+    public:
+        META_Visitor(ThrowingVisitor, visit)
+
+        ThrowingVisitor()
+        {
+            META_Visitables(Derived<2>);
+        }
+
+    private:
+        void visit(Node &) { }
+        void visit(Derived<2> & node) { if(node.value == 0u) throw std::runtime_error("node 0"); }
+};
+
+static std::uint64_t Add(std::uint64_t a, std::uint64_t b)
+{
+    return a + b;
+}
+
+int main(int argc, char ** argv)
+{
+    std::mt19937 random(42u);
+
+    std::vector<std::unique_ptr<Node>> nodes;
+    nodes.reserve(NodeCount);
+
+    for(std::size_t i = 0; i < NodeCount; ++i)
+    {
+        switch(random() % 4u)
+        {
+            case 0: nodes.emplace_back(new Node()); break;
+            case 1: nodes.emplace_back(new Derived<0>()); break;
+            case 2: nodes.emplace_back(new Derived<1>()); break;
+            case 3: nodes.emplace_back(new Derived<2>()); break;
+        }
+
+        nodes.back()->value = i;
+    }
+
+    HashVisitor visitor;
+    std::uint64_t expected = 0u;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for(int pass = 0; pass < Passes; ++pass)
+    {
+        expected = 0u;
+        for(std::unique_ptr<Node> const & node : nodes) expected += visitor(*node);
+    }
+
+    double const serial = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start
+    ).count() / Passes;
+
+    std::cout << "serial    : " << serial << " ms per pass (sum " << expected << ")"
+              << std::endl;
+
+    std::size_t const maxWorkers = argc > 1 ?
+        std::max(1ul, std::stoul(argv[1])) : std::max(1u, std::thread::hardware_concurrency());
+    int failures = 0;
+
+    // 1, 2, 4, ... workers, then every hardware thread
+    std::vector<std::size_t> workerCounts;
+    for(std::size_t workers = 1; workers < maxWorkers; workers *= 2) workerCounts.push_back(workers);
+    workerCounts.push_back(maxWorkers);
+
+    for(std::size_t workers : workerCounts)
+    {
+        VisitThreadPool pool(workers);
+        std::uint64_t sum = 0u;
+
+        start = std::chrono::steady_clock::now();
+
+        for(int pass = 0; pass < Passes; ++pass)
+        {
+            sum = ParallelReduce(
+                pool, visitor, nodes.begin(), nodes.end(), std::uint64_t(0u), &Add
+            );
+        }
+
+        double const ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start
+        ).count() / Passes;
+
+        if(sum != expected) ++failures;
+
+        std::cout << workers << " worker" << (workers > 1u ? "s" : " ") << " : " << ms
+                  << " ms per pass, speedup " << serial / ms << " (sum " << sum
+                  << (sum == expected ? ")" : ", WRONG)") << std::endl;
+    }
+
+    // A visit throws on the node 0 (a Derived<2>)
+    nodes[0].reset(new Derived<2>());
+    nodes[0]->value = 0u;
+
+    VisitThreadPool pool(maxWorkers);
+    bool rethrown = false;
+
+    try
+    {
+        ParallelVisit(pool, ThrowingVisitor(), nodes.begin(), nodes.end());
+    }
+    catch(std::runtime_error const &)
+    {
+        rethrown = true;
+    }
+
+    if(!rethrown) ++failures;
+
+    std::cout << "exception : " << (rethrown ? "rethrown" : "LOST") << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}
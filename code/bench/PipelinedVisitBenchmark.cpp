@@ -0,0 +1,228 @@
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include <Visitable.hpp>
+#include <Visitor.hpp>
+#include <VisitTask.hpp>
+
+// Pipelined visit benchmark: the visit of a Polygon awaits a simulated load
+// (a fixed latency served by an I/O thread), the other visits complete
+// synchronously. The range is visited with 1 to 64 visits in flight, then the
+// cost of the coroutine machinery is measured with synchronous visits only
+
+static constexpr std::size_t ObjectCount = 2000u;
+static constexpr std::size_t SyncObjectCount = 1u << 20;
+static constexpr auto LoadLatency = std::chrono::microseconds(200);
+
+using Clock = std::chrono::steady_clock;
+
+// Thread resuming the coroutines once their load latency has elapsed
+class IoThread
+{
+    public:
+        struct Load
+        {
+            IoThread & io;
+
+            bool await_ready() const noexcept { return false; }
+
+            void await_suspend(std::coroutine_handle<> coroutine)
+            {
+                io.schedule(coroutine, Clock::now() + LoadLatency);
+            }
+
+            void await_resume() const noexcept { }
+        };
+
+        IoThread():
+            m_stop(false), m_thread(&IoThread::run, this)
+        {
+
+        }
+
+        ~IoThread()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+                m_wakeUp.notify_one();
+            }
+
+            m_thread.join();
+        }
+
+        Load load() { return Load{*this}; }
+
+    private:
+        using Pending = std::pair<Clock::time_point, std::coroutine_handle<>>;
+
+        struct Later
+        {
+            bool operator()(Pending const & a, Pending const & b) const
+            {
+                return a.first > b.first;
+            }
+        };
+
+        void schedule(std::coroutine_handle<> coroutine, Clock::time_point time)
+        {
+            // Notified under the lock: the frame of the awaiter may be resumed
+            // as soon as the lock is released
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending.emplace(time, coroutine);
+            m_wakeUp.notify_one();
+        }
+
+        void run()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            while(!m_stop)
+            {
+                if(m_pending.empty())
+                {
+                    m_wakeUp.wait(lock);
+                }
+                else if(m_pending.top().first > Clock::now())
+                {
+                    m_wakeUp.wait_until(lock, m_pending.top().first);
+                }
+                else
+                {
+                    std::coroutine_handle<> const coroutine = m_pending.top().second;
+                    m_pending.pop();
+
+                    lock.unlock();
+                    coroutine.resume();
+                    lock.lock();
+                }
+            }
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_wakeUp;
+        std::priority_queue<Pending, std::vector<Pending>, Later> m_pending;
+        bool m_stop;
+        std::thread m_thread;
+};
+
+class Shape : public Visitable<Shape>
+{
+    public:
+        META_BaseVisitable(Shape)
+
+        virtual ~Shape() { }
+};
+
+class Circle : public Shape
+{
+    public:
+        META_Visitable(Circle, Shape)
+};
+
+class Polygon : public Shape
+{
+    public:
+        META_Visitable(Polygon, Shape)
+
+        std::size_t vertexCount = 4u;
+};
+
+class Loader : public Visitor<Shape, Task<std::size_t>, std::size_t>
+{
+    public:
+        META_Visitor(Loader, load)
+
+        explicit Loader(IoThread & io):
+            m_io(io)
+        {
+            META_Visitables(Circle, Polygon);
+        }
+
+        Task<std::size_t> load(Shape &, std::size_t lod)
+        {
+            co_return lod;
+        }
+
+        Task<std::size_t> load(Circle &, std::size_t lod)
+        {
+            co_return lod + 1u;
+        }
+
+        Task<std::size_t> load(Polygon & polygon, std::size_t lod)
+        {
+            co_await m_io.load();
+            co_return polygon.vertexCount * lod;
+        }
+
+    private:
+        IoThread & m_io;
+};
+
+int main()
+{
+    IoThread io;
+    Loader loader(io);
+
+    std::vector<std::unique_ptr<Shape>> objects;
+    for(std::size_t i = 0; i < ObjectCount; ++i)
+    {
+        switch(i % 3u)
+        {
+            case 0: objects.emplace_back(new Shape()); break;
+            case 1: objects.emplace_back(new Circle()); break;
+            case 2: objects.emplace_back(new Polygon()); break;
+        }
+    }
+
+    for(std::size_t inFlight : { 1u, 4u, 16u, 64u })
+    {
+        std::size_t checksum = 0u;
+
+        auto const start = Clock::now();
+
+        SyncWait(PipelinedVisit(
+            loader, objects.begin(), objects.end(), inFlight,
+            [&checksum](std::size_t, std::size_t result) { checksum += result; },
+            std::size_t(2u)
+        ));
+
+        double const ms =
+            std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        std::cout << inFlight << " visit(s) in flight: " << ms << " ms for "
+                  << ObjectCount << " visits (checksum " << checksum << ")"
+                  << std::endl;
+    }
+
+    // Synchronous visits: cost of the tasks and of the pipeline
+    std::vector<std::unique_ptr<Shape>> circles;
+    for(std::size_t i = 0; i < SyncObjectCount; ++i) circles.emplace_back(new Circle());
+
+    std::size_t checksum = 0u;
+
+    auto const start = Clock::now();
+
+    SyncWait(PipelinedVisit(
+        loader, circles.begin(), circles.end(), 16u,
+        [&checksum](std::size_t, std::size_t result) { checksum += result; },
+        std::size_t(2u)
+    ));
+
+    double const ns =
+        std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+    std::cout << "Synchronous visits: " << ns / SyncObjectCount
+              << " ns per visit (checksum " << checksum << ")" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <RecordVisitor.hpp>
+#include <Visitable.hpp>
+#include <Visitor.hpp>
+
+// Replay benchmark: visit the records of a mapped event log in place, and
+// deserialize them into heap visitables visited by a Visitor
+
+static constexpr std::size_t RecordCount = 1u << 22;
+
+class Event : public Visitable<Event>
+{
+    public:
+        META_BaseVisitable(Event)
+        META_StableTag("bench.Event")
+
+        struct Record { std::uint32_t frame; };
+        META_VisitableRecord(Record)
+
+        Record record;
+};
+
+class Click : public Event
+{
+    public:
+        META_Visitable(Click, Event)
+        META_StableTag("bench.Click")
+
+        struct Record { std::uint32_t frame; float x; float y; };
+        META_VisitableRecord(Record)
+
+        Record record;
+};
+
+class Key : public Event
+{
+    public:
+        META_Visitable(Key, Event)
+        META_StableTag("bench.Key")
+
+        struct Record { std::uint32_t frame; std::uint32_t key; };
+        META_VisitableRecord(Record)
+
+        Record record;
+};
+
+class ReplayVisitor : public RecordVisitor<Event, double>
+{
+    public:
+        META_Visitor(ReplayVisitor, replay)
+
+        ReplayVisitor()
+        {
+            META_Visitables(Click, Key);
+        }
+
+    private:
+        double replay(RecordView<Event> const & event) { return event->frame; }
+        double replay(RecordView<Click> const & click) { return click->x + click->y; }
+        double replay(RecordView<Key> const & key) { return key->key; }
+};
+
+class ObjectVisitor : public Visitor<Event, double>
+{
+    public:
+        META_Visitor(ObjectVisitor, replay)
+
+        ObjectVisitor()
+        {
+            META_Visitables(Click, Key);
+        }
+
+    private:
+        double replay(Event & event) { return event.record.frame; }
+        double replay(Click & click) { return click.record.x + click.record.y; }
+        double replay(Key & key) { return key.record.key; }
+};
+
+template <typename Visitable>
+std::unique_ptr<Event> Deserialize(RecordHeader const & header)
+{
+    std::unique_ptr<Visitable> visitable(new Visitable());
+    visitable->record = *RecordView<Visitable>(header);
+    return std::unique_ptr<Event>(visitable.release());
+}
+
+int main()
+{
+    char const * const path = "RecordReplayBenchmark.log";
+
+    // Write the log
+    {
+        std::ofstream file(path, std::ios::binary);
+        RecordStreamWriter writer(file);
+        std::mt19937 random(42u);
+
+        for(std::uint32_t frame = 0; frame < RecordCount; ++frame)
+        {
+            switch(random() % 3u)
+            {
+                case 0: writer.write<Event>(Event::Record{frame}); break;
+                case 1: writer.write<Click>(Click::Record{frame, 1.f, 2.f}); break;
+                case 2: writer.write<Key>(Key::Record{frame, 65u}); break;
+            }
+        }
+    }
+
+    MappedRecordFile file;
+
+    if(!file.open(path))
+    {
+        std::cerr << "Cannot map " << path << std::endl;
+        return 1;
+    }
+
+    RecordStream const stream = file.stream();
+
+    // Visit the records in place
+    {
+        ReplayVisitor visitor;
+
+        auto const start = std::chrono::steady_clock::now();
+
+        double checksum = 0.0;
+        for(RecordHeader const & record : stream) checksum += visitor(record);
+
+        auto const end = std::chrono::steady_clock::now();
+
+        double const ns = std::chrono::duration<double, std::nano>(end - start).count();
+
+        std::cout << "in place   : " << ns / RecordCount << " ns per record, "
+                  << stream.size() / ns << " GB/s (checksum " << checksum << ")"
+                  << std::endl;
+    }
+
+    // Deserialize into heap visitables, then visit them
+    {
+        ObjectVisitor visitor;
+
+        auto const start = std::chrono::steady_clock::now();
+
+        std::vector<std::unique_ptr<Event>> events;
+        events.reserve(RecordCount);
+
+        for(RecordHeader const & record : stream)
+        {
+            switch(record.tag)
+            {
+                case Click::visitable_stable_tag():
+                    events.push_back(Deserialize<Click>(record));
+                    break;
+
+                case Key::visitable_stable_tag():
+                    events.push_back(Deserialize<Key>(record));
+                    break;
+
+                default:
+                    events.push_back(Deserialize<Event>(record));
+                    break;
+            }
+        }
+
+        double checksum = 0.0;
+        for(std::unique_ptr<Event> const & event : events) checksum += visitor(*event);
+
+        auto const end = std::chrono::steady_clock::now();
+
+        double const ns = std::chrono::duration<double, std::nano>(end - start).count();
+
+        std::cout << "deserialize: " << ns / RecordCount << " ns per record, "
+                  << stream.size() / ns << " GB/s (checksum " << checksum << ")"
+                  << std::endl;
+    }
+
+    file.close();
+    std::remove(path);
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <Visitable.hpp>
+#include <Visitor.hpp>
+
+// Stress test of the tag registration, built with ThreadSanitizer: 16 threads
+// started by a static initializer build their visitor and visit 64 classes
+// which are registered on their first visit, so the tags are registered
+// concurrently and after the vtables have been built (late tags). The test
+// fails if the threads disagree on a tag or a visitable is dispatched to the
+// wrong visit method (ThreadSanitizer reports the data races).
+
+static constexpr std::size_t ThreadCount = 16u;
+static constexpr std::size_t ClassCount = 64u;
+static constexpr std::size_t MidCount = 8u;
+static constexpr int Rounds = 200;
+
+class Root : public Visitable<Root>
+{
+    public:
+        META_BaseVisitable(Root)
+
+        virtual ~Root() { }
+};
+
+template <std::size_t N>
+class Mid : public Root
+{
+    public:
+        META_Visitable(Mid, Root)
+};
+
+template <std::size_t N>
+class Leaf : public Mid<N % MidCount>
+{
+    public:
+        META_Visitable(Leaf, Mid<N % MidCount>)
+};
+
+class LeafVisitor : public Visitor<Root, std::size_t>
+{
+    public:
+        META_Visitor(LeafVisitor)
+
+        LeafVisitor()
+        {
+            META_Visitables(Mid<1>, Leaf<3>);
+        }
+
+        std::size_t visit(Root &) { return 0u; }
+        std::size_t visit(Mid<1> &) { return 1u; }
+        std::size_t visit(Leaf<3> &) { return 3u; }
+};
+
+//! Visitable with the result expected from the LeafVisitor
+struct Sample
+{
+    std::unique_ptr<Root> visitable;
+    std::size_t expected;
+};
+
+template <std::size_t N>
+Sample MakeSample()
+{
+    return Sample{
+        std::unique_ptr<Root>(new Leaf<N>()), N == 3u ? 3u : (N % MidCount == 1u ? 1u : 0u)
+    };
+}
+
+template <std::size_t ...Indices>
+std::vector<Sample> MakeSamples(visitor_details::IndexSequence<Indices...>)
+{
+    Sample samples[] = { MakeSample<Indices>()... };
+
+    return std::vector<Sample>(
+        std::make_move_iterator(std::begin(samples)), std::make_move_iterator(std::end(samples))
+    );
+}
+
+//! Tags seen by each thread (in the order of the classes)
+static std::vector<std::size_t> s_tags[ThreadCount];
+static std::atomic<std::size_t> s_failures(0u);
+
+//! Number of tags of the hierarchy before the stress
+static std::size_t s_tagCount = 0u;
+
+static void Stress()
+{
+    std::atomic<std::size_t> ready(0u);
+    std::vector<std::thread> threads;
+
+    for(std::size_t t = 0; t < ThreadCount; ++t)
+    {
+        threads.emplace_back([t, &ready]()
+        {
+            // Start together to maximize the concurrent first visits
+            ++ready;
+            while(ready.load() < ThreadCount) std::this_thread::yield();
+
+            LeafVisitor visitor;
+
+            std::vector<Sample> samples =
+                MakeSamples(visitor_details::MakeIndexSequence<ClassCount>::Type());
+
+            for(int round = 0; round < Rounds; ++round)
+            {
+                for(std::size_t i = 0; i < ClassCount; ++i)
+                {
+                    Sample & sample = samples[(i + t * 7u) % ClassCount];
+
+                    if(visitor(*sample.visitable) != sample.expected) ++s_failures;
+                }
+            }
+
+            for(Sample & sample : samples) s_tags[t].push_back(sample.visitable->visitable_tag());
+        });
+    }
+
+    for(std::thread & thread : threads) thread.join();
+}
+
+// Run from a static initializer, as a visitor created before main
+static bool const s_stressed = (s_tagCount = visitor_details::RegisterVisitableTags<Root>(), Stress(), true);
+
+int main()
+{
+    std::size_t lateTags = 0u;
+
+    for(std::size_t t = 0; t < ThreadCount; ++t)
+    {
+        if(s_tags[t] != s_tags[0]) ++s_failures;
+    }
+
+    for(std::size_t tag : s_tags[0])
+    {
+        if(tag >= s_tagCount) ++lateTags;
+    }
+
+    if(std::set<std::size_t>(s_tags[0].begin(), s_tags[0].end()).size() != ClassCount)
+    {
+        ++s_failures;
+    }
+
+    // Again, once every tag is registered
+    Stress();
+
+    std::cout << ThreadCount << " threads, " << ClassCount << " classes ("
+              << lateTags << " registered during the stress): "
+              << s_failures.load() << " failures" << std::endl;
+
+    return s_stressed && s_failures.load() == 0u ? 0 : 1;
+}
@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <TreeTraversal.hpp>
+#include <Visitable.hpp>
+#include <Visitor.hpp>
+
+// Tree traversal benchmark: a scene graph of 10M nodes (1 to 8 children per
+// group) is laid out in shuffled order in memory, so every visited node is a
+// cache miss. A recursive visitor (descending in visit(Group &)) is compared
+// with the iterative pre-order walk without and with prefetching, then the
+// post-order and breadth-first walks and a pruned walk are timed
+
+static constexpr std::size_t NodeCount = 10000000u;
+static constexpr int Passes = 3;
+
+class Node : public Visitable<Node>
+{
+    public:
+        META_BaseVisitable(Node)
+
+        //! Range of children
+        struct Children
+        {
+            Node * const * first;
+            Node * const * last;
+
+            Node * const * begin() const { return first; }
+            Node * const * end() const { return last; }
+        };
+
+        Children children() const { return Children{m_first, m_first + m_count}; }
+
+        void setChildren(Node * const * first, std::uint32_t count)
+        {
+            m_first = first;
+            m_count = count;
+        }
+
+        float value = 1.f;
+
+    private:
+        Node * const * m_first = nullptr;
+        std::uint32_t m_count = 0u;
+};
+
+class Group : public Node
+{
+    public:
+        META_Visitable(Group, Node)
+};
+
+class List : public Group
+{
+    public:
+        META_Visitable(List, Group)
+};
+
+// Scene graph in a single arena, in shuffled order
+class SceneGraph
+{
+    public:
+        SceneGraph():
+            m_arena(new Slot[NodeCount]), m_children(NodeCount - 1u)
+        {
+            std::mt19937 random(42u);
+
+            std::vector<std::size_t> slots(NodeCount);
+            std::iota(slots.begin(), slots.end(), 0u);
+            std::shuffle(slots.begin(), slots.end(), random);
+
+            // Breadth-first construction: the groups get the next children
+            std::vector<Node *> nodes(NodeCount);
+            std::vector<bool> groups(NodeCount, false);
+            std::size_t created = 1u;
+
+            nodes[0] = ::new (&m_arena[slots[0]]) Group();
+            groups[0] = true;
+
+            for(std::size_t i = 0; i < created && created < NodeCount; ++i)
+            {
+                if(!groups[i]) continue;
+
+                // Wide root: pruning the lists does not prune the whole tree
+                std::size_t const count = std::min<std::size_t>(
+                    i == 0u ? 8u : 1u + random() % 8u, NodeCount - created
+                );
+
+                for(std::size_t c = 0; c < count; ++c, ++created)
+                {
+                    void * const slot = &m_arena[slots[created]];
+
+                    unsigned const kind = random() % 3u;
+
+                    switch(kind)
+                    {
+                        case 0: nodes[created] = ::new (slot) Node(); break;
+                        case 1: nodes[created] = ::new (slot) Group(); break;
+                        case 2: nodes[created] = ::new (slot) List(); break;
+                    }
+
+                    groups[created] = kind != 0u;
+                    m_children[created - 1u] = nodes[created];
+                }
+
+                nodes[i]->setChildren(&m_children[created - count - 1u], std::uint32_t(count));
+            }
+
+            m_root = nodes[0];
+            m_size = created;
+        }
+
+        Node & root() { return *m_root; }
+        std::size_t size() const { return m_size; }
+
+    private:
+        struct Slot
+        {
+            alignas(Group) unsigned char storage[sizeof(List)];
+        };
+
+        std::unique_ptr<Slot[]> m_arena;
+        std::vector<Node *> m_children;
+        Node * m_root;
+        std::size_t m_size;
+};
+
+Node::Children Children(Node & node)
+{
+    return node.children();
+}
+
+// Sum of the values, recursing in visit(Group &)
+class RecursiveVisitor : public Visitor<Node, void>
+{
+    public:
+        META_Visitor(RecursiveVisitor, visit)
+
+        RecursiveVisitor()
+        {
+            META_Visitables(Group, List);
+        }
+
+        void visit(Node & node)
+        {
+            sum += node.value;
+        }
+
+        void visit(Group & group)
+        {
+            sum += group.value;
+
+            for(Node * child : group.children()) (*this)(*child);
+        }
+
+        double sum = 0.0;
+};
+
+// Sum of the values, driven by a TreeTraversal
+class SumVisitor : public Visitor<Node, TraversalAction>
+{
+    public:
+        META_Visitor(SumVisitor, visit)
+
+        SumVisitor()
+        {
+            META_Visitables(Group, List);
+        }
+
+        TraversalAction visit(Node & node)
+        {
+            sum += node.value;
+            return TraversalAction::Continue;
+        }
+
+        TraversalAction visit(List & list)
+        {
+            sum += list.value;
+            return prune ? TraversalAction::Prune : TraversalAction::Continue;
+        }
+
+        double sum = 0.0;
+        bool prune = false;
+};
+
+// The functions return the sum of the values (1 per node): the number of
+// visited nodes
+template <typename Function>
+void Time(char const * name, Function function)
+{
+    double best = 0.0;
+    double visited = 0.0;
+
+    for(int pass = 0; pass < Passes; ++pass)
+    {
+        auto const start = std::chrono::steady_clock::now();
+
+        visited = function();
+
+        double const ns = std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - start
+        ).count();
+
+        if(pass == 0 || ns < best) best = ns;
+    }
+
+    std::cout << name << ": " << best / 1e6 << " ms, "
+              << best / visited << " ns per node (" << visited << " visited)"
+              << std::endl;
+}
+
+int main()
+{
+    SceneGraph graph;
+    Node & root = graph.root();
+
+    std::cout << graph.size() << " nodes" << std::endl;
+
+    Time("Recursive                     ", [&]()
+    {
+        RecursiveVisitor visitor;
+        visitor(root);
+        return visitor.sum;
+    });
+
+    for(std::size_t distance : { 0u, 4u, 8u })
+    {
+        TreeTraversal<Node> traversal(distance);
+
+        std::cout << "Prefetch distance " << distance << std::endl;
+
+        Time("  Pre-order                   ", [&]()
+        {
+            SumVisitor visitor;
+            traversal.preOrder(visitor, root, &Children);
+            return visitor.sum;
+        });
+
+        Time("  Post-order                  ", [&]()
+        {
+            SumVisitor visitor;
+            traversal.postOrder(visitor, root, &Children);
+            return visitor.sum;
+        });
+
+        Time("  Breadth-first               ", [&]()
+        {
+            SumVisitor visitor;
+            traversal.breadthFirst(visitor, root, &Children);
+            return visitor.sum;
+        });
+
+        Time("  Pre-order, lists pruned     ", [&]()
+        {
+            SumVisitor visitor;
+            visitor.prune = true;
+            traversal.preOrder(visitor, root, &Children);
+            return visitor.sum;
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+
+#include <Visitor.hpp>
+#include <Visitable.hpp>
+
+// Startup benchmark: build 1000 visitor vtables over a hierarchy of more than
+// 1000 visitable classes (32 intermediate classes, 32 leaves per intermediate)
+
+static constexpr int MidCount  = 32;
+static constexpr int LeafCount = 32 * MidCount;
+
+static constexpr int VisitorCount = 1000;
+static constexpr int HandlersPerVisitor = 8;
+
+class Root : public Visitable<Root>
+{
+    public:
+        META_BaseVisitable(Root)
+};
+
+template <int N>
+class Mid : public Root
+{
+    public:
+        META_Visitable(Mid, Root)
+};
+
+template <int N>
+class Leaf : public Mid<N % MidCount>
+{
+    public:
+        META_Visitable(Leaf, Mid<N % MidCount>)
+};
+
+//! Register the tags of the classes in [Begin, End) (logarithmic recursion)
+template <template <int> class Class, int Begin, int End>
+struct RegisterRange
+{
+    static void Register()
+    {
+        RegisterRange<Class, Begin, (Begin + End) / 2>::Register();
+        RegisterRange<Class, (Begin + End) / 2, End>::Register();
+    }
+};
+
+template <template <int> class Class, int Begin>
+struct RegisterRange<Class, Begin, Begin + 1>
+{
+    static void Register()
+    {
+        visitor_details::GetVisitableTag<Class<Begin>, Root>();
+    }
+};
+
+//! Fake handlers: only the build of the tables is measured
+using Func = void (*)();
+
+template <int N>
+void Handler() { }
+
+static Func const s_handlers[HandlersPerVisitor] = {
+    &Handler<0>, &Handler<1>, &Handler<2>, &Handler<3>,
+    &Handler<4>, &Handler<5>, &Handler<6>, &Handler<7>
+};
+
+using VTable = visitor_details::VisitorVTable<Root const, Func>;
+
+//! Build the vtable of a visitor handling Root, some Mid and some Leaf classes
+template <int N>
+void AddHandlers(VTable & vtable)
+{
+    vtable.add<Root>(s_handlers[0]);
+    vtable.add<Mid<N % MidCount>>(s_handlers[1]);
+    vtable.add<Mid<(N + 7) % MidCount>>(s_handlers[2]);
+    vtable.add<Mid<(N + 13) % MidCount>>(s_handlers[3]);
+    vtable.add<Leaf<N % LeafCount>>(s_handlers[4]);
+    vtable.add<Leaf<(N * 7) % LeafCount>>(s_handlers[5]);
+    vtable.add<Leaf<(N * 13) % LeafCount>>(s_handlers[6]);
+    vtable.add<Leaf<(N * 31) % LeafCount>>(s_handlers[7]);
+}
+
+int main()
+{
+    RegisterRange<Mid, 0, MidCount>::Register();
+    RegisterRange<Leaf, 0, LeafCount>::Register();
+
+    std::size_t const size = visitor_details::RegisterVisitableTags<Root>();
+
+    auto const start = std::chrono::steady_clock::now();
+
+    std::size_t checksum = 0u;
+    for(int i = 0; i < VisitorCount; ++i)
+    {
+        VTable vtable(size);
+
+        switch(i % 4)
+        {
+            case 0: AddHandlers<0>(vtable); break;
+            case 1: AddHandlers<1>(vtable); break;
+            case 2: AddHandlers<2>(vtable); break;
+            case 3: AddHandlers<3>(vtable); break;
+        }
+
+        vtable.resolveFallbacks();
+
+        checksum += vtable[size - 1] == s_handlers[0] ? 1u : 0u;
+    }
+
+    auto const end = std::chrono::steady_clock::now();
+
+    double const us =
+        std::chrono::duration<double, std::micro>(end - start).count();
+
+    std::cout << "Built " << VisitorCount << " vtables of " << size
+              << " slots in " << us << " us (" << us / VisitorCount
+              << " us per vtable, checksum " << checksum << ")" << std::endl;
+
+    return 0;
+}
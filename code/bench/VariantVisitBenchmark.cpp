@@ -0,0 +1,147 @@
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <variant>
+#include <vector>
+
+#include <Visitable.hpp>
+#include <VariantVisit.hpp>
+#include <Visitor.hpp>
+
+// Visitation of 10M shapes stored by value in a vector of std::variant (with
+// std::visit and with a visitor of the hierarchy) and stored on the heap
+// (visited through pointers)
+
+static constexpr std::size_t ShapeCount = 10000000u;
+static constexpr int Passes = 5;
+
+class Shape : public Visitable<Shape>
+{
+    public:
+        META_BaseVisitable(Shape)
+
+        virtual ~Shape() { }
+
+        float size = 1.f;
+};
+
+class Circle : public Shape
+{
+    public:
+        META_Visitable(Circle, Shape)
+};
+
+class Polygon : public Shape
+{
+    public:
+        META_Visitable(Polygon, Shape)
+};
+
+class Square : public Polygon
+{
+    public:
+        META_Visitable(Square, Polygon)
+};
+
+using ShapeValue = std::variant<Circle, Polygon, Square>;
+
+class AreaVisitor : public Visitor<Shape, void>
+{
+    public:
+        META_Visitor(AreaVisitor, area)
+
+        AreaVisitor()
+        {
+            META_Visitables(Circle, Polygon);
+        }
+
+        double total = 0.0;
+
+    private:
+        void area(Shape & shape) { total += shape.size; }
+        void area(Circle & circle) { total += 3.14159f * circle.size * circle.size; }
+        void area(Polygon & polygon) { total += polygon.size * polygon.size; }
+};
+
+//! Overload set of lambdas for std::visit
+template <typename ...Lambdas>
+struct Overloaded : Lambdas...
+{
+    using Lambdas::operator()...;
+};
+
+template <typename ...Lambdas>
+Overloaded(Lambdas...) -> Overloaded<Lambdas...>;
+
+template <typename Visit>
+void Run(char const * name, Visit visit)
+{
+    double total = 0.0;
+
+    auto const start = std::chrono::steady_clock::now();
+
+    for(int pass = 0; pass < Passes; ++pass) total += visit();
+
+    auto const end = std::chrono::steady_clock::now();
+
+    double const ns =
+        std::chrono::duration<double, std::nano>(end - start).count();
+
+    std::cout << name << ": " << ns / (Passes * ShapeCount)
+              << " ns per visit (checksum " << total << ")" << std::endl;
+}
+
+int main()
+{
+    std::mt19937 random(42u);
+
+    std::vector<ShapeValue> values;
+    std::vector<std::unique_ptr<Shape>> pointers;
+
+    values.reserve(ShapeCount);
+    pointers.reserve(ShapeCount);
+
+    for(std::size_t i = 0; i < ShapeCount; ++i)
+    {
+        switch(random() % 3u)
+        {
+            case 0: values.emplace_back(Circle()); pointers.emplace_back(new Circle()); break;
+            case 1: values.emplace_back(Polygon()); pointers.emplace_back(new Polygon()); break;
+            case 2: values.emplace_back(Square()); pointers.emplace_back(new Square()); break;
+        }
+    }
+
+    Run("std::visit (values)     ", [&]()
+    {
+        double total = 0.0;
+
+        auto const area = Overloaded{
+            [&](Circle & circle) { total += 3.14159f * circle.size * circle.size; },
+            [&](Polygon & polygon) { total += polygon.size * polygon.size; }
+        };
+
+        for(ShapeValue & value : values) std::visit(area, value);
+
+        return total;
+    });
+
+    Run("VisitVariant (values)   ", [&]()
+    {
+        AreaVisitor visitor;
+        VisitVariantRange(visitor, values.begin(), values.end());
+
+        return visitor.total;
+    });
+
+    Run("visitor (heap pointers) ", [&]()
+    {
+        AreaVisitor visitor;
+        for(std::unique_ptr<Shape> const & shape : pointers) visitor(*shape);
+
+        return visitor.total;
+    });
+
+    return 0;
+}
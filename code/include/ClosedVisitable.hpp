@@ -0,0 +1,45 @@
+#ifndef CLOSED_VISITABLE_HPP
+#define CLOSED_VISITABLE_HPP
+
+#include "ClosedVisitorDetails.hpp"
+#include "Visitable.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Visitable base class of a closed hierarchy.
+///
+/// When every visitable class is known at compile time, the hierarchy can be
+/// declared as a VisitableHierarchy: the tags are then compile-time constants
+/// (the index of each class in the list) and no tag is registered at runtime.
+/// The visitable classes use the same macros as the Visitable ones.
+/// For example:
+/// \code
+///     class Shape;
+///     class Circle;
+///
+///     using ShapeHierarchy = VisitableHierarchy<Shape, Circle>;
+///
+///     class Shape : public ClosedVisitable<ShapeHierarchy>
+///     {
+///         public:
+///             META_BaseVisitable(Shape)
+///     };
+///
+///     class Circle : public Shape
+///     {
+///         public:
+///             META_Visitable(Circle, Shape)
+///     };
+/// \endcode
+////////////////////////////////////////////////////////////////////////////////
+template <typename Hierarchy>
+struct ClosedVisitable
+{
+    protected:
+        template <typename VisitableImpl>
+        constexpr std::size_t getTagHelper(VisitableImpl const *) const
+        {
+            return visitor_details::ClosedVisitableTag<VisitableImpl, Hierarchy>::value;
+        }
+};
+
+#endif //CLOSED_VISITABLE_HPP
@@ -0,0 +1,88 @@
+#ifndef CLOSED_VISITOR_HPP
+#define CLOSED_VISITOR_HPP
+
+#include "ClosedVisitorDetails.hpp"
+#include "Visitor.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Visitor base class of a closed hierarchy (see ClosedVisitable).
+///
+/// It is used exactly like a Visitor (META_Visitor, META_Visitables and
+/// operator()) but the hierarchy is given instead of its base class:
+/// \code
+///     class ShapeVisitor : public ClosedVisitor<ShapeHierarchy, bool>
+/// \endcode
+/// A const hierarchy (ClosedVisitor<ShapeHierarchy const, bool>) creates a
+/// const visitor.
+///
+/// The tags and the fallback to the nearest visited ancestor are resolved at
+/// compile time. The vtable is replaced by a dispatch function switching on
+/// the tag, so no table is built at static initialization and the compiler can
+/// inline the handlers into a jump table.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Hierarchy, typename ReturnType = void, typename ...Args>
+class ClosedVisitor
+{
+    public:
+        using BaseType =
+            typename visitor_details::ClosedHierarchyTraits<Hierarchy>::BaseType;
+
+        //! Type passing an extra argument through the dispatch (see
+        /// visitor_details::VisitorArgument)
+        template <typename T>
+        using ArgumentType = visitor_details::VisitorArgumentType<T>;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Perform the visitation of the given visitable.
+        /// \param b Visitable to visit.
+        /// \return The result of the visitation.
+        ////////////////////////////////////////////////////////////////////////
+        ReturnType operator()(BaseType & b, ArgumentType<Args> ...args);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Perform the visitation of the visitable of a handle.
+        /// The switch dispatch reads the tag from the visitable: the tag of
+        /// the handle is not used.
+        ////////////////////////////////////////////////////////////////////////
+        ReturnType operator()(
+            VisitableHandle<BaseType> const & handle, ArgumentType<Args> ...args
+        );
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Call the visit method of the given visitable.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename VisitorImpl, typename Visitable, typename Invoker>
+        static ReturnType thunk(
+            ClosedVisitor & visitor, BaseType & b, ArgumentType<Args> ...args
+        );
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Dispatch the visitation with the given switch.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Switch>
+        static ReturnType dispatch(
+            ClosedVisitor & visitor, BaseType & b, ArgumentType<Args> ...args
+        );
+
+    public:
+        using HierarchyType = Hierarchy;
+        using VTableType    =
+            ReturnType (*)(ClosedVisitor &, BaseType &, ArgumentType<Args>...);
+        using RType         = ReturnType;
+
+        //! Class used by META_Visitables to retrieve the dispatch function
+        template <typename VisitorImpl, typename Invoker, typename ...VisitedList>
+        using VTableGetter =
+            visitor_details::GetClosedVisitorVTable<VisitorImpl, Invoker, VisitedList...>;
+
+    private:
+        template <typename VisitorImpl, typename Invoker, typename ...VisitedList>
+        friend struct VisitorVTableSetter;
+
+        VTableType m_vtable; ///< Dispatch function
+};
+
+
+#include "ClosedVisitor.inl"
+
+#endif //CLOSED_VISITOR_HPP
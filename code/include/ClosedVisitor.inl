@@ -0,0 +1,54 @@
+#ifndef CLOSED_VISITOR_INL
+#define CLOSED_VISITOR_INL
+
+#include "ClosedVisitor.hpp"
+
+template <typename Hierarchy, typename ReturnType, typename ...Args>
+inline ReturnType ClosedVisitor<Hierarchy, ReturnType, Args...>::operator()(
+    BaseType & b, ArgumentType<Args> ...args
+)
+{
+    return m_vtable(*this, b, visitor_details::ForwardArgument<Args>(args)...);
+}
+
+template <typename Hierarchy, typename ReturnType, typename ...Args>
+inline ReturnType ClosedVisitor<Hierarchy, ReturnType, Args...>::operator()(
+    VisitableHandle<BaseType> const & handle, ArgumentType<Args> ...args
+)
+{
+    return m_vtable(
+        *this, *handle, visitor_details::ForwardArgument<Args>(args)...
+    );
+}
+
+template <typename Hierarchy, typename ReturnType, typename ...Args>
+template <typename VisitorImpl, typename Visitable, typename Invoker>
+inline ReturnType ClosedVisitor<Hierarchy, ReturnType, Args...>::thunk(
+    ClosedVisitor & v, BaseType & b, ArgumentType<Args> ...args
+)
+{
+    using VisitableType = typename
+        visitor_details::GetVisitMethodArgumentType<Visitable, BaseType>::Type;
+
+    VisitorImpl & visitor = static_cast<VisitorImpl&>(v);
+
+    VisitableType & visitable = static_cast<VisitableType &>(b);
+
+    return Invoker::Invoke(
+        visitor, visitable, visitor_details::ForwardArgument<Args>(args)...
+    );
+}
+
+template <typename Hierarchy, typename ReturnType, typename ...Args>
+template <typename Switch>
+inline ReturnType ClosedVisitor<Hierarchy, ReturnType, Args...>::dispatch(
+    ClosedVisitor & visitor, BaseType & b, ArgumentType<Args> ...args
+)
+{
+    return Switch::Dispatch(
+        visitor_details::GetDispatchTag(b),
+        visitor, b, visitor_details::ForwardArgument<Args>(args)...
+    );
+}
+
+#endif //CLOSED_VISITOR_INL
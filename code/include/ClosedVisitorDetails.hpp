@@ -0,0 +1,316 @@
+#ifndef CLOSED_VISITOR_DETAILS_HPP
+#define CLOSED_VISITOR_DETAILS_HPP
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief List of every visitable class of a closed hierarchy.
+/// The first class is the base class of the hierarchy.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base, typename ...Visitables>
+struct VisitableHierarchy { };
+
+namespace visitor_details {
+
+//////////////////////////////// TYPE LIST /////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Index of a type in a list of types (comparison ignores const).
+////////////////////////////////////////////////////////////////////////////////
+template <typename T, typename ...List>
+struct IndexOf;
+
+template <typename T, typename Head, typename ...Tail>
+struct IndexOf<T, Head, Tail...>
+{
+    static constexpr std::size_t value =
+        std::is_same<
+            typename std::remove_const<T>::type,
+            typename std::remove_const<Head>::type
+        >::value ? 0u : 1u + IndexOf<T, Tail...>::value;
+};
+
+template <typename T>
+struct IndexOf<T>
+{
+    static constexpr std::size_t value = 0u;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Type at the given index in a list of types.
+////////////////////////////////////////////////////////////////////////////////
+template <std::size_t Index, typename ...List>
+struct TypeAt;
+
+template <std::size_t Index, typename Head, typename ...Tail>
+struct TypeAt<Index, Head, Tail...>
+{
+    using Type = typename TypeAt<Index - 1, Tail...>::Type;
+};
+
+template <typename Head, typename ...Tail>
+struct TypeAt<0, Head, Tail...>
+{
+    using Type = Head;
+};
+
+
+////////////////////////////// CLOSED HIERARCHY ////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Compile-time information about a closed hierarchy.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Hierarchy>
+struct ClosedHierarchyTraits;
+
+template <typename Base, typename ...Visitables>
+struct ClosedHierarchyTraits<VisitableHierarchy<Base, Visitables...>>
+{
+    using BaseType = Base;
+
+    static constexpr std::size_t Size = 1u + sizeof...(Visitables);
+
+    template <typename Visitable>
+    using Tag = IndexOf<Visitable, Base, Visitables...>;
+
+    template <std::size_t Tag>
+    using Visitable = TypeAt<Tag, Base, Visitables...>;
+};
+
+// Specialization for const hierarchy (const visitation)
+template <typename Base, typename ...Visitables>
+struct ClosedHierarchyTraits<VisitableHierarchy<Base, Visitables...> const>:
+    ClosedHierarchyTraits<VisitableHierarchy<Base, Visitables...>>
+{
+    using BaseType = Base const;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Compile-time tag of a visitable class in a closed hierarchy.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Visitable, typename Hierarchy>
+struct ClosedVisitableTag
+{
+    using Traits = ClosedHierarchyTraits<Hierarchy>;
+
+    static constexpr std::size_t value =
+        Traits::template Tag<Visitable>::value;
+
+    static_assert(value < Traits::Size, "Visitable not in the closed hierarchy");
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Find the nearest ancestor of Visitable (itself included) which is
+/// in VisitedList, by falling through the VisitableFallbackType.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Visitable, typename ...VisitedList>
+struct NearestVisited;
+
+template <typename Visitable, bool Visited, typename ...VisitedList>
+struct NearestVisitedImpl
+{
+    using Type = Visitable;
+};
+
+template <typename Visitable, typename ...VisitedList>
+struct NearestVisitedImpl<Visitable, false, VisitedList...>
+{
+    using Type = typename NearestVisited<
+        typename Visitable::VisitableFallbackType, VisitedList...
+    >::Type;
+};
+
+template <typename Visitable, typename ...VisitedList>
+struct NearestVisited
+{
+    using Type = typename NearestVisitedImpl<
+        Visitable,
+        IndexOf<Visitable, VisitedList...>::value < sizeof...(VisitedList),
+        VisitedList...
+    >::Type;
+};
+
+
+////////////////////////////// SWITCH DISPATCH /////////////////////////////////
+
+//! Number of cases of each switch block used by the closed visitors
+static constexpr std::size_t ClosedSwitchBlockSize = 16u;
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Call the thunk of the nearest visited ancestor of the visitable with
+/// the given tag. Tags outside of the hierarchy are mapped to the base class
+/// (they are never dispatched but are needed to complete the switch blocks).
+////////////////////////////////////////////////////////////////////////////////
+template <
+    typename VisitorImpl, typename Invoker, typename Hierarchy,
+    std::size_t Tag, bool Valid, typename ...VisitedList
+>
+struct ClosedSwitchCase
+{
+    using Traits = ClosedHierarchyTraits<Hierarchy>;
+
+    using Visitable = typename NearestVisited<
+        typename Traits::template Visitable<Tag>::Type, VisitedList...
+    >::Type;
+
+    template <typename Visitor, typename ...Args>
+    static typename Visitor::RType Invoke(
+        Visitor & visitor, typename Traits::BaseType & b, Args && ...args
+    )
+    {
+        return Visitor::template thunk<VisitorImpl, Visitable, Invoker>(
+            visitor, b, std::forward<Args>(args)...
+        );
+    }
+};
+
+template <
+    typename VisitorImpl, typename Invoker, typename Hierarchy,
+    std::size_t Tag, typename ...VisitedList
+>
+struct ClosedSwitchCase<VisitorImpl, Invoker, Hierarchy, Tag, false, VisitedList...>:
+    ClosedSwitchCase<VisitorImpl, Invoker, Hierarchy, 0u, true, VisitedList...>
+{
+
+};
+
+//! Internal macro generating the case <Offset + Index> of a switch block
+#define _META_CLOSED_SWITCH_CASE_(Index) \
+    case Index: \
+        return ClosedSwitchCase< \
+            VisitorImpl, Invoker, Hierarchy, Offset + Index, \
+            (Offset + Index < Size), VisitedList... \
+        >::Invoke(visitor, b, std::forward<Args>(args)...);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Dispatch a tag with a block of ClosedSwitchBlockSize cases starting
+/// at Offset, and chain to the next block for the greater tags.
+/// The cases are contiguous so the compiler emits a jump table and can inline
+/// the handlers.
+////////////////////////////////////////////////////////////////////////////////
+template <
+    typename VisitorImpl, typename Invoker, typename Hierarchy,
+    std::size_t Offset, bool Last, typename ...VisitedList
+>
+struct ClosedSwitch
+{
+    static constexpr std::size_t Size = ClosedHierarchyTraits<Hierarchy>::Size;
+
+    template <typename Visitor, typename ...Args>
+    static typename Visitor::RType Dispatch(
+        std::size_t tag,
+        Visitor & visitor,
+        typename ClosedHierarchyTraits<Hierarchy>::BaseType & b,
+        Args && ...args
+    )
+    {
+        switch(tag - Offset)
+        {
+            _META_CLOSED_SWITCH_CASE_(0)
+            _META_CLOSED_SWITCH_CASE_(1)
+            _META_CLOSED_SWITCH_CASE_(2)
+            _META_CLOSED_SWITCH_CASE_(3)
+            _META_CLOSED_SWITCH_CASE_(4)
+            _META_CLOSED_SWITCH_CASE_(5)
+            _META_CLOSED_SWITCH_CASE_(6)
+            _META_CLOSED_SWITCH_CASE_(7)
+            _META_CLOSED_SWITCH_CASE_(8)
+            _META_CLOSED_SWITCH_CASE_(9)
+            _META_CLOSED_SWITCH_CASE_(10)
+            _META_CLOSED_SWITCH_CASE_(11)
+            _META_CLOSED_SWITCH_CASE_(12)
+            _META_CLOSED_SWITCH_CASE_(13)
+            _META_CLOSED_SWITCH_CASE_(14)
+            _META_CLOSED_SWITCH_CASE_(15)
+            default: break;
+        }
+
+        return ClosedSwitch<
+            VisitorImpl, Invoker, Hierarchy,
+            Offset + ClosedSwitchBlockSize,
+            (Offset + 2u * ClosedSwitchBlockSize >= Size),
+            VisitedList...
+        >::Dispatch(tag, visitor, b, std::forward<Args>(args)...);
+    }
+};
+
+// Last block: no greater tag can be dispatched, fall back to the base class
+template <
+    typename VisitorImpl, typename Invoker, typename Hierarchy,
+    std::size_t Offset, typename ...VisitedList
+>
+struct ClosedSwitch<VisitorImpl, Invoker, Hierarchy, Offset, true, VisitedList...>
+{
+    static constexpr std::size_t Size = ClosedHierarchyTraits<Hierarchy>::Size;
+
+    template <typename Visitor, typename ...Args>
+    static typename Visitor::RType Dispatch(
+        std::size_t tag,
+        Visitor & visitor,
+        typename ClosedHierarchyTraits<Hierarchy>::BaseType & b,
+        Args && ...args
+    )
+    {
+        switch(tag - Offset)
+        {
+            _META_CLOSED_SWITCH_CASE_(0)
+            _META_CLOSED_SWITCH_CASE_(1)
+            _META_CLOSED_SWITCH_CASE_(2)
+            _META_CLOSED_SWITCH_CASE_(3)
+            _META_CLOSED_SWITCH_CASE_(4)
+            _META_CLOSED_SWITCH_CASE_(5)
+            _META_CLOSED_SWITCH_CASE_(6)
+            _META_CLOSED_SWITCH_CASE_(7)
+            _META_CLOSED_SWITCH_CASE_(8)
+            _META_CLOSED_SWITCH_CASE_(9)
+            _META_CLOSED_SWITCH_CASE_(10)
+            _META_CLOSED_SWITCH_CASE_(11)
+            _META_CLOSED_SWITCH_CASE_(12)
+            _META_CLOSED_SWITCH_CASE_(13)
+            _META_CLOSED_SWITCH_CASE_(14)
+            _META_CLOSED_SWITCH_CASE_(15)
+            default: break;
+        }
+
+        return ClosedSwitchCase<
+            VisitorImpl, Invoker, Hierarchy, 0u, true, VisitedList...
+        >::Invoke(visitor, b, std::forward<Args>(args)...);
+    }
+};
+
+#undef _META_CLOSED_SWITCH_CASE_
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Class used to retrieve the dispatch function of a closed visitor
+/// for the triplet (Visitor, Invoker, VisitedList...).
+/// Nothing is built at runtime: the function is a compile-time constant.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Visitor, typename Invoker, typename ...VisitedList>
+struct GetClosedVisitorVTable
+{
+    using Hierarchy = typename Visitor::HierarchyType;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Return the dispatch function.
+    ////////////////////////////////////////////////////////////////////////////
+    operator typename Visitor::VTableType () const
+    {
+        // Base's visit function is always visited
+        return &Visitor::template dispatch<
+            ClosedSwitch<
+                Visitor, Invoker, Hierarchy, 0u,
+                (ClosedSwitchBlockSize >= ClosedHierarchyTraits<Hierarchy>::Size),
+                typename Visitor::BaseType, VisitedList...
+            >
+        >;
+    }
+};
+
+} // visitor_details
+
+
+#endif //CLOSED_VISITOR_DETAILS_HPP
@@ -0,0 +1,190 @@
+#ifndef FUSED_VISITOR_HPP
+#define FUSED_VISITOR_HPP
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+
+#include "VisitableHandle.hpp"
+#include "Visitor.hpp"
+#include "VisitorDetails.hpp"
+
+namespace visitor_details {
+
+//! Result of a component visitor returning void
+struct FusedVoid { };
+
+//! Result stored for a component visitor (FusedVoid for void)
+template <typename R>
+using FusedResultType = typename std::conditional<
+    std::is_void<R>::value, FusedVoid, R
+>::type;
+
+} // visitor_details
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Visitor running several visitors in a single pass (see
+/// FusedVisitor).
+////////////////////////////////////////////////////////////////////////////////
+template <typename Arguments, typename ...Visitors>
+class BasicFusedVisitor;
+
+template <typename ...Args, typename First, typename ...Others>
+class BasicFusedVisitor<visitor_details::ArgumentList<Args...>, First, Others...>
+{
+    public:
+        using BaseType = typename First::BaseType;
+
+        //! Results of the visitors (FusedVoid for the visitors returning void)
+        using RType = std::tuple<
+            visitor_details::FusedResultType<typename First::RType>,
+            visitor_details::FusedResultType<typename Others::RType>...
+        >;
+
+        using Thunk      = RType (*)(BasicFusedVisitor &, BaseType &, Args...);
+        using VTableType = visitor_details::VisitorVTable<BaseType const, Thunk>;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Constructor.
+        /// \param first  First visitor (called first).
+        /// \param others Other visitors, called in this order.
+        ////////////////////////////////////////////////////////////////////////
+        explicit BasicFusedVisitor(First & first, Others & ...others);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Visit a visitable with every visitor: the tag is resolved
+        /// once for all of them.
+        /// \return The results of the visitors.
+        ////////////////////////////////////////////////////////////////////////
+        RType operator()(BaseType & b, Args ...args);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Visit the visitable of a handle with every visitor.
+        ////////////////////////////////////////////////////////////////////////
+        RType operator()(VisitableHandle<BaseType> const & handle, Args ...args);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Visit a range of visitables with every visitor, in the order
+        /// of the range: each visitable is loaded once for all the visitors.
+        /// \param first Beginning of the range (references, pointers or
+        ///              handles).
+        /// \param last  End of the range.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename InputIt>
+        void visitRange(InputIt first, InputIt last, Args ...args);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Visit a VisitableCollection with every visitor: the dispatch
+        /// is resolved once per segment.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Collection>
+        void visitCollection(Collection & collection, Args ...args);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Fuse the visits of the given visitables: a single thunk per
+        /// visitable calls the visit methods of every visitor directly (so
+        /// they can be inlined). The fused thunk tables are built once per
+        /// list of visitables.
+        ///
+        /// A fused visitable is visited as if every visitor listed it in
+        /// META_Visitables (its visit methods are selected by overload
+        /// resolution), and the runtime overrides of the visitors are
+        /// bypassed. The other visitables are still dispatched by the vtable
+        /// of each visitor.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename ...Visitables>
+        void fuse();
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Dispatch every visitable by the vtable of each visitor.
+        ////////////////////////////////////////////////////////////////////////
+        void unfuse();
+
+    private:
+        //! Type of the visitor at the given index
+        template <std::size_t Index>
+        using VisitorAt = typename std::tuple_element<
+            Index, std::tuple<First, Others...>
+        >::type;
+
+        using VisitorIndices = typename visitor_details::MakeIndexSequence<
+            1u + sizeof...(Others)
+        >::Type;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Visit a visitable of the given tag.
+        ////////////////////////////////////////////////////////////////////////
+        RType dispatch(std::size_t tag, BaseType & b, Args ...args);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Call every visitor with a handle (dispatched by its vtable).
+        ////////////////////////////////////////////////////////////////////////
+        template <std::size_t ...Indices>
+        RType dispatchEach(
+            visitor_details::IndexSequence<Indices...>,
+            VisitableHandle<BaseType> const & handle, Args ...args
+        );
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Fused thunk: call the visit methods of every visitor.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Visitable>
+        static RType FusedThunk(BasicFusedVisitor & fused, BaseType & b, Args ...args);
+
+        template <typename Visitable, std::size_t ...Indices>
+        RType visitEach(
+            visitor_details::IndexSequence<Indices...>, BaseType & b, Args ...args
+        );
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the fused thunk table of the given visitables
+        /// (built on first use, thread-safe). Only the fused visitables have
+        /// a thunk: the table is not resolved.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename ...Visitables>
+        static VTableType const & GetFusedVTable();
+
+        template <typename Head, typename ...Tail>
+        static void AddFusedThunks(VTableType & vtable, visitor_details::ThunkTag<Head, Tail...>);
+
+        static void AddFusedThunks(VTableType &, visitor_details::ThunkTag<>) { }
+
+    private:
+        std::tuple<First &, Others &...> m_visitors; ///< Visitors
+        VTableType const * m_fused;                  ///< Fused thunks (or null)
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Visitor running several visitors in a single pass.
+///
+/// Running N visitors back to back over the same visitables streams them N
+/// times through the cache and resolves their tag N times. A fused visitor
+/// resolves the tag once per visitable, then calls every visitor with it (in
+/// the order of the visitors), and returns their results in a tuple:
+/// \code
+///     UpdateVisitor update;
+///     CullVisitor cull;
+///     StatsVisitor stats;
+///
+///     FusedVisitor<UpdateVisitor, CullVisitor, StatsVisitor> frame(update, cull, stats);
+///     frame.fuse<Mesh, Light>(); // Optional: fused thunks for the common types
+///
+///     frame.visitRange(nodes.begin(), nodes.end(), dt);
+/// \endcode
+/// The visitors are Visitor classes of the same hierarchy and with the same
+/// extra arguments (passed to each visitor, so they cannot be declared T &&).
+////////////////////////////////////////////////////////////////////////////////
+template <typename ...Visitors>
+using FusedVisitor = BasicFusedVisitor<
+    typename visitor_details::ThunkArguments<
+        typename std::tuple_element<0, std::tuple<Visitors...>>::type::Thunk
+    >::Type,
+    Visitors...
+>;
+
+
+#include "FusedVisitor.inl"
+
+#endif //FUSED_VISITOR_HPP
@@ -0,0 +1,229 @@
+#ifndef FUSED_VISITOR_INL
+#define FUSED_VISITOR_INL
+
+#include "FusedVisitor.hpp"
+
+namespace visitor_details {
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Call a visitor of a fused visitor, returning FusedVoid instead of
+/// void.
+////////////////////////////////////////////////////////////////////////////////
+template <typename R>
+struct FusedCall
+{
+    //! Dispatch by the vtable of the visitor
+    template <typename Visitor, typename Visited, typename ...Args>
+    static R Visit(Visitor & visitor, Visited & visited, Args & ...args)
+    {
+        return visitor(visited, args...);
+    }
+
+    //! Call the visit method of the visitable directly
+    template <typename Visitor, typename Visitable, typename Base, typename ...Args>
+    static R Thunk(Visitor & visitor, Base & b, Args & ...args)
+    {
+        return Visitor::template thunk<
+            Visitor, Visitable, typename Visitor::visitor_invoker_details::InvokerType
+        >(visitor, b, args...);
+    }
+};
+
+template <>
+struct FusedCall<void>
+{
+    template <typename Visitor, typename Visited, typename ...Args>
+    static FusedVoid Visit(Visitor & visitor, Visited & visited, Args & ...args)
+    {
+        visitor(visited, args...);
+        return FusedVoid();
+    }
+
+    template <typename Visitor, typename Visitable, typename Base, typename ...Args>
+    static FusedVoid Thunk(Visitor & visitor, Base & b, Args & ...args)
+    {
+        Visitor::template thunk<
+            Visitor, Visitable, typename Visitor::visitor_invoker_details::InvokerType
+        >(visitor, b, args...);
+
+        return FusedVoid();
+    }
+};
+
+} // visitor_details
+
+
+template <typename ...Args, typename First, typename ...Others>
+inline BasicFusedVisitor<visitor_details::ArgumentList<Args...>, First, Others...>::BasicFusedVisitor(
+    First & first, Others & ...others
+):
+    m_visitors(first, others...), m_fused(nullptr)
+{
+    static_assert(
+        visitor_details::AllSame<BaseType, typename Others::BaseType...>::value,
+        "Fused visitors must visit the same hierarchy"
+    );
+    static_assert(
+        visitor_details::AllSame<
+            visitor_details::ArgumentList<Args...>,
+            typename visitor_details::ThunkArguments<typename Others::Thunk>::Type...
+        >::value,
+        "Fused visitors must have the same extra arguments"
+    );
+    static_assert(
+        visitor_details::AllSame<
+            std::false_type,
+            std::integral_constant<bool, std::is_rvalue_reference<Args>::value>...
+        >::value,
+        "The arguments of fused visitors are shared: they cannot be declared T &&"
+    );
+}
+
+template <typename ...Args, typename First, typename ...Others>
+inline typename BasicFusedVisitor<visitor_details::ArgumentList<Args...>, First, Others...>::RType
+BasicFusedVisitor<visitor_details::ArgumentList<Args...>, First, Others...>::operator()(
+    BaseType & b, Args ...args
+)
+{
+    return this->dispatch(visitor_details::GetDispatchTag(b), b, args...);
+}
+
+template <typename ...Args, typename First, typename ...Others>
+inline typename BasicFusedVisitor<visitor_details::ArgumentList<Args...>, First, Others...>::RType
+BasicFusedVisitor<visitor_details::ArgumentList<Args...>, First, Others...>::operator()(
+    VisitableHandle<BaseType> const & handle, Args ...args
+)
+{
+    return this->dispatch(handle.tag(), *handle, args...);
+}
+
+template <typename ...Args, typename First, typename ...Others>
+template <typename InputIt>
+inline void BasicFusedVisitor<visitor_details::ArgumentList<Args...>, First, Others...>::visitRange(
+    InputIt first, InputIt last, Args ...args
+)
+{
+    for(; first != last; ++first)
+    {
+        (*this)(visitor_details::ToVisited<BaseType>(*first), args...);
+    }
+}
+
+template <typename ...Args, typename First, typename ...Others>
+template <typename Collection>
+inline void BasicFusedVisitor<visitor_details::ArgumentList<Args...>, First, Others...>::visitCollection(
+    Collection & collection, Args ...args
+)
+{
+    for(std::size_t tag = 0; tag < collection.segmentCount(); ++tag)
+    {
+        auto * const segment = collection.segment(tag);
+
+        if(!segment || segment->size() == 0u) continue;
+
+        for(std::size_t i = 0; i < segment->size(); ++i)
+        {
+            this->dispatch(tag, segment->visitable(i), args...);
+        }
+    }
+}
+
+template <typename ...Args, typename First, typename ...Others>
+template <typename ...Visitables>
+inline void BasicFusedVisitor<visitor_details::ArgumentList<Args...>, First, Others...>::fuse()
+{
+    m_fused = &GetFusedVTable<Visitables...>();
+}
+
+template <typename ...Args, typename First, typename ...Others>
+inline void BasicFusedVisitor<visitor_details::ArgumentList<Args...>, First, Others...>::unfuse()
+{
+    m_fused = nullptr;
+}
+
+template <typename ...Args, typename First, typename ...Others>
+inline typename BasicFusedVisitor<visitor_details::ArgumentList<Args...>, First, Others...>::RType
+BasicFusedVisitor<visitor_details::ArgumentList<Args...>, First, Others...>::dispatch(
+    std::size_t tag, BaseType & b, Args ...args
+)
+{
+    // Fused visitable (the table is not resolved: no fallback to a fused ancestor)
+    if(m_fused && tag < m_fused->size())
+    {
+        if(Thunk const thunk = (*m_fused)[tag]) return thunk(*this, b, args...);
+    }
+
+    return this->dispatchEach(VisitorIndices(), VisitableHandle<BaseType>(&b, tag), args...);
+}
+
+template <typename ...Args, typename First, typename ...Others>
+template <std::size_t ...Indices>
+inline typename BasicFusedVisitor<visitor_details::ArgumentList<Args...>, First, Others...>::RType
+BasicFusedVisitor<visitor_details::ArgumentList<Args...>, First, Others...>::dispatchEach(
+    visitor_details::IndexSequence<Indices...>,
+    VisitableHandle<BaseType> const & handle, Args ...args
+)
+{
+    // Braced initialization: the visitors are called in order
+    return RType{
+        visitor_details::FusedCall<typename VisitorAt<Indices>::RType>::Visit(
+            std::get<Indices>(m_visitors), handle, args...
+        )...
+    };
+}
+
+template <typename ...Args, typename First, typename ...Others>
+template <typename Visitable>
+inline typename BasicFusedVisitor<visitor_details::ArgumentList<Args...>, First, Others...>::RType
+BasicFusedVisitor<visitor_details::ArgumentList<Args...>, First, Others...>::FusedThunk(
+    BasicFusedVisitor & fused, BaseType & b, Args ...args
+)
+{
+    return fused.template visitEach<Visitable>(VisitorIndices(), b, args...);
+}
+
+template <typename ...Args, typename First, typename ...Others>
+template <typename Visitable, std::size_t ...Indices>
+inline typename BasicFusedVisitor<visitor_details::ArgumentList<Args...>, First, Others...>::RType
+BasicFusedVisitor<visitor_details::ArgumentList<Args...>, First, Others...>::visitEach(
+    visitor_details::IndexSequence<Indices...>, BaseType & b, Args ...args
+)
+{
+    return RType{
+        visitor_details::FusedCall<typename VisitorAt<Indices>::RType>::template Thunk<
+            VisitorAt<Indices>, Visitable
+        >(std::get<Indices>(m_visitors), b, args...)...
+    };
+}
+
+template <typename ...Args, typename First, typename ...Others>
+template <typename ...Visitables>
+inline typename BasicFusedVisitor<visitor_details::ArgumentList<Args...>, First, Others...>::VTableType const &
+BasicFusedVisitor<visitor_details::ArgumentList<Args...>, First, Others...>::GetFusedVTable()
+{
+    struct FusedVTable
+    {
+        FusedVTable():
+            vtable(visitor_details::RegisterVisitableTags<BaseType, Visitables...>())
+        {
+            AddFusedThunks(vtable, visitor_details::ThunkTag<Visitables...>());
+        }
+
+        VTableType vtable;
+    };
+
+    static FusedVTable const s_table;
+    return s_table.vtable;
+}
+
+template <typename ...Args, typename First, typename ...Others>
+template <typename Head, typename ...Tail>
+inline void BasicFusedVisitor<visitor_details::ArgumentList<Args...>, First, Others...>::AddFusedThunks(
+    VTableType & vtable, visitor_details::ThunkTag<Head, Tail...>
+)
+{
+    vtable.template add<Head>(&BasicFusedVisitor::template FusedThunk<Head>);
+    AddFusedThunks(vtable, visitor_details::ThunkTag<Tail...>());
+}
+
+#endif //FUSED_VISITOR_INL
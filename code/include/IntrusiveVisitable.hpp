@@ -0,0 +1,89 @@
+#ifndef INTRUSIVE_VISITABLE_HPP
+#define INTRUSIVE_VISITABLE_HPP
+
+#include <atomic>
+#include <cstdint>
+
+#include "Visitable.hpp"
+
+namespace visitor_details {
+
+template <typename VisitableImpl>
+struct IntrusiveTagSetter;
+
+} // visitor_details
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Visitable base class storing the tag of the visitable in each object.
+///
+/// The visitors read the tag from the object instead of calling the virtual
+/// visitable_tag(): the dispatch is a field load, a table index and a call,
+/// which the compiler can inline up to the thunk.
+/// The visitable classes use the intrusive variants of the macros:
+/// \code
+///     class Shape : public IntrusiveVisitable<Shape>
+///     {
+///         public:
+///             META_IntrusiveBaseVisitable(Shape)
+///     };
+///
+///     class Circle : public Shape
+///     {
+///         public:
+///             META_IntrusiveVisitable(Circle, Shape)
+///     };
+/// \endcode
+///
+/// Memory overhead per object: the 4-byte tag, plus a 1-byte tag setter per
+/// class of the hierarchy (the setter of the most derived class is
+/// constructed last and writes the final tag). With the Itanium C++ ABI
+/// (GCC, Clang), the setters are placed in the tail padding of the base
+/// classes: with 8-byte alignment, the tag and up to 4 levels of setters fit
+/// in the 8 bytes following the vtable pointer.
+///
+/// A copy does not copy the tag (a sliced copy would keep the tag of the
+/// source): the tag of a copy is fetched once with the virtual
+/// visitable_tag() on its first visitation, then stored.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base>
+class IntrusiveVisitable:
+    public Visitable<Base>,
+    private visitor_details::IntrusiveVisitableMarker
+{
+    public:
+        using IntrusiveBaseType = Base;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the tag stored in the visitable.
+        ////////////////////////////////////////////////////////////////////////
+        std::size_t visitable_intrusive_tag() const;
+
+    protected:
+        IntrusiveVisitable();
+        IntrusiveVisitable(IntrusiveVisitable const &);
+        IntrusiveVisitable & operator=(IntrusiveVisitable const &);
+
+    private:
+        template <typename VisitableImpl>
+        friend struct visitor_details::IntrusiveTagSetter;
+
+        //! Tag of the visitable (0 until set, mutable to set it on const copies)
+        mutable std::atomic<std::uint32_t> m_visitableTag;
+};
+
+/// \brief Macro helper for the intrusive visitable classes (see
+/// META_Visitable): also declare the member setting the tag of the object
+/// during its construction.
+#define META_IntrusiveVisitable(VisitableImpl, VisitableFallback) \
+    _META_VISITABLE_(VisitableImpl, VisitableFallback, true) \
+    \
+    visitor_details::IntrusiveTagSetter<VisitableImpl> visitable_tag_setter{this};
+
+/// \brief Macro helper for the base class of an intrusive visitable hierarchy
+#define META_IntrusiveBaseVisitable(VisitableImpl) \
+    META_IntrusiveVisitable(VisitableImpl, VisitableImpl)
+
+
+#include "IntrusiveVisitable.inl"
+
+#endif //INTRUSIVE_VISITABLE_HPP
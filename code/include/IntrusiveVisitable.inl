@@ -0,0 +1,74 @@
+#ifndef INTRUSIVE_VISITABLE_INL
+#define INTRUSIVE_VISITABLE_INL
+
+#include "IntrusiveVisitable.hpp"
+
+namespace visitor_details {
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Member of every intrusive visitable class writing the tag of the
+/// class in the object under construction.
+////////////////////////////////////////////////////////////////////////////////
+template <typename VisitableImpl>
+struct IntrusiveTagSetter
+{
+    explicit IntrusiveTagSetter(VisitableImpl * visitable)
+    {
+        using Base = typename VisitableImpl::IntrusiveBaseType;
+
+        std::size_t const tag = GetVisitableTag<VisitableImpl, Base>();
+
+        visitable->m_visitableTag.store(
+            static_cast<std::uint32_t>(tag), std::memory_order_relaxed
+        );
+    }
+
+    // The tag of a copy is not set (see IntrusiveVisitable)
+    IntrusiveTagSetter(IntrusiveTagSetter const &) = default;
+    IntrusiveTagSetter & operator=(IntrusiveTagSetter const &) = default;
+};
+
+} // visitor_details
+
+
+template <typename Base>
+inline IntrusiveVisitable<Base>::IntrusiveVisitable():
+    m_visitableTag(0u)
+{
+
+}
+
+template <typename Base>
+inline IntrusiveVisitable<Base>::IntrusiveVisitable(IntrusiveVisitable const &):
+    m_visitableTag(0u)
+{
+
+}
+
+template <typename Base>
+inline IntrusiveVisitable<Base> &
+IntrusiveVisitable<Base>::operator=(IntrusiveVisitable const &)
+{
+    // Keep the tag: the dynamic type of an object does not change
+    return *this;
+}
+
+template <typename Base>
+inline std::size_t IntrusiveVisitable<Base>::visitable_intrusive_tag() const
+{
+    std::uint32_t tag = m_visitableTag.load(std::memory_order_relaxed);
+
+    // Copies fetch their tag on their first visitation
+    if(tag == 0u)
+    {
+        tag = static_cast<std::uint32_t>(
+            static_cast<Base const *>(this)->visitable_tag()
+        );
+
+        m_visitableTag.store(tag, std::memory_order_relaxed);
+    }
+
+    return tag;
+}
+
+#endif //INTRUSIVE_VISITABLE_INL
@@ -0,0 +1,168 @@
+#ifndef LAMBDA_VISITOR_HPP
+#define LAMBDA_VISITOR_HPP
+
+#include <type_traits>
+#include <utility>
+
+#include "Visitor.hpp"
+#include "VisitorDetails.hpp"
+
+namespace visitor_details {
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Overload set of lambdas: the visit method of a visitable is selected
+/// by overload resolution, as for the member visit methods.
+////////////////////////////////////////////////////////////////////////////////
+template <typename ...Lambdas>
+struct LambdaOverloads;
+
+template <typename Head, typename ...Tail>
+struct LambdaOverloads<Head, Tail...> : Head, LambdaOverloads<Tail...>
+{
+    LambdaOverloads(Head const & head, Tail const & ...tail):
+        Head(head), LambdaOverloads<Tail...>(tail...)
+    {
+
+    }
+
+    using Head::operator();
+    using LambdaOverloads<Tail...>::operator();
+};
+
+template <typename Head>
+struct LambdaOverloads<Head> : Head
+{
+    explicit LambdaOverloads(Head const & head):
+        Head(head)
+    {
+
+    }
+
+    using Head::operator();
+};
+
+//! Visitable handled by a lambda: the type of its first parameter
+template <typename Method>
+struct LambdaVisitableType;
+
+template <typename Lambda, typename R, typename Visited, typename ...Params>
+struct LambdaVisitableType<R (Lambda::*)(Visited, Params...) const>
+{
+    using Type = typename std::remove_const<
+        typename std::remove_reference<Visited>::type
+    >::type;
+};
+
+template <typename Lambda, typename R, typename Visited, typename ...Params>
+struct LambdaVisitableType<R (Lambda::*)(Visited, Params...)>:
+    LambdaVisitableType<R (Lambda::*)(Visited, Params...) const>
+{
+
+};
+
+template <typename Lambda>
+using LambdaVisitable =
+    typename LambdaVisitableType<decltype(&Lambda::operator())>::Type;
+
+//! Tell whether a function object can be called with the given parameters
+template <typename Function, typename ...Params>
+struct CallTest
+{
+    template <
+        typename F,
+        typename = decltype(std::declval<F &>()(std::declval<Params>()...))
+    >
+    static std::true_type Test(int);
+
+    template <typename F>
+    static std::false_type Test(...);
+};
+
+template <typename Function, typename ...Params>
+struct IsCallable:
+    decltype(CallTest<Function, Params...>::template Test<Function>(0))
+{
+
+};
+
+} // visitor_details
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Visitor whose visit methods are lambdas (see MakeVisitor).
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base, typename ReturnType, typename Arguments, typename ...Lambdas>
+class LambdaVisitor;
+
+template <typename Base, typename ReturnType, typename ...Args, typename ...Lambdas>
+class LambdaVisitor<Base, ReturnType, visitor_details::ArgumentList<Args...>, Lambdas...>:
+    public Visitor<Base, ReturnType, Args...>
+{
+    public:
+        //! Call the lambda selected by overload resolution
+        struct Invoker
+        {
+            template <typename VisitorImpl, typename VisitableImpl, typename ...Params>
+            static ReturnType Invoke(
+                VisitorImpl & visitor, VisitableImpl & visitable, Params && ...params
+            )
+            {
+                return visitor.invoke(visitable, std::forward<Params>(params)...);
+            }
+        };
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Constructor: copy the lambdas and set the vtable of the
+        /// visitables they handle.
+        ////////////////////////////////////////////////////////////////////////
+        explicit LambdaVisitor(Lambdas const & ...lambdas);
+
+    private:
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Call the lambda handling the visitable, or return
+        /// ReturnType() if there is none (the base class without a lambda).
+        ////////////////////////////////////////////////////////////////////////
+        template <typename VisitableImpl, typename ...Params>
+        ReturnType invoke(VisitableImpl & visitable, Params && ...params);
+
+        template <typename VisitableImpl, typename ...Params>
+        ReturnType invokeLambda(std::true_type /* handled */, VisitableImpl & visitable, Params && ...params);
+
+        template <typename VisitableImpl, typename ...Params>
+        ReturnType invokeLambda(std::false_type /* handled */, VisitableImpl & visitable, Params && ...params);
+
+    private:
+        visitor_details::LambdaOverloads<Lambdas...> m_lambdas; ///< Visit methods
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Create a visitor from lambdas, e.g. for an ad-hoc visitation:
+/// \code
+///     auto area = MakeVisitor<Shape, float>(
+///         [](Shape &) { return 0.f; },
+///         [](Circle & circle) { return pi * circle.radius * circle.radius; },
+///         [](Polygon & polygon) { return polygon.area(); }
+///     );
+///
+///     float a = area(shape);
+/// \endcode
+/// The visitables are the types of the first parameter of the lambdas, and a
+/// visitable is visited by the lambda selected by overload resolution (the
+/// nearest ancestor with a lambda). The base class gets ReturnType() when no
+/// lambda handles it. The extra arguments are given after ReturnType:
+/// MakeVisitor<Shape, void, float>([](Circle & circle, float scale) { ... }).
+///
+/// The vtable is static, built once per set of lambda types (like the vtables
+/// of META_Visitables), and the lambdas are stored in the visitor: nothing is
+/// allocated and the lambdas can be inlined in the thunks. The lambdas must be
+/// copyable and not generic.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base, typename ReturnType = void, typename ...Args, typename ...Lambdas>
+LambdaVisitor<Base, ReturnType, visitor_details::ArgumentList<Args...>, Lambdas...>
+MakeVisitor(Lambdas const & ...lambdas);
+
+
+#include "LambdaVisitor.inl"
+
+#endif //LAMBDA_VISITOR_HPP
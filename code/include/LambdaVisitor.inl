@@ -0,0 +1,60 @@
+#ifndef LAMBDA_VISITOR_INL
+#define LAMBDA_VISITOR_INL
+
+#include "LambdaVisitor.hpp"
+
+template <typename Base, typename ReturnType, typename ...Args, typename ...Lambdas>
+inline LambdaVisitor<Base, ReturnType, visitor_details::ArgumentList<Args...>, Lambdas...>::LambdaVisitor(
+    Lambdas const & ...lambdas
+):
+    m_lambdas(lambdas...)
+{
+    VisitorVTableSetter<
+        LambdaVisitor, Invoker, visitor_details::LambdaVisitable<Lambdas>...
+    >::SetVTable(*this);
+}
+
+template <typename Base, typename ReturnType, typename ...Args, typename ...Lambdas>
+template <typename VisitableImpl, typename ...Params>
+inline ReturnType
+LambdaVisitor<Base, ReturnType, visitor_details::ArgumentList<Args...>, Lambdas...>::invoke(
+    VisitableImpl & visitable, Params && ...params
+)
+{
+    using Handled = visitor_details::IsCallable<
+        visitor_details::LambdaOverloads<Lambdas...>, VisitableImpl &, Params &&...
+    >;
+
+    return this->invokeLambda(Handled(), visitable, std::forward<Params>(params)...);
+}
+
+template <typename Base, typename ReturnType, typename ...Args, typename ...Lambdas>
+template <typename VisitableImpl, typename ...Params>
+inline ReturnType
+LambdaVisitor<Base, ReturnType, visitor_details::ArgumentList<Args...>, Lambdas...>::invokeLambda(
+    std::true_type, VisitableImpl & visitable, Params && ...params
+)
+{
+    return m_lambdas(visitable, std::forward<Params>(params)...);
+}
+
+template <typename Base, typename ReturnType, typename ...Args, typename ...Lambdas>
+template <typename VisitableImpl, typename ...Params>
+inline ReturnType
+LambdaVisitor<Base, ReturnType, visitor_details::ArgumentList<Args...>, Lambdas...>::invokeLambda(
+    std::false_type, VisitableImpl &, Params && ...
+)
+{
+    return ReturnType();
+}
+
+template <typename Base, typename ReturnType, typename ...Args, typename ...Lambdas>
+inline LambdaVisitor<Base, ReturnType, visitor_details::ArgumentList<Args...>, Lambdas...>
+MakeVisitor(Lambdas const & ...lambdas)
+{
+    return LambdaVisitor<Base, ReturnType, visitor_details::ArgumentList<Args...>, Lambdas...>(
+        lambdas...
+    );
+}
+
+#endif //LAMBDA_VISITOR_INL
@@ -0,0 +1,325 @@
+#ifndef MEMOIZING_VISITOR_HPP
+#define MEMOIZING_VISITOR_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+
+#include "VisitableHandle.hpp"
+#include "Visitor.hpp"
+#include "VisitorDetails.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Base class of the visitables whose memoized visits are invalidated
+/// per object (see MemoizingVisitor).
+///
+/// Each object has an epoch, renewed by visitable_touch() when the object
+/// changes: the results memoized with a previous epoch are then ignored.
+/// The epochs of the new objects are drawn from a global counter, so an object
+/// allocated at the address of a destroyed one does not get its results.
+/// \code
+///     class Node : public Visitable<Node>, public MemoizedVisitable
+///     {
+///         public:
+///             META_BaseVisitable(Node)
+///
+///             void translate(Vector const & offset) { ...; this->visitable_touch(); }
+///     };
+/// \endcode
+////////////////////////////////////////////////////////////////////////////////
+class MemoizedVisitable
+{
+    public:
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Invalidate the memoized visits of the object.
+        ////////////////////////////////////////////////////////////////////////
+        void visitable_touch() const;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the epoch of the object.
+        ////////////////////////////////////////////////////////////////////////
+        std::uint32_t visitable_memo_epoch() const;
+
+    protected:
+        MemoizedVisitable();
+        MemoizedVisitable(MemoizedVisitable const &);
+        MemoizedVisitable & operator=(MemoizedVisitable const &);
+
+    private:
+        //! Draw the epoch of a new object
+        static std::uint32_t NextEpoch();
+
+    private:
+        //! Epoch of the object (mutable to touch const objects)
+        mutable std::atomic<std::uint32_t> m_memoEpoch;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Statistics of a MemoCache.
+////////////////////////////////////////////////////////////////////////////////
+struct MemoStats
+{
+    std::size_t hits = 0u;      ///< Results found
+    std::size_t misses = 0u;    ///< Results computed (absent or invalidated)
+    std::size_t evictions = 0u; ///< Valid results replaced by new ones
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Bounded cache of the results of visits, keyed by the visited object
+/// and the extra arguments.
+///
+/// The cache is set associative: an object is mapped to a set of Ways entries
+/// (the least recently used entry of the set is evicted), so its memory is
+/// fixed at construction. The sets are protected by a fixed number of locks,
+/// held to copy the results only, so the cache can be shared by the workers of
+/// a parallel visitation.
+/// An entry is valid while the global epoch of the cache (incremented by
+/// invalidateAll) and the epoch of its object (see MemoizedVisitable) are
+/// those it was stored with.
+/// \tparam Base Base class of the visitables.
+/// \tparam R    Type of the results (default constructible and copyable).
+/// \tparam Keys Extra arguments of the visits (equality comparable). The
+///              results of an object share a set: an object visited with more
+///              than Ways different arguments evicts its own results.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base, typename R, typename ...Keys>
+class MemoCache
+{
+    public:
+        static constexpr std::size_t Ways = 4u;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Constructor.
+        /// \param capacity Maximum number of results (rounded up to a power of
+        ///                 two, at least Ways).
+        ////////////////////////////////////////////////////////////////////////
+        explicit MemoCache(std::size_t capacity);
+
+        MemoCache(MemoCache const &) = delete;
+        MemoCache & operator=(MemoCache const &) = delete;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the global epoch of the cache, to read before
+        /// computing a result (see find and insert).
+        ////////////////////////////////////////////////////////////////////////
+        std::uint32_t generation() const;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Look a result up.
+        /// \param object     Visited object.
+        /// \param epoch      Epoch of the object.
+        /// \param generation Global epoch of the cache (see generation()).
+        /// \param value      Result, set if it is found.
+        /// \return True if a valid result was found.
+        ////////////////////////////////////////////////////////////////////////
+        bool find(
+            Base const * object, std::uint32_t epoch, std::uint32_t generation,
+            R & value, Keys const & ...keys
+        );
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Store a result (replacing the result of the same key, an
+        /// invalid entry or the least recently used entry of the set).
+        /// The result is dropped if the cache has been invalidated since the
+        /// given global epoch was read: it may be computed from the old data.
+        ////////////////////////////////////////////////////////////////////////
+        void insert(
+            Base const * object, std::uint32_t epoch, std::uint32_t generation,
+            R const & value, Keys const & ...keys
+        );
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Drop the results of an object (e.g. before destroying it).
+        ////////////////////////////////////////////////////////////////////////
+        void forget(Base const * object);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Invalidate every result (increment the global epoch).
+        ////////////////////////////////////////////////////////////////////////
+        void invalidateAll();
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the maximum number of results.
+        ////////////////////////////////////////////////////////////////////////
+        std::size_t capacity() const;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the statistics since the construction (or the last
+        /// resetStats).
+        ////////////////////////////////////////////////////////////////////////
+        MemoStats stats() const;
+
+        void resetStats();
+
+    private:
+        static constexpr std::size_t LockCount = 64u;
+
+        //! Memoized result
+        struct Entry
+        {
+            Base const * object = nullptr;  ///< Visited object (null if empty)
+            std::uint32_t epoch = 0u;       ///< Epoch of the object
+            std::uint32_t generation = 0u;  ///< Global epoch of the cache
+            std::uint64_t lastUse = 0u;     ///< Clock of the last use
+            std::tuple<Keys...> keys;       ///< Extra arguments
+            R value;                        ///< Result
+        };
+
+        //! Lock of a group of sets and their statistics, padded to avoid false
+        //! sharing
+        struct Lock
+        {
+            std::mutex mutex;
+            std::uint64_t clock = 0u;
+            MemoStats stats;
+            char padding[visitor_details::CacheLineSize];
+        };
+
+        //! Return the index of the set of an object
+        std::size_t setIndex(Base const * object) const;
+
+        //! Find the entry of a key in a set (or null)
+        Entry * findEntry(Entry * set, Base const * object, Keys const & ...keys);
+
+    private:
+        std::unique_ptr<Entry[]> m_entries;      ///< Sets of entries
+        std::unique_ptr<Lock[]> m_locks;         ///< Locks of the sets
+        std::size_t m_setMask;                   ///< Number of sets - 1
+        std::atomic<std::uint32_t> m_generation; ///< Global epoch
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Visitor memoizing the results of a pure visitor (see
+/// MemoizingVisitor).
+////////////////////////////////////////////////////////////////////////////////
+template <typename Arguments, typename VisitorImpl>
+class BasicMemoizingVisitor;
+
+template <typename ...Args, typename VisitorImpl>
+class BasicMemoizingVisitor<visitor_details::ArgumentList<Args...>, VisitorImpl>
+{
+    public:
+        using BaseType  = typename VisitorImpl::BaseType;
+        using RType     = typename VisitorImpl::RType;
+        using CacheType = MemoCache<BaseType, RType, typename std::decay<Args>::type...>;
+
+        static constexpr std::size_t DefaultCapacity = 1u << 16;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Constructor.
+        /// \param capacity Maximum number of memoized results.
+        /// \param visitor  Memoized visitor (copied).
+        ////////////////////////////////////////////////////////////////////////
+        explicit BasicMemoizingVisitor(
+            std::size_t capacity = DefaultCapacity,
+            VisitorImpl const & visitor = VisitorImpl()
+        );
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Constructor sharing a cache (e.g. between several visitors
+        /// with the same results).
+        ////////////////////////////////////////////////////////////////////////
+        BasicMemoizingVisitor(
+            std::shared_ptr<CacheType> cache,
+            VisitorImpl const & visitor = VisitorImpl()
+        );
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the memoized result of the visit, or visit the
+        /// visitable and memoize the result.
+        ////////////////////////////////////////////////////////////////////////
+        RType operator()(BaseType & b, Args ...args);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the memoized result of the visit of a handle (a miss
+        /// is dispatched on the tag of the handle).
+        ////////////////////////////////////////////////////////////////////////
+        RType operator()(VisitableHandle<BaseType> const & handle, Args ...args);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Visit a range of visitables (references, pointers or
+        /// handles).
+        ////////////////////////////////////////////////////////////////////////
+        template <typename InputIt>
+        void visitRange(InputIt first, InputIt last, Args ...args);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Visit a range of visitables and write the results.
+        /// \return The end of the output range.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename InputIt, typename OutputIt>
+        OutputIt transformRange(InputIt first, InputIt last, OutputIt out, Args ...args);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Invalidate every memoized result.
+        ////////////////////////////////////////////////////////////////////////
+        void invalidate();
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Drop the memoized results of a visitable.
+        ////////////////////////////////////////////////////////////////////////
+        void forget(BaseType const & b);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the statistics of the cache.
+        ////////////////////////////////////////////////////////////////////////
+        MemoStats stats() const;
+
+        VisitorImpl & visitor() { return m_visitor; }
+        CacheType & cache() { return *m_cache; }
+
+    private:
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the memoized result or visit the visited (a visitable
+        /// or a handle).
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Visited>
+        RType memoize(BaseType & b, Visited & visited, Args ...args);
+
+    private:
+        VisitorImpl m_visitor;              ///< Memoized visitor
+        std::shared_ptr<CacheType> m_cache; ///< Cache (shared by the copies)
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Visitor memoizing the results of a pure visitor: a visitor whose
+/// results only depend on the visited object and the extra arguments (e.g. the
+/// bounds or the cost of a subtree).
+///
+/// The results are stored in a bounded MemoCache, keyed by the address of the
+/// object and the extra arguments. They are invalidated all at once with
+/// invalidate(), or per object when the hierarchy derives from
+/// MemoizedVisitable (visitable_touch()).
+/// Without MemoizedVisitable, the key is only the address: an object created
+/// at the address of a destroyed one gets its results, unless they have been
+/// dropped with forget() or invalidate() when it was destroyed.
+/// \code
+///     MemoizingVisitor<BoundsVisitor> bounds(1u << 20);
+///
+///     Box box = bounds(group);  // Visited
+///     box = bounds(group);      // Memoized
+///     group.visitable_touch();
+///     box = bounds(group);      // Visited again
+/// \endcode
+/// The copies of a memoizing visitor copy the visitor and share the cache, so
+/// a memoizing visitor can be passed to ParallelVisit: the results computed by
+/// a worker are found by the others.
+/// The extra arguments are part of the key: they are compared with ==, and
+/// they cannot be declared T &&.
+////////////////////////////////////////////////////////////////////////////////
+template <typename VisitorImpl>
+using MemoizingVisitor = BasicMemoizingVisitor<
+    typename visitor_details::ThunkArguments<typename VisitorImpl::Thunk>::Type,
+    VisitorImpl
+>;
+
+
+#include "MemoizingVisitor.inl"
+
+#endif //MEMOIZING_VISITOR_HPP
@@ -0,0 +1,356 @@
+#ifndef MEMOIZING_VISITOR_INL
+#define MEMOIZING_VISITOR_INL
+
+#include "MemoizingVisitor.hpp"
+
+#include <cassert>
+
+/// MemoizedVisitable ///
+
+inline MemoizedVisitable::MemoizedVisitable():
+    m_memoEpoch(NextEpoch())
+{
+
+}
+
+inline MemoizedVisitable::MemoizedVisitable(MemoizedVisitable const &):
+    m_memoEpoch(NextEpoch())
+{
+
+}
+
+inline MemoizedVisitable & MemoizedVisitable::operator=(MemoizedVisitable const &)
+{
+    // The object changes: its results are invalidated
+    this->visitable_touch();
+    return *this;
+}
+
+inline void MemoizedVisitable::visitable_touch() const
+{
+    m_memoEpoch.store(NextEpoch(), std::memory_order_release);
+}
+
+inline std::uint32_t MemoizedVisitable::visitable_memo_epoch() const
+{
+    return m_memoEpoch.load(std::memory_order_acquire);
+}
+
+inline std::uint32_t MemoizedVisitable::NextEpoch()
+{
+    static std::atomic<std::uint32_t> s_epoch(0u);
+    return s_epoch.fetch_add(1u, std::memory_order_relaxed);
+}
+
+
+namespace visitor_details {
+
+//! Return the epoch of a visitable (0 if its results are not invalidated per
+//! object)
+template <typename Base>
+std::uint32_t GetMemoEpoch(Base const &, std::false_type /* memoized */)
+{
+    return 0u;
+}
+
+template <typename Base>
+std::uint32_t GetMemoEpoch(Base const & b, std::true_type /* memoized */)
+{
+    return static_cast<MemoizedVisitable const &>(b).visitable_memo_epoch();
+}
+
+template <typename Base>
+std::uint32_t GetMemoEpoch(Base const & b)
+{
+    return GetMemoEpoch(b, std::is_base_of<MemoizedVisitable, Base>());
+}
+
+} // visitor_details
+
+
+/// MemoCache ///
+
+template <typename Base, typename R, typename ...Keys>
+inline MemoCache<Base, R, Keys...>::MemoCache(std::size_t capacity):
+    m_locks(new Lock[LockCount]), m_setMask(0u), m_generation(1u)
+{
+    std::size_t sets = 1u;
+    while(sets * Ways < capacity) sets *= 2u;
+
+    m_entries.reset(new Entry[sets * Ways]);
+    m_setMask = sets - 1u;
+}
+
+template <typename Base, typename R, typename ...Keys>
+inline std::uint32_t MemoCache<Base, R, Keys...>::generation() const
+{
+    return m_generation.load(std::memory_order_acquire);
+}
+
+template <typename Base, typename R, typename ...Keys>
+inline bool MemoCache<Base, R, Keys...>::find(
+    Base const * object, std::uint32_t epoch, std::uint32_t generation,
+    R & value, Keys const & ...keys
+)
+{
+    std::size_t const set = this->setIndex(object);
+    Lock & lock = m_locks[set % LockCount];
+
+    std::lock_guard<std::mutex> guard(lock.mutex);
+
+    Entry * const entry = this->findEntry(&m_entries[set * Ways], object, keys...);
+
+    if(!entry || entry->epoch != epoch || entry->generation != generation)
+    {
+        ++lock.stats.misses;
+        return false;
+    }
+
+    ++lock.stats.hits;
+    entry->lastUse = ++lock.clock;
+    value = entry->value;
+
+    return true;
+}
+
+template <typename Base, typename R, typename ...Keys>
+inline void MemoCache<Base, R, Keys...>::insert(
+    Base const * object, std::uint32_t epoch, std::uint32_t generation,
+    R const & value, Keys const & ...keys
+)
+{
+    std::size_t const set = this->setIndex(object);
+    Lock & lock = m_locks[set % LockCount];
+
+    std::lock_guard<std::mutex> guard(lock.mutex);
+
+    // Invalidated during the computation of the result
+    if(generation != m_generation.load(std::memory_order_acquire)) return;
+
+    Entry * const entries = &m_entries[set * Ways];
+    Entry * entry = this->findEntry(entries, object, keys...);
+
+    if(!entry)
+    {
+        // Invalid entry, or least recently used one
+        entry = entries;
+
+        for(std::size_t way = 0; way < Ways; ++way)
+        {
+            if(!entries[way].object || entries[way].generation != generation)
+            {
+                entry = &entries[way];
+                break;
+            }
+
+            if(entries[way].lastUse < entry->lastUse) entry = &entries[way];
+        }
+
+        if(entry->object && entry->generation == generation) ++lock.stats.evictions;
+
+        entry->object = object;
+        entry->keys = std::tuple<Keys...>(keys...);
+    }
+
+    entry->epoch = epoch;
+    entry->generation = generation;
+    entry->lastUse = ++lock.clock;
+    entry->value = value;
+}
+
+template <typename Base, typename R, typename ...Keys>
+inline void MemoCache<Base, R, Keys...>::forget(Base const * object)
+{
+    std::size_t const set = this->setIndex(object);
+
+    std::lock_guard<std::mutex> guard(m_locks[set % LockCount].mutex);
+
+    Entry * const entries = &m_entries[set * Ways];
+
+    for(std::size_t way = 0; way < Ways; ++way)
+    {
+        if(entries[way].object == object) entries[way].object = nullptr;
+    }
+}
+
+template <typename Base, typename R, typename ...Keys>
+inline void MemoCache<Base, R, Keys...>::invalidateAll()
+{
+    // 0 is never a valid generation (zero-initialized entries)
+    if(m_generation.fetch_add(1u, std::memory_order_acq_rel) + 1u == 0u)
+    {
+        m_generation.fetch_add(1u, std::memory_order_acq_rel);
+    }
+}
+
+template <typename Base, typename R, typename ...Keys>
+inline std::size_t MemoCache<Base, R, Keys...>::capacity() const
+{
+    return (m_setMask + 1u) * Ways;
+}
+
+template <typename Base, typename R, typename ...Keys>
+inline MemoStats MemoCache<Base, R, Keys...>::stats() const
+{
+    MemoStats stats;
+
+    for(std::size_t i = 0; i < LockCount; ++i)
+    {
+        std::lock_guard<std::mutex> guard(m_locks[i].mutex);
+
+        stats.hits += m_locks[i].stats.hits;
+        stats.misses += m_locks[i].stats.misses;
+        stats.evictions += m_locks[i].stats.evictions;
+    }
+
+    return stats;
+}
+
+template <typename Base, typename R, typename ...Keys>
+inline void MemoCache<Base, R, Keys...>::resetStats()
+{
+    for(std::size_t i = 0; i < LockCount; ++i)
+    {
+        std::lock_guard<std::mutex> guard(m_locks[i].mutex);
+        m_locks[i].stats = MemoStats();
+    }
+}
+
+template <typename Base, typename R, typename ...Keys>
+inline std::size_t MemoCache<Base, R, Keys...>::setIndex(Base const * object) const
+{
+    // Fibonacci hashing of the address (the low bits are alignment)
+    std::uint64_t const address = reinterpret_cast<std::uintptr_t>(object) >> 3;
+
+    return static_cast<std::size_t>((address * 0x9E3779B97F4A7C15ull) >> 32) & m_setMask;
+}
+
+template <typename Base, typename R, typename ...Keys>
+inline typename MemoCache<Base, R, Keys...>::Entry *
+MemoCache<Base, R, Keys...>::findEntry(Entry * set, Base const * object, Keys const & ...keys)
+{
+    for(std::size_t way = 0; way < Ways; ++way)
+    {
+        if(set[way].object == object && set[way].keys == std::tie(keys...)) return &set[way];
+    }
+
+    return nullptr;
+}
+
+
+/// BasicMemoizingVisitor ///
+
+template <typename ...Args, typename VisitorImpl>
+inline BasicMemoizingVisitor<visitor_details::ArgumentList<Args...>, VisitorImpl>::BasicMemoizingVisitor(
+    std::size_t capacity, VisitorImpl const & visitor
+):
+    BasicMemoizingVisitor(std::make_shared<CacheType>(capacity), visitor)
+{
+
+}
+
+template <typename ...Args, typename VisitorImpl>
+inline BasicMemoizingVisitor<visitor_details::ArgumentList<Args...>, VisitorImpl>::BasicMemoizingVisitor(
+    std::shared_ptr<CacheType> cache, VisitorImpl const & visitor
+):
+    m_visitor(visitor), m_cache(std::move(cache))
+{
+    static_assert(!std::is_void<RType>::value, "Only the visitors returning a result can be memoized");
+    static_assert(
+        visitor_details::AllSame<
+            std::false_type,
+            std::integral_constant<bool, std::is_rvalue_reference<Args>::value>...
+        >::value,
+        "The arguments of memoized visits are kept: they cannot be declared T &&"
+    );
+
+    assert(m_cache && "No cache");
+}
+
+template <typename ...Args, typename VisitorImpl>
+inline typename BasicMemoizingVisitor<visitor_details::ArgumentList<Args...>, VisitorImpl>::RType
+BasicMemoizingVisitor<visitor_details::ArgumentList<Args...>, VisitorImpl>::operator()(
+    BaseType & b, Args ...args
+)
+{
+    return this->memoize(b, b, args...);
+}
+
+template <typename ...Args, typename VisitorImpl>
+inline typename BasicMemoizingVisitor<visitor_details::ArgumentList<Args...>, VisitorImpl>::RType
+BasicMemoizingVisitor<visitor_details::ArgumentList<Args...>, VisitorImpl>::operator()(
+    VisitableHandle<BaseType> const & handle, Args ...args
+)
+{
+    return this->memoize(*handle, handle, args...);
+}
+
+template <typename ...Args, typename VisitorImpl>
+template <typename InputIt>
+inline void BasicMemoizingVisitor<visitor_details::ArgumentList<Args...>, VisitorImpl>::visitRange(
+    InputIt first, InputIt last, Args ...args
+)
+{
+    for(; first != last; ++first)
+    {
+        (*this)(visitor_details::ToVisited<BaseType>(*first), args...);
+    }
+}
+
+template <typename ...Args, typename VisitorImpl>
+template <typename InputIt, typename OutputIt>
+inline OutputIt BasicMemoizingVisitor<visitor_details::ArgumentList<Args...>, VisitorImpl>::transformRange(
+    InputIt first, InputIt last, OutputIt out, Args ...args
+)
+{
+    for(; first != last; ++first, ++out)
+    {
+        *out = (*this)(visitor_details::ToVisited<BaseType>(*first), args...);
+    }
+
+    return out;
+}
+
+template <typename ...Args, typename VisitorImpl>
+inline void BasicMemoizingVisitor<visitor_details::ArgumentList<Args...>, VisitorImpl>::invalidate()
+{
+    m_cache->invalidateAll();
+}
+
+template <typename ...Args, typename VisitorImpl>
+inline void BasicMemoizingVisitor<visitor_details::ArgumentList<Args...>, VisitorImpl>::forget(
+    BaseType const & b
+)
+{
+    m_cache->forget(&b);
+}
+
+template <typename ...Args, typename VisitorImpl>
+inline MemoStats BasicMemoizingVisitor<visitor_details::ArgumentList<Args...>, VisitorImpl>::stats() const
+{
+    return m_cache->stats();
+}
+
+template <typename ...Args, typename VisitorImpl>
+template <typename Visited>
+inline typename BasicMemoizingVisitor<visitor_details::ArgumentList<Args...>, VisitorImpl>::RType
+BasicMemoizingVisitor<visitor_details::ArgumentList<Args...>, VisitorImpl>::memoize(
+    BaseType & b, Visited & visited, Args ...args
+)
+{
+    // Epochs read before the visit: a concurrent change of the object or
+    // invalidation of the cache invalidates the result
+    std::uint32_t const epoch = visitor_details::GetMemoEpoch(b);
+    std::uint32_t const generation = m_cache->generation();
+
+    RType value;
+
+    if(m_cache->find(&b, epoch, generation, value, args...)) return value;
+
+    value = m_visitor(visited, args...);
+    m_cache->insert(&b, epoch, generation, value, args...);
+
+    return value;
+}
+
+#endif //MEMOIZING_VISITOR_INL
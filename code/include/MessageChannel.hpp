@@ -0,0 +1,151 @@
+#ifndef MESSAGE_CHANNEL_HPP
+#define MESSAGE_CHANNEL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+#include "VisitableHandle.hpp"
+#include "VisitorDetails.hpp"
+
+namespace visitor_details {
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Slot of a MessageChannel: a message stored inline and the sequence
+/// number synchronizing its producer and the consumer. The slots are aligned
+/// on cache lines to avoid false sharing between the producers.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base, std::size_t MaxMessageSize>
+struct alignas(CacheLineSize) MessageSlot
+{
+    std::atomic<std::size_t> sequence; ///< Turn of the slot
+    Base * message;                    ///< Message (in the storage), null if empty
+    std::size_t tag;                   ///< Tag of the message
+    void (*destroy)(Base *);           ///< Destructor of the message
+
+    //! Storage of the message
+    typename std::aligned_storage<MaxMessageSize, alignof(std::max_align_t)>::type storage;
+};
+
+} // visitor_details
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Bounded channel of visitable messages with many producers and a
+/// single consumer, handled by a visitor.
+///
+/// The messages are stored inline in a ring of slots (no allocation per
+/// message) with their tag, so the consumer dispatches them without calling
+/// visitable_tag(). The ring is lock-free: a producer claims a slot with a
+/// compare-and-swap, and the sequence number of the slot publishes the message
+/// to the consumer and the slot back to the producers.
+/// \code
+///     MessageChannel<Message> channel(1024);
+///
+///     // Producer threads
+///     channel.emplace<Resize>(640, 480); // Wait for a free slot
+///
+///     // Consumer thread
+///     channel.drain(handler, 64u);       // Visit up to 64 messages
+/// \endcode
+/// The messages are visited in the order they were published, which is the
+/// order they were sent for each producer. A message type must be the exact
+/// dynamic type of its messages (its class must declare META_Visitable) and
+/// fit in MaxMessageSize bytes.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base, std::size_t MaxMessageSize = 96u>
+class MessageChannel
+{
+    public:
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Constructor.
+        /// \param capacity Number of slots (rounded up to a power of two).
+        ////////////////////////////////////////////////////////////////////////
+        explicit MessageChannel(std::size_t capacity);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Destructor: destroy the messages not visited.
+        ////////////////////////////////////////////////////////////////////////
+        ~MessageChannel();
+
+        MessageChannel(MessageChannel const &) = delete;
+        MessageChannel & operator=(MessageChannel const &) = delete;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Construct a message in the channel (any thread).
+        /// If the constructor throws, the exception is rethrown and the slot
+        /// claimed for the message is skipped by the consumer.
+        /// \return False if the channel is full.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Message, typename ...Params>
+        bool tryEmplace(Params && ...params);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Copy or move a message in the channel (any thread).
+        /// \return False if the channel is full.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Message>
+        bool tryPush(Message && message);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Construct a message in the channel, yielding while it is
+        /// full (any thread).
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Message, typename ...Params>
+        void emplace(Params && ...params);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Copy or move a message in the channel, yielding while it is
+        /// full (any thread).
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Message>
+        void push(Message && message);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Visit and destroy the pending messages (consumer thread only).
+        /// The messages are dispatched on a handle built from their stored tag.
+        /// \param visitor  Visitor handling the messages.
+        /// \param maxCount Maximum number of messages to visit.
+        /// \param params   Parameters passed to every visitation.
+        /// \return The number of messages visited (0 if the channel is empty).
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Visitor, typename ...Params>
+        std::size_t drain(Visitor & visitor, std::size_t maxCount, Params const & ...params);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the number of slots.
+        ////////////////////////////////////////////////////////////////////////
+        std::size_t capacity() const;
+
+    private:
+        using Slot = visitor_details::MessageSlot<Base, MaxMessageSize>;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Claim the slot of the next message.
+        /// \return Null if the channel is full.
+        ////////////////////////////////////////////////////////////////////////
+        Slot * claim(std::size_t & position);
+
+        //! Destroy a message of the given type
+        template <typename Message>
+        static void Destroy(Base * message);
+
+    private:
+        std::unique_ptr<unsigned char[]> m_storage; ///< Unaligned allocation
+        Slot * m_slots;                             ///< Ring of slots
+        std::size_t m_mask;                         ///< Capacity - 1
+
+        //! Padding to avoid false sharing with the producers
+        char m_padding0[visitor_details::CacheLineSize];
+
+        std::atomic<std::size_t> m_enqueue;         ///< Next position (producers)
+        char m_padding1[visitor_details::CacheLineSize];
+
+        std::size_t m_dequeue;                      ///< Next position (consumer)
+};
+
+
+#include "MessageChannel.inl"
+
+#endif //MESSAGE_CHANNEL_HPP
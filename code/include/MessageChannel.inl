@@ -0,0 +1,205 @@
+#ifndef MESSAGE_CHANNEL_INL
+#define MESSAGE_CHANNEL_INL
+
+#include "MessageChannel.hpp"
+
+#include <cassert>
+#include <new>
+#include <thread>
+#include <utility>
+
+template <typename Base, std::size_t MaxMessageSize>
+inline MessageChannel<Base, MaxMessageSize>::MessageChannel(std::size_t capacity):
+    m_slots(nullptr), m_mask(0u), m_enqueue(0u), m_dequeue(0u)
+{
+    std::size_t size = 2u;
+    while(size < capacity) size *= 2u;
+
+    m_mask = size - 1u;
+
+    // Slots aligned on cache lines (as the vtables)
+    std::size_t space = size * sizeof(Slot) + visitor_details::CacheLineSize;
+    m_storage.reset(new unsigned char[space]);
+
+    void * storage = m_storage.get();
+    m_slots = static_cast<Slot *>(std::align(
+        visitor_details::CacheLineSize, size * sizeof(Slot), storage, space
+    ));
+
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        Slot * const slot = new (m_slots + i) Slot;
+        slot->sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template <typename Base, std::size_t MaxMessageSize>
+inline MessageChannel<Base, MaxMessageSize>::~MessageChannel()
+{
+    // Destroy the pending messages
+    for(;;)
+    {
+        Slot & slot = m_slots[m_dequeue & m_mask];
+
+        if(slot.sequence.load(std::memory_order_acquire) != m_dequeue + 1u) break;
+
+        if(slot.message) slot.destroy(slot.message);
+        ++m_dequeue;
+    }
+
+    for(std::size_t i = 0; i <= m_mask; ++i) m_slots[i].~Slot();
+}
+
+template <typename Base, std::size_t MaxMessageSize>
+template <typename Message, typename ...Params>
+inline bool MessageChannel<Base, MaxMessageSize>::tryEmplace(Params && ...params)
+{
+    static_assert(std::is_base_of<Base, Message>::value, "Not a message of the channel");
+    static_assert(sizeof(Message) <= MaxMessageSize, "Message too large for the channel");
+    static_assert(
+        alignof(Message) <= alignof(std::max_align_t), "Message over-aligned"
+    );
+
+    std::size_t position;
+    Slot * const slot = this->claim(position);
+
+    if(!slot) return false;
+
+    Message * message;
+
+    try
+    {
+        message = new (&slot->storage) Message(std::forward<Params>(params)...);
+    }
+    catch(...)
+    {
+        // Publish an empty slot, skipped by the consumer: the position is
+        // claimed, and the next messages are only visited after it
+        slot->message = nullptr;
+        slot->sequence.store(position + 1u, std::memory_order_release);
+        throw;
+    }
+
+    slot->message = message;
+    slot->tag = visitor_details::GetVisitableTag<Message, Base>();
+    slot->destroy = &MessageChannel::template Destroy<Message>;
+
+    assert(slot->tag == visitor_details::GetDispatchTag(*slot->message)
+        && "The message class must declare META_Visitable");
+
+    // Publish the message to the consumer
+    slot->sequence.store(position + 1u, std::memory_order_release);
+
+    return true;
+}
+
+template <typename Base, std::size_t MaxMessageSize>
+template <typename Message>
+inline bool MessageChannel<Base, MaxMessageSize>::tryPush(Message && message)
+{
+    return this->tryEmplace<typename std::decay<Message>::type>(
+        std::forward<Message>(message)
+    );
+}
+
+template <typename Base, std::size_t MaxMessageSize>
+template <typename Message, typename ...Params>
+inline void MessageChannel<Base, MaxMessageSize>::emplace(Params && ...params)
+{
+    // The parameters are only consumed by a successful try
+    while(!this->tryEmplace<Message>(std::forward<Params>(params)...))
+    {
+        std::this_thread::yield();
+    }
+}
+
+template <typename Base, std::size_t MaxMessageSize>
+template <typename Message>
+inline void MessageChannel<Base, MaxMessageSize>::push(Message && message)
+{
+    this->emplace<typename std::decay<Message>::type>(std::forward<Message>(message));
+}
+
+template <typename Base, std::size_t MaxMessageSize>
+template <typename Visitor, typename ...Params>
+inline std::size_t MessageChannel<Base, MaxMessageSize>::drain(
+    Visitor & visitor, std::size_t maxCount, Params const & ...params
+)
+{
+    std::size_t count = 0u;
+
+    while(count < maxCount)
+    {
+        Slot & slot = m_slots[m_dequeue & m_mask];
+
+        // Stop at the first message not published yet
+        if(slot.sequence.load(std::memory_order_acquire) != m_dequeue + 1u) break;
+
+        // Skip the empty slots (message constructor which has thrown)
+        if(slot.message)
+        {
+            visitor(VisitableHandle<Base>(slot.message, slot.tag), params...);
+
+            slot.destroy(slot.message);
+            ++count;
+        }
+
+        // Give the slot back to the producers (for the next turn of the ring)
+        slot.sequence.store(m_dequeue + m_mask + 1u, std::memory_order_release);
+        ++m_dequeue;
+    }
+
+    return count;
+}
+
+template <typename Base, std::size_t MaxMessageSize>
+inline std::size_t MessageChannel<Base, MaxMessageSize>::capacity() const
+{
+    return m_mask + 1u;
+}
+
+template <typename Base, std::size_t MaxMessageSize>
+inline typename MessageChannel<Base, MaxMessageSize>::Slot *
+MessageChannel<Base, MaxMessageSize>::claim(std::size_t & position)
+{
+    position = m_enqueue.load(std::memory_order_relaxed);
+
+    for(;;)
+    {
+        Slot & slot = m_slots[position & m_mask];
+
+        std::size_t const sequence = slot.sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t const difference =
+            static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+        if(difference == 0)
+        {
+            // The slot is free for this turn: claim the position
+            if(m_enqueue.compare_exchange_weak(
+                position, position + 1u, std::memory_order_relaxed
+            ))
+            {
+                return &slot;
+            }
+        }
+        else if(difference < 0)
+        {
+            // The consumer has not released the slot yet: the channel is full
+            return nullptr;
+        }
+        else
+        {
+            // Another producer has claimed the position
+            position = m_enqueue.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename Base, std::size_t MaxMessageSize>
+template <typename Message>
+inline void MessageChannel<Base, MaxMessageSize>::Destroy(Base * message)
+{
+    static_cast<Message *>(message)->~Message();
+}
+
+#endif //MESSAGE_CHANNEL_INL
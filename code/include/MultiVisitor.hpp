@@ -0,0 +1,95 @@
+#ifndef MULTI_VISITOR_HPP
+#define MULTI_VISITOR_HPP
+
+#include "MultiVisitorDetails.hpp"
+#include "Visitor.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Visitor dispatching on the dynamic types of two visitables.
+///
+/// The visited pairs are given to META_Visitables as VisitablePair, and the
+/// visit methods take both visitables:
+/// \code
+///     class CollisionVisitor : public MultiVisitor<Shape, Shape, bool>
+///     {
+///         public:
+///             META_Visitor(CollisionVisitor, collide)
+///
+///             CollisionVisitor()
+///             {
+///                 // Pair of base classes could be omitted (added by default)
+///                 META_Visitables(
+///                     VisitablePair<Circle, Circle>,
+///                     VisitablePair<Circle, Polygon>
+///                 );
+///             }
+///
+///         protected:
+///             bool collide(Shape & a, Shape & b);
+///             bool collide(Circle & a, Circle & b);
+///             bool collide(Circle & a, Polygon & b);
+///     };
+/// \endcode
+///
+/// The nearest registered pair of every pair of visitables is resolved when
+/// the vtable is built, falling back along the second axis first: dispatching
+/// costs two tag reads, two loads of the (small) class maps and one table load.
+////////////////////////////////////////////////////////////////////////////////
+template <typename BaseA, typename BaseB, typename ReturnType = void, typename ...Args>
+class MultiVisitor
+{
+    public:
+        //! Type passing an extra argument through the dispatch (see
+        /// visitor_details::VisitorArgument)
+        template <typename T>
+        using ArgumentType = visitor_details::VisitorArgumentType<T>;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Perform the visitation of the given pair of visitables.
+        /// \param a First visitable to visit.
+        /// \param b Second visitable to visit.
+        /// \return The result of the visitation.
+        ////////////////////////////////////////////////////////////////////////
+        ReturnType operator()(BaseA & a, BaseB & b, ArgumentType<Args> ...args);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Call the right function from the vtable by using a thunk.
+        ////////////////////////////////////////////////////////////////////////
+        template <
+            typename VisitorImpl, typename VisitableA, typename VisitableB,
+            typename Invoker
+        >
+        static ReturnType thunk(
+            MultiVisitor & visitor, BaseA & a, BaseB & b, ArgumentType<Args> ...args
+        );
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the memory footprint of the vtable in bytes.
+        ////////////////////////////////////////////////////////////////////////
+        std::size_t vtableFootprint() const;
+
+    public:
+        using FirstBaseType  = BaseA;
+        using SecondBaseType = BaseB;
+        using Thunk          =
+            ReturnType (*)(MultiVisitor &, BaseA &, BaseB &, ArgumentType<Args>...);
+        using VTableType     =
+            visitor_details::MultiVisitorVTable<BaseA const, BaseB const, Thunk>;
+        using RType          = ReturnType;
+
+        //! Class used by META_Visitables to retrieve the vtable of a visitor
+        template <typename VisitorImpl, typename Invoker, typename ...VisitedPairs>
+        using VTableGetter =
+            visitor_details::GetMultiVisitorVTable<VisitorImpl, Invoker, VisitedPairs...>;
+
+    private:
+        template <typename VisitorImpl, typename Invoker, typename ...VisitedList>
+        friend struct VisitorVTableSetter;
+
+        VTableType const * m_vtable; ///< Vtable pointer
+};
+
+
+#include "MultiVisitor.inl"
+
+#endif //MULTI_VISITOR_HPP
@@ -0,0 +1,52 @@
+#ifndef MULTI_VISITOR_INL
+#define MULTI_VISITOR_INL
+
+#include "MultiVisitor.hpp"
+
+template <typename BaseA, typename BaseB, typename ReturnType, typename ...Args>
+inline ReturnType MultiVisitor<BaseA, BaseB, ReturnType, Args...>::operator()(
+    BaseA & a, BaseB & b, ArgumentType<Args> ...args
+)
+{
+    // Fetch the thunk of the pair (fallback is resolved in the vtable)
+    Thunk thunk = m_vtable->get(
+        visitor_details::GetDispatchTag(a), visitor_details::GetDispatchTag(b)
+    );
+
+    return thunk(*this, a, b, visitor_details::ForwardArgument<Args>(args)...);
+}
+
+template <typename BaseA, typename BaseB, typename ReturnType, typename ...Args>
+template <
+    typename VisitorImpl, typename VisitableA, typename VisitableB,
+    typename Invoker
+>
+inline ReturnType MultiVisitor<BaseA, BaseB, ReturnType, Args...>::thunk(
+    MultiVisitor & v, BaseA & a, BaseB & b, ArgumentType<Args> ...args
+)
+{
+    using VisitableTypeA =
+        typename visitor_details::GetVisitMethodArgumentType<VisitableA, BaseA>::Type;
+
+    using VisitableTypeB =
+        typename visitor_details::GetVisitMethodArgumentType<VisitableB, BaseB>::Type;
+
+    VisitorImpl & visitor = static_cast<VisitorImpl&>(v);
+
+    VisitableTypeA & visitableA = static_cast<VisitableTypeA &>(a);
+    VisitableTypeB & visitableB = static_cast<VisitableTypeB &>(b);
+
+    return Invoker::Invoke(
+        visitor, visitableA, visitableB,
+        visitor_details::ForwardArgument<Args>(args)...
+    );
+}
+
+template <typename BaseA, typename BaseB, typename ReturnType, typename ...Args>
+inline std::size_t
+MultiVisitor<BaseA, BaseB, ReturnType, Args...>::vtableFootprint() const
+{
+    return m_vtable->footprint();
+}
+
+#endif //MULTI_VISITOR_INL
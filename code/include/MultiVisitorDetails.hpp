@@ -0,0 +1,367 @@
+#ifndef MULTI_VISITOR_DETAILS_HPP
+#define MULTI_VISITOR_DETAILS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "VisitorDetails.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Pair of visitables visited together by a MultiVisitor.
+////////////////////////////////////////////////////////////////////////////////
+template <typename VisitableA, typename VisitableB>
+struct VisitablePair
+{
+    using First  = VisitableA;
+    using Second = VisitableB;
+};
+
+namespace visitor_details {
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Class representing the two-dimensional virtual table of a
+/// MultiVisitor.
+///
+/// Most cells of the table fall back to a few registered pairs, so the table is
+/// compressed: on each axis, the visitables which are not part of a registered
+/// pair share the class of their nearest ancestor which is. The table stores a
+/// function per pair of classes, and each tag is mapped to the offset of its
+/// class (row offset for the first axis, column for the second one).
+////////////////////////////////////////////////////////////////////////////////
+template <typename BaseA, typename BaseB, typename Func>
+class MultiVisitorVTable
+{
+    public:
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Constructor.
+        /// \param sizeA Number of tags of the first hierarchy.
+        /// \param sizeB Number of tags of the second hierarchy.
+        ////////////////////////////////////////////////////////////////////////
+        MultiVisitorVTable(std::size_t sizeA, std::size_t sizeB):
+            m_rows(sizeA, 0u), m_columns(sizeB, 0u)
+        {
+            for(std::size_t i = 0; i < LateTagCacheSize; ++i)
+            {
+                m_lateTagsA[i].store(0u, std::memory_order_relaxed);
+                m_lateTagsB[i].store(0u, std::memory_order_relaxed);
+            }
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Register the function handling the given pair of visitables.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename VisitableA, typename VisitableB>
+        void add(Func f)
+        {
+            std::size_t const tagA = GetVisitableTag<VisitableA, BaseA>();
+            std::size_t const tagB = GetVisitableTag<VisitableB, BaseB>();
+
+            m_pairs.push_back(Pair{tagA, tagB, f});
+
+            // Mark the tags owning a class (resolved in resolveFallbacks)
+            m_rows[tagA] = 1u;
+            m_columns[tagB] = 1u;
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Build the compressed table: every pair of classes holds the
+        /// function of the nearest registered pair, falling back along the
+        /// second axis first (the first visitable keeps its most derived
+        /// handler). Must be called once every function has been added (the
+        /// pair (BaseA, BaseB) must be registered).
+        ////////////////////////////////////////////////////////////////////////
+        void resolveFallbacks()
+        {
+            std::vector<std::size_t> parentClassesA;
+            std::vector<std::size_t> parentClassesB;
+
+            std::size_t const classesA =
+                MultiVisitorVTable::ResolveClasses<BaseA>(m_rows, parentClassesA);
+
+            std::size_t const classesB =
+                MultiVisitorVTable::ResolveClasses<BaseB>(m_columns, parentClassesB);
+
+            // Explicitly registered functions, indexed by class
+            std::vector<Func> registered(classesA * classesB, nullptr);
+
+            for(Pair const & pair : m_pairs)
+            {
+                registered[m_rows[pair.tagA] * classesB + m_columns[pair.tagB]] = pair.f;
+            }
+
+            // Fall back along the second axis (parent classes are lower than
+            // their children ones: a single pass suffices)
+            std::vector<Func> nearestB(registered);
+
+            for(std::size_t a = 0; a < classesA; ++a)
+            {
+                for(std::size_t b = 1; b < classesB; ++b)
+                {
+                    Func & f = nearestB[a * classesB + b];
+                    if(!f) f = nearestB[a * classesB + parentClassesB[b]];
+                }
+            }
+
+            // Then along the first axis
+            m_table.assign(nearestB.begin(), nearestB.end());
+
+            for(std::size_t a = 1; a < classesA; ++a)
+            {
+                for(std::size_t b = 0; b < classesB; ++b)
+                {
+                    Func & f = m_table[a * classesB + b];
+                    if(!f) f = m_table[parentClassesA[a] * classesB + b];
+                }
+            }
+
+            // Store the row offsets directly to save a multiplication
+            for(std::uint32_t & row : m_rows) row *= static_cast<std::uint32_t>(classesB);
+
+            m_pairs.clear();
+            m_pairs.shrink_to_fit();
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the function handling the pair of visitables with the
+        /// given tags.
+        ////////////////////////////////////////////////////////////////////////
+        Func get(std::size_t tagA, std::size_t tagB) const
+        {
+            if(tagA >= m_rows.size())
+            {
+                tagA = MultiVisitorVTable::ResolveUnknownTag<BaseA>(
+                    tagA, m_rows.size(), m_lateTagsA
+                );
+            }
+
+            if(tagB >= m_columns.size())
+            {
+                tagB = MultiVisitorVTable::ResolveUnknownTag<BaseB>(
+                    tagB, m_columns.size(), m_lateTagsB
+                );
+            }
+
+            return m_table[m_rows[tagA] + m_columns[tagB]];
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the memory footprint of the table in bytes.
+        ////////////////////////////////////////////////////////////////////////
+        std::size_t footprint() const
+        {
+            return sizeof(*this)
+                + m_table.capacity() * sizeof(Func)
+                + m_rows.capacity() * sizeof(std::uint32_t)
+                + m_columns.capacity() * sizeof(std::uint32_t);
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the footprint an uncompressed table would have.
+        ////////////////////////////////////////////////////////////////////////
+        std::size_t denseFootprint() const
+        {
+            return m_rows.size() * m_columns.size() * sizeof(Func);
+        }
+
+    private:
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Map every tag of an axis to a class.
+        /// \param classes       In: non-zero for the tags owning a class.
+        ///                      Out: class of every tag.
+        /// \param parentClasses Out: parent class of every class.
+        /// \return The number of classes.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Base>
+        static std::size_t ResolveClasses(
+            std::vector<std::uint32_t> & classes,
+            std::vector<std::size_t> & parentClasses
+        )
+        {
+            std::lock_guard<std::mutex> lock(HierarchyParentTable<Base>::GetMutex());
+
+            std::vector<std::size_t> const & parents =
+                HierarchyParentTable<Base>::Get();
+
+            std::size_t count = 0u;
+
+            // Parent tags are lower than children ones: a single pass suffices
+            for(std::size_t tag = 1; tag < classes.size(); ++tag)
+            {
+                std::size_t const parent = parents[tag];
+
+                if(classes[tag] != 0u)
+                {
+                    // The root owns the class 0 and is its own parent
+                    parentClasses.push_back(parent == tag ? 0u : classes[parent]);
+                    classes[tag] = static_cast<std::uint32_t>(count++);
+                }
+                else
+                {
+                    classes[tag] = classes[parent];
+                }
+            }
+
+            return count;
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Walk up the hierarchy from a visitable registered after the
+        /// table has been built until reaching a known tag.
+        /// The known tags are cached by tag (lock free, as in VisitorVTable),
+        /// so the hierarchy is only walked (under its lock) on a miss of the
+        /// cache of the axis.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Base>
+        static std::size_t ResolveUnknownTag(
+            std::size_t tag, std::size_t size, std::atomic<std::uint64_t> * lateTags
+        )
+        {
+            std::atomic<std::uint64_t> & cached = lateTags[tag % LateTagCacheSize];
+
+            // Entry: (tag << 32) | known tag, so a single load reads both
+            std::uint64_t const entry = cached.load(std::memory_order_relaxed);
+            if((entry >> 32) == tag) return static_cast<std::size_t>(entry & 0xFFFFFFFFu);
+
+            std::size_t known = tag;
+
+            {
+                std::lock_guard<std::mutex> lock(HierarchyParentTable<Base>::GetMutex());
+
+                std::vector<std::size_t> const & parents =
+                    HierarchyParentTable<Base>::Get();
+
+                while(known >= size) known = parents[known];
+            }
+
+            if(tag <= 0xFFFFFFFFu)
+            {
+                cached.store(
+                    static_cast<std::uint64_t>(tag) << 32 | known, std::memory_order_relaxed
+                );
+            }
+
+            return known;
+        }
+
+    private:
+        static constexpr std::size_t LateTagCacheSize = 16u;
+
+        //! Explicitly registered pair (only used while building the table)
+        struct Pair
+        {
+            std::size_t tagA;
+            std::size_t tagB;
+            Func f;
+        };
+
+        std::vector<Pair> m_pairs;            ///< Registered pairs
+        std::vector<Func> m_table;            ///< Functions per pair of classes
+        std::vector<std::uint32_t> m_rows;    ///< Row offset of every tag of A
+        std::vector<std::uint32_t> m_columns; ///< Column of every tag of B
+
+        //! Known tags of the visitables registered after the table has been built
+        mutable std::atomic<std::uint64_t> m_lateTagsA[LateTagCacheSize];
+        mutable std::atomic<std::uint64_t> m_lateTagsB[LateTagCacheSize];
+};
+
+
+template <typename Visitor, typename Invoker, typename ...VisitedPairs>
+struct GetMultiVisitorVTable;
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Class used to generate a vtable for the triplet
+/// (Visitor, Invoker, VisitedPairs...).
+////////////////////////////////////////////////////////////////////////////////
+template <typename Visitor, typename Invoker, typename ...VisitedPairs>
+class MultiVisitorVTableCreator
+{
+    private:
+        using BaseA = typename Visitor::FirstBaseType;
+        using BaseB = typename Visitor::SecondBaseType;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Constructor.
+        ////////////////////////////////////////////////////////////////////////
+        MultiVisitorVTableCreator():
+            m_vtable(
+                RegisterVisitableTags<BaseA, typename VisitedPairs::First...>(),
+                RegisterVisitableTags<BaseB, typename VisitedPairs::Second...>()
+            )
+        {
+            // Add (BaseA, BaseB)'s visit function to the vtable first
+            this->addThunk<VisitablePair<BaseA, BaseB>>();
+
+            // Add visit function for each pair in VisitedPairs in the vtable
+            this->addThunks(ThunkTag<VisitedPairs...>());
+
+            // Resolve the nearest ancestors of every other pair ahead of time
+            m_vtable.resolveFallbacks();
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Add a thunk to the vtable.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Pair>
+        void addThunk()
+        {
+            using First  = typename Pair::First;
+            using Second = typename Pair::Second;
+
+            m_vtable.template add<First, Second>(
+                &Visitor::template thunk<Visitor, First, Second, Invoker>
+            );
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Add thunks to the vtable.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Head, typename ...Tail>
+        void addThunks(ThunkTag<Head, Tail...>)
+        {
+            this->addThunk<Head>();
+            this->addThunks(ThunkTag<Tail...>());
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Add thunks to the vtable (break the variadic recursion).
+        ////////////////////////////////////////////////////////////////////////
+        void addThunks(ThunkTag<>) { }
+
+    private:
+        friend struct GetMultiVisitorVTable<Visitor, Invoker, VisitedPairs...>;
+
+        typename Visitor::VTableType m_vtable; ///< Virtual table
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Class used to retrieved the vtable created by a
+/// MultiVisitorVTableCreator.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Visitor, typename Invoker, typename ...VisitedPairs>
+struct GetMultiVisitorVTable
+{
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Return the static instance of vtable (built on first use).
+    ////////////////////////////////////////////////////////////////////////////
+    static MultiVisitorVTableCreator<Visitor, Invoker, VisitedPairs...> const & GetTable()
+    {
+        static MultiVisitorVTableCreator<Visitor, Invoker, VisitedPairs...> const s_table;
+        return s_table;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Return the vtable.
+    ////////////////////////////////////////////////////////////////////////////
+    operator typename Visitor::VTableType const *() const
+    {
+        return &GetTable().m_vtable;
+    }
+};
+
+} // visitor_details
+
+
+#endif //MULTI_VISITOR_DETAILS_HPP
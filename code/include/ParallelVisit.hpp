@@ -0,0 +1,130 @@
+#ifndef PARALLEL_VISIT_HPP
+#define PARALLEL_VISIT_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "VisitorDetails.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Pool of threads used by the parallel visitations.
+///
+/// The calling thread takes part in every job, so a pool of N workers owns
+/// N - 1 threads. A pool is meant to be reused (e.g. every frame).
+////////////////////////////////////////////////////////////////////////////////
+class VisitThreadPool
+{
+    public:
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Constructor.
+        /// \param workerCount Number of workers (calling thread included),
+        ///                    0 to use the number of hardware threads.
+        ////////////////////////////////////////////////////////////////////////
+        explicit VisitThreadPool(std::size_t workerCount = 0u);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Destructor: join the threads.
+        ////////////////////////////////////////////////////////////////////////
+        ~VisitThreadPool();
+
+        VisitThreadPool(VisitThreadPool const &) = delete;
+        VisitThreadPool & operator=(VisitThreadPool const &) = delete;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the number of workers (calling thread included).
+        ////////////////////////////////////////////////////////////////////////
+        std::size_t size() const;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Run the job on every worker and wait for its completion.
+        /// If the job throws on some workers, the other workers still run it:
+        /// once they are all done, the first exception is rethrown.
+        /// \param job Function called with the index of the worker (the
+        ///            calling thread is the worker 0).
+        ////////////////////////////////////////////////////////////////////////
+        void run(std::function<void (std::size_t)> const & job);
+
+    private:
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Loop of the threads of the pool.
+        ////////////////////////////////////////////////////////////////////////
+        void work(std::size_t worker);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Record an exception of the job (only the first one is kept).
+        ////////////////////////////////////////////////////////////////////////
+        void fail(std::exception_ptr exception);
+
+    private:
+        std::vector<std::thread> m_threads;  ///< Threads of the pool
+
+        std::mutex m_runMutex;               ///< Serialize the jobs
+        std::mutex m_mutex;                  ///< Protect the job state
+        std::condition_variable m_wakeUp;    ///< Signal a new job
+        std::condition_variable m_done;      ///< Signal the end of a job
+
+        std::function<void (std::size_t)> const * m_job; ///< Current job
+        std::size_t m_generation;            ///< Number of jobs started
+        std::size_t m_pending;               ///< Threads running the job
+        std::exception_ptr m_exception;      ///< First exception of the job
+        bool m_stop;                         ///< Stop the threads
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Visit a range of visitables on every worker of a pool.
+///
+/// The range is split into chunks scheduled by work stealing. Each worker
+/// gets its own visitor, so visitors with a state stay race-free (the static
+/// vtables are shared read-only). The visitor is either a copyable visitor
+/// (copied for each worker) or a factory returning a visitor.
+/// The parameters are copied once per worker and passed to every visitation:
+/// the visit methods must not consume them.
+/// If a visitation throws, its worker stops and the first exception is
+/// rethrown once the other workers have visited the rest of the range.
+/// \param pool    Pool of workers.
+/// \param visitor Visitor or visitor factory.
+/// \param first   Beginning of the range (references, pointers or handles).
+/// \param last    End of the range.
+////////////////////////////////////////////////////////////////////////////////
+template <typename VisitorOrFactory, typename RandomIt, typename ...Params>
+void ParallelVisit(
+    VisitThreadPool & pool,
+    VisitorOrFactory const & visitor,
+    RandomIt first, RandomIt last,
+    Params const & ...params
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Visit a range of visitables on every worker of a pool and reduce the
+/// results (see ParallelVisit).
+/// Each worker reduces its results starting from init, then the per-worker
+/// results are reduced starting from init: the reduction must be associative
+/// and commutative, and init must be its identity.
+/// \param init   Identity of the reduction.
+/// \param reduce Reduction: T reduce(T, T) (the results of the visitations
+///               are converted to T)
+/// \return The reduction of the results.
+////////////////////////////////////////////////////////////////////////////////
+template <
+    typename VisitorOrFactory, typename RandomIt,
+    typename T, typename Reduce, typename ...Params
+>
+T ParallelReduce(
+    VisitThreadPool & pool,
+    VisitorOrFactory const & visitor,
+    RandomIt first, RandomIt last,
+    T init, Reduce reduce,
+    Params const & ...params
+);
+
+
+#include "ParallelVisit.inl"
+
+#endif //PARALLEL_VISIT_HPP
@@ -0,0 +1,405 @@
+#ifndef PARALLEL_VISIT_INL
+#define PARALLEL_VISIT_INL
+
+#include "ParallelVisit.hpp"
+
+#include <algorithm>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/// VisitThreadPool ///
+
+inline VisitThreadPool::VisitThreadPool(std::size_t workerCount):
+    m_job(nullptr), m_generation(0u), m_pending(0u), m_stop(false)
+{
+    if(workerCount == 0u)
+    {
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // The calling thread is the worker 0
+    for(std::size_t worker = 1; worker < workerCount; ++worker)
+    {
+        m_threads.emplace_back(&VisitThreadPool::work, this, worker);
+    }
+}
+
+inline VisitThreadPool::~VisitThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_wakeUp.notify_all();
+
+    for(std::thread & thread : m_threads) thread.join();
+}
+
+inline std::size_t VisitThreadPool::size() const
+{
+    return m_threads.size() + 1u;
+}
+
+inline void VisitThreadPool::run(std::function<void (std::size_t)> const & job)
+{
+    std::lock_guard<std::mutex> runLock(m_runMutex);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &job;
+        m_pending = m_threads.size();
+        ++m_generation;
+    }
+
+    m_wakeUp.notify_all();
+
+    // The job must outlive the workers running it: wait for them even if it
+    // throws on the calling thread
+    try
+    {
+        job(0u);
+    }
+    catch(...)
+    {
+        this->fail(std::current_exception());
+    }
+
+    std::exception_ptr exception;
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this]() { return m_pending == 0u; });
+        m_job = nullptr;
+
+        std::swap(exception, m_exception);
+    }
+
+    if(exception) std::rethrow_exception(exception);
+}
+
+inline void VisitThreadPool::fail(std::exception_ptr exception)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if(!m_exception) m_exception = exception;
+}
+
+inline void VisitThreadPool::work(std::size_t worker)
+{
+    std::size_t generation = 0u;
+
+    for(;;)
+    {
+        std::function<void (std::size_t)> const * job = nullptr;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeUp.wait(lock, [&]() { return m_stop || m_generation != generation; });
+
+            if(m_stop) return;
+
+            generation = m_generation;
+            job = m_job;
+        }
+
+        try
+        {
+            (*job)(worker);
+        }
+        catch(...)
+        {
+            this->fail(std::current_exception());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_pending;
+        }
+
+        m_done.notify_one();
+    }
+}
+
+
+namespace visitor_details {
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Ranges of indices scheduled by work stealing.
+///
+/// Each worker starts with a contiguous part of the indices and takes chunks
+/// from its beginning. An idle worker steals the upper half of the range of
+/// another worker. Every range has its own lock, so the locks are only
+/// contended while stealing.
+////////////////////////////////////////////////////////////////////////////////
+class WorkStealingRanges
+{
+    public:
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Constructor.
+        /// \param count   Number of indices.
+        /// \param workers Number of workers.
+        ////////////////////////////////////////////////////////////////////////
+        WorkStealingRanges(std::size_t count, std::size_t workers):
+            m_ranges(new Range[workers]),
+            m_workers(workers),
+            m_grain(count / (workers * ChunksPerWorker))
+        {
+            if(m_grain < MinGrain) m_grain = MinGrain;
+
+            for(std::size_t worker = 0; worker < workers; ++worker)
+            {
+                m_ranges[worker].begin = count * worker / workers;
+                m_ranges[worker].end = count * (worker + 1) / workers;
+            }
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Take the next chunk of the worker, stealing it if needed.
+        /// \return False once every index has been taken.
+        ////////////////////////////////////////////////////////////////////////
+        bool next(std::size_t worker, std::size_t & begin, std::size_t & end)
+        {
+            if(this->take(m_ranges[worker], begin, end)) return true;
+
+            for(std::size_t i = 1; i < m_workers; ++i)
+            {
+                Range & victim = m_ranges[(worker + i) % m_workers];
+
+                std::size_t stolenBegin, stolenEnd;
+
+                {
+                    std::lock_guard<std::mutex> lock(victim.mutex);
+
+                    if(victim.begin == victim.end) continue;
+
+                    // Steal the upper half (or what is left of the last chunk)
+                    stolenBegin = victim.end - victim.begin > m_grain ?
+                        victim.begin + (victim.end - victim.begin) / 2 : victim.begin;
+                    stolenEnd = victim.end;
+                    victim.end = stolenBegin;
+                }
+
+                Range & own = m_ranges[worker];
+
+                {
+                    std::lock_guard<std::mutex> lock(own.mutex);
+                    own.begin = stolenBegin;
+                    own.end = stolenEnd;
+                }
+
+                if(this->take(own, begin, end)) return true;
+            }
+
+            return false;
+        }
+
+    private:
+        static constexpr std::size_t MinGrain = 256u;
+        static constexpr std::size_t ChunksPerWorker = 32u;
+
+        //! Range of a worker, padded to avoid false sharing
+        struct Range
+        {
+            std::mutex mutex;
+            std::size_t begin;
+            std::size_t end;
+            char padding[CacheLineSize];
+        };
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Take a chunk from the beginning of a range.
+        ////////////////////////////////////////////////////////////////////////
+        bool take(Range & range, std::size_t & begin, std::size_t & end)
+        {
+            std::lock_guard<std::mutex> lock(range.mutex);
+
+            if(range.begin == range.end) return false;
+
+            begin = range.begin;
+            end = std::min(range.end, range.begin + m_grain);
+            range.begin = end;
+
+            return true;
+        }
+
+    private:
+        std::unique_ptr<Range[]> m_ranges; ///< Range of each worker
+        std::size_t m_workers;             ///< Number of workers
+        std::size_t m_grain;               ///< Size of the chunks
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Tell whether the type is a visitor factory (callable without
+/// argument) or a visitor.
+////////////////////////////////////////////////////////////////////////////////
+template <typename VisitorOrFactory>
+struct IsVisitorFactory
+{
+    private:
+        template <typename F>
+        static std::true_type Test(decltype(std::declval<F const &>()()) *);
+
+        template <typename F>
+        static std::false_type Test(...);
+
+    public:
+        static constexpr bool value =
+            decltype(Test<VisitorOrFactory>(nullptr))::value;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Create the visitor of a worker: copy the visitor or call the factory.
+////////////////////////////////////////////////////////////////////////////////
+template <typename VisitorOrFactory, bool Factory = IsVisitorFactory<VisitorOrFactory>::value>
+struct WorkerVisitor
+{
+    using Type = VisitorOrFactory;
+
+    static Type Make(VisitorOrFactory const & visitor) { return visitor; }
+};
+
+template <typename VisitorOrFactory>
+struct WorkerVisitor<VisitorOrFactory, true>
+{
+    using Type = typename std::decay<
+        decltype(std::declval<VisitorOrFactory const &>()())
+    >::type;
+
+    static Type Make(VisitorOrFactory const & factory) { return factory(); }
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Copy of the parameters of a visitation, passed to every visitation
+/// of a worker.
+////////////////////////////////////////////////////////////////////////////////
+template <typename ...Params>
+class VisitParameters
+{
+    public:
+        explicit VisitParameters(Params const & ...params):
+            m_params(params...)
+        {
+
+        }
+
+        //! Visit a visitable or a handle
+        template <typename Visitor, typename Visited>
+        typename Visitor::RType visit(Visitor & visitor, Visited & visited)
+        {
+            return this->visit(
+                visitor, visited, typename MakeIndexSequence<sizeof...(Params)>::Type()
+            );
+        }
+
+    private:
+        template <typename Visitor, typename Visited, std::size_t ...Indices>
+        typename Visitor::RType visit(
+            Visitor & visitor, Visited & visited, IndexSequence<Indices...>
+        )
+        {
+            return visitor(
+                visited, static_cast<typename std::decay<Params const &>::type &&>(
+                    std::get<Indices>(m_params)
+                )...
+            );
+        }
+
+    private:
+        std::tuple<typename std::decay<Params const &>::type...> m_params; ///< Parameters
+};
+
+} // visitor_details
+
+
+template <typename VisitorOrFactory, typename RandomIt, typename ...Params>
+void ParallelVisit(
+    VisitThreadPool & pool,
+    VisitorOrFactory const & visitor,
+    RandomIt first, RandomIt last,
+    Params const & ...params
+)
+{
+    using WorkerVisitor = visitor_details::WorkerVisitor<VisitorOrFactory>;
+    using Base = typename WorkerVisitor::Type::BaseType;
+
+    visitor_details::WorkStealingRanges ranges(last - first, pool.size());
+
+    pool.run([&](std::size_t worker)
+    {
+        typename WorkerVisitor::Type workerVisitor = WorkerVisitor::Make(visitor);
+
+        // Per-worker copy of the parameters, passed to every visitation
+        visitor_details::VisitParameters<Params...> parameters(params...);
+
+        std::size_t begin, end;
+        while(ranges.next(worker, begin, end))
+        {
+            for(std::size_t i = begin; i < end; ++i)
+            {
+                parameters.visit(
+                    workerVisitor, visitor_details::ToVisited<Base>(first[i])
+                );
+            }
+        }
+    });
+}
+
+template <
+    typename VisitorOrFactory, typename RandomIt,
+    typename T, typename Reduce, typename ...Params
+>
+T ParallelReduce(
+    VisitThreadPool & pool,
+    VisitorOrFactory const & visitor,
+    RandomIt first, RandomIt last,
+    T init, Reduce reduce,
+    Params const & ...params
+)
+{
+    using WorkerVisitor = visitor_details::WorkerVisitor<VisitorOrFactory>;
+    using Base = typename WorkerVisitor::Type::BaseType;
+
+    visitor_details::WorkStealingRanges ranges(last - first, pool.size());
+
+    // Wrapped to avoid the bit-packed std::vector<bool> (written concurrently)
+    struct WorkerResult { T value; };
+    std::vector<WorkerResult> results(pool.size(), WorkerResult{init});
+
+    pool.run([&](std::size_t worker)
+    {
+        typename WorkerVisitor::Type workerVisitor = WorkerVisitor::Make(visitor);
+
+        // Per-worker copy of the parameters, passed to every visitation
+        visitor_details::VisitParameters<Params...> parameters(params...);
+
+        // Reduce in a local to avoid false sharing between the workers
+        T result = init;
+
+        std::size_t begin, end;
+        while(ranges.next(worker, begin, end))
+        {
+            for(std::size_t i = begin; i < end; ++i)
+            {
+                result = reduce(result, parameters.visit(
+                    workerVisitor, visitor_details::ToVisited<Base>(first[i])
+                ));
+            }
+        }
+
+        results[worker].value = result;
+    });
+
+    T result = init;
+    for(WorkerResult const & workerResult : results)
+    {
+        result = reduce(result, workerResult.value);
+    }
+
+    return result;
+}
+
+#endif //PARALLEL_VISIT_INL
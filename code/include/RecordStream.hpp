@@ -0,0 +1,248 @@
+#ifndef RECORD_STREAM_HPP
+#define RECORD_STREAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "VisitorDetails.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Header of a record of a record stream.
+///
+/// A record stream is a sequence of records: a header followed by the payload
+/// of the record, padded to a multiple of RecordAlignment bytes. The tag is the
+/// stable tag of the visitable recorded (see META_StableTag), so the stream
+/// can be read by another process.
+////////////////////////////////////////////////////////////////////////////////
+struct RecordHeader
+{
+    std::uint64_t tag;      ///< Stable tag of the visitable
+    std::uint32_t size;     ///< Size of the payload in bytes
+    std::uint32_t reserved; ///< Unused (0)
+};
+
+//! Alignment of the records (and of their payload)
+static constexpr std::size_t RecordAlignment = 8u;
+
+static_assert(sizeof(RecordHeader) % RecordAlignment == 0u, "Unaligned header");
+
+
+namespace visitor_details {
+
+//! Record type of a visitable (see META_VisitableRecord), void if none
+template <typename Visitable>
+struct GetVisitableRecordType
+{
+    private:
+        template <typename V>
+        static typename V::VisitableRecordType * Test(typename V::VisitableRecordType *);
+
+        template <typename V>
+        static void * Test(...);
+
+    public:
+        using Type = typename std::remove_pointer<
+            decltype(Test<Visitable>(nullptr))
+        >::type;
+};
+
+//! Minimum payload size of the records of a visitable (0 without record type)
+template <typename Visitable, typename RecordType =
+    typename GetVisitableRecordType<Visitable>::Type>
+struct GetVisitableRecordSize : std::integral_constant<std::size_t, sizeof(RecordType)>
+{
+
+};
+
+template <typename Visitable>
+struct GetVisitableRecordSize<Visitable, void> : std::integral_constant<std::size_t, 0u>
+{
+
+};
+
+} // visitor_details
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Typed view of a record, passed to the visit methods of a
+/// RecordVisitor: the payload is read in place, without any copy.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Visitable>
+class RecordView
+{
+    public:
+        //! Payload type (see META_VisitableRecord)
+        using RecordType =
+            typename visitor_details::GetVisitableRecordType<Visitable>::Type;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Constructor.
+        /// \param header Header of the record (followed by its payload).
+        ////////////////////////////////////////////////////////////////////////
+        explicit RecordView(RecordHeader const & header);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the payload. The RecordVisitor only passes the records
+        /// large enough for their record type, except to the visit method of
+        /// the base class, which must check the size of the records.
+        ////////////////////////////////////////////////////////////////////////
+        RecordType const * get() const;
+
+        RecordType const & operator*() const { return *this->get(); }
+        RecordType const * operator->() const { return this->get(); }
+
+        //! Raw payload
+        unsigned char const * data() const;
+
+        //! Size of the payload in bytes
+        std::size_t size() const { return m_header->size; }
+
+        //! Stable tag of the record
+        std::uint64_t tag() const { return m_header->tag; }
+
+    private:
+        RecordHeader const * m_header; ///< Header of the record
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Non-owning view of a record stream in memory (e.g. a mapped file).
+/// The iteration stops at the first truncated record.
+////////////////////////////////////////////////////////////////////////////////
+class RecordStream
+{
+    public:
+        //! Forward iterator over the headers of the records
+        class Iterator
+        {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type        = RecordHeader;
+                using difference_type   = std::ptrdiff_t;
+                using pointer           = RecordHeader const *;
+                using reference         = RecordHeader const &;
+
+                Iterator(unsigned char const * current, unsigned char const * end);
+
+                reference operator*() const;
+                pointer operator->() const { return &**this; }
+
+                Iterator & operator++();
+                Iterator operator++(int);
+
+                bool operator==(Iterator const & other) const;
+                bool operator!=(Iterator const & other) const { return !(*this == other); }
+
+            private:
+                unsigned char const * m_current; ///< Current record
+                unsigned char const * m_end;     ///< End of the stream
+        };
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Constructor.
+        /// \param data Beginning of the stream (aligned on RecordAlignment).
+        /// \param size Size of the stream in bytes.
+        ////////////////////////////////////////////////////////////////////////
+        RecordStream(void const * data = nullptr, std::size_t size = 0u);
+
+        Iterator begin() const;
+        Iterator end() const;
+
+        //! Size of the stream in bytes
+        std::size_t size() const { return m_size; }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the size of the record (header, payload and padding)
+        /// starting at the given position, 0 if it is truncated.
+        ////////////////////////////////////////////////////////////////////////
+        static std::size_t RecordSize(
+            unsigned char const * record, unsigned char const * end
+        );
+
+    private:
+        unsigned char const * m_data; ///< Beginning of the stream
+        std::size_t m_size;           ///< Size in bytes
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Writer of a record stream.
+////////////////////////////////////////////////////////////////////////////////
+class RecordStreamWriter
+{
+    public:
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Constructor.
+        /// \param out Output stream (binary).
+        ////////////////////////////////////////////////////////////////////////
+        explicit RecordStreamWriter(std::ostream & out);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Write the record of a visitable (with a stable tag and a
+        /// trivially copyable record type, see META_VisitableRecord).
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Visitable>
+        void write(typename RecordView<Visitable>::RecordType const & record);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Write a raw record. A payload larger than the size field of
+        /// the header (4 GiB) is not written and sets the failbit of the
+        /// output stream.
+        ////////////////////////////////////////////////////////////////////////
+        void write(std::uint64_t tag, void const * data, std::size_t size);
+
+    private:
+        std::ostream & m_out; ///< Output stream
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Record stream file mapped in memory (read-only).
+/// On the platforms without mmap, the file is read in memory.
+////////////////////////////////////////////////////////////////////////////////
+class MappedRecordFile
+{
+    public:
+        MappedRecordFile();
+        ~MappedRecordFile();
+
+        MappedRecordFile(MappedRecordFile const &) = delete;
+        MappedRecordFile & operator=(MappedRecordFile const &) = delete;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Map a file (the previous one is unmapped).
+        /// \return False if the file cannot be opened or mapped.
+        ////////////////////////////////////////////////////////////////////////
+        bool open(std::string const & path);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Unmap the file.
+        ////////////////////////////////////////////////////////////////////////
+        void close();
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the records of the file (empty if not open).
+        ////////////////////////////////////////////////////////////////////////
+        RecordStream stream() const;
+
+    private:
+        void const * m_data;                 ///< Mapped file
+        std::size_t m_size;                  ///< Size of the file
+        std::vector<std::uint64_t> m_buffer; ///< Copy of the file without mmap
+};
+
+
+/// \brief Macro helper declaring the record type of a visitable class: the
+/// trivially copyable payload of its records, viewed by a RecordView.
+#define META_VisitableRecord(RecordStruct) \
+    using VisitableRecordType = RecordStruct;
+
+
+#include "RecordStream.inl"
+
+#endif //RECORD_STREAM_HPP
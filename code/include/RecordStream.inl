@@ -0,0 +1,258 @@
+#ifndef RECORD_STREAM_INL
+#define RECORD_STREAM_INL
+
+#include "RecordStream.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define META_RECORD_FILE_MMAP 1
+
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#else
+    #define META_RECORD_FILE_MMAP 0
+#endif
+
+/// RecordView ///
+
+template <typename Visitable>
+inline RecordView<Visitable>::RecordView(RecordHeader const & header):
+    m_header(&header)
+{
+
+}
+
+template <typename Visitable>
+inline typename RecordView<Visitable>::RecordType const *
+RecordView<Visitable>::get() const
+{
+    static_assert(
+        alignof(RecordType) <= RecordAlignment, "Record type over-aligned"
+    );
+
+    assert(this->size() >= sizeof(RecordType) && "Record smaller than its type");
+
+    return reinterpret_cast<RecordType const *>(this->data());
+}
+
+template <typename Visitable>
+inline unsigned char const * RecordView<Visitable>::data() const
+{
+    return reinterpret_cast<unsigned char const *>(m_header + 1);
+}
+
+
+/// RecordStream ///
+
+inline RecordStream::Iterator::Iterator(
+    unsigned char const * current, unsigned char const * end
+):
+    m_current(current), m_end(end)
+{
+    // Stop at the first truncated record
+    if(RecordStream::RecordSize(m_current, m_end) == 0u) m_current = m_end;
+}
+
+inline RecordHeader const & RecordStream::Iterator::operator*() const
+{
+    return *reinterpret_cast<RecordHeader const *>(m_current);
+}
+
+inline RecordStream::Iterator & RecordStream::Iterator::operator++()
+{
+    m_current += RecordStream::RecordSize(m_current, m_end);
+
+    if(RecordStream::RecordSize(m_current, m_end) == 0u) m_current = m_end;
+
+    return *this;
+}
+
+inline RecordStream::Iterator RecordStream::Iterator::operator++(int)
+{
+    Iterator const previous = *this;
+    ++*this;
+    return previous;
+}
+
+inline bool RecordStream::Iterator::operator==(Iterator const & other) const
+{
+    return m_current == other.m_current;
+}
+
+inline RecordStream::RecordStream(void const * data, std::size_t size):
+    m_data(static_cast<unsigned char const *>(data)), m_size(size)
+{
+    assert(reinterpret_cast<std::uintptr_t>(data) % RecordAlignment == 0u
+        && "Unaligned record stream");
+}
+
+inline RecordStream::Iterator RecordStream::begin() const
+{
+    return Iterator(m_data, m_data + m_size);
+}
+
+inline RecordStream::Iterator RecordStream::end() const
+{
+    return Iterator(m_data + m_size, m_data + m_size);
+}
+
+inline std::size_t RecordStream::RecordSize(
+    unsigned char const * record, unsigned char const * end
+)
+{
+    std::size_t const available = static_cast<std::size_t>(end - record);
+
+    if(available < sizeof(RecordHeader)) return 0u;
+
+    std::size_t const payload =
+        reinterpret_cast<RecordHeader const *>(record)->size;
+
+    std::size_t const size = sizeof(RecordHeader)
+        + (payload + RecordAlignment - 1u) / RecordAlignment * RecordAlignment;
+
+    return size <= available ? size : 0u;
+}
+
+
+/// RecordStreamWriter ///
+
+inline RecordStreamWriter::RecordStreamWriter(std::ostream & out):
+    m_out(out)
+{
+
+}
+
+template <typename Visitable>
+inline void RecordStreamWriter::write(
+    typename RecordView<Visitable>::RecordType const & record
+)
+{
+    using RecordType = typename RecordView<Visitable>::RecordType;
+
+    static_assert(
+        std::is_trivially_copyable<RecordType>::value,
+        "Record types must be trivially copyable"
+    );
+    static_assert(
+        visitor_details::HasStableTag<Visitable>::value,
+        "Recorded visitables must declare their own stable tag (META_StableTag)"
+    );
+
+    this->write(
+        visitor_details::GetStableTag<Visitable>::value, &record, sizeof(RecordType)
+    );
+}
+
+inline void RecordStreamWriter::write(
+    std::uint64_t tag, void const * data, std::size_t size
+)
+{
+    if(size > std::numeric_limits<std::uint32_t>::max())
+    {
+        m_out.setstate(std::ios::failbit);
+        return;
+    }
+
+    RecordHeader const header = { tag, static_cast<std::uint32_t>(size), 0u };
+
+    m_out.write(reinterpret_cast<char const *>(&header), sizeof(header));
+    m_out.write(static_cast<char const *>(data), static_cast<std::streamsize>(size));
+
+    char const padding[RecordAlignment] = { };
+    m_out.write(padding, static_cast<std::streamsize>(
+        (RecordAlignment - size % RecordAlignment) % RecordAlignment
+    ));
+}
+
+
+/// MappedRecordFile ///
+
+inline MappedRecordFile::MappedRecordFile():
+    m_data(nullptr), m_size(0u)
+{
+
+}
+
+inline MappedRecordFile::~MappedRecordFile()
+{
+    this->close();
+}
+
+inline bool MappedRecordFile::open(std::string const & path)
+{
+    this->close();
+
+#if META_RECORD_FILE_MMAP
+    int const file = ::open(path.c_str(), O_RDONLY);
+
+    if(file < 0) return false;
+
+    struct stat status;
+
+    if(::fstat(file, &status) != 0)
+    {
+        ::close(file);
+        return false;
+    }
+
+    std::size_t const size = static_cast<std::size_t>(status.st_size);
+
+    // Empty files cannot be mapped
+    void * const data = size > 0u ?
+        ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0) : nullptr;
+
+    // The mapping keeps its own reference to the file
+    ::close(file);
+
+    if(data == MAP_FAILED) return false;
+
+    if(data) ::madvise(data, size, MADV_SEQUENTIAL);
+
+    m_data = data;
+    m_size = size;
+#else
+    std::ifstream file(path.c_str(), std::ios::binary | std::ios::ate);
+
+    if(!file) return false;
+
+    std::size_t const size = static_cast<std::size_t>(file.tellg());
+
+    // 64-bit words keep the records aligned
+    m_buffer.resize((size + sizeof(std::uint64_t) - 1u) / sizeof(std::uint64_t));
+
+    file.seekg(0);
+
+    if(!file.read(reinterpret_cast<char *>(m_buffer.data()), size)) return false;
+
+    m_data = m_buffer.data();
+    m_size = size;
+#endif
+
+    return true;
+}
+
+inline void MappedRecordFile::close()
+{
+#if META_RECORD_FILE_MMAP
+    if(m_data) ::munmap(const_cast<void *>(m_data), m_size);
+#endif
+
+    m_buffer.clear();
+    m_buffer.shrink_to_fit();
+
+    m_data = nullptr;
+    m_size = 0u;
+}
+
+inline RecordStream MappedRecordFile::stream() const
+{
+    return RecordStream(m_data, m_size);
+}
+
+#endif //RECORD_STREAM_INL
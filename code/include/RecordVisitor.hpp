@@ -0,0 +1,96 @@
+#ifndef RECORD_VISITOR_HPP
+#define RECORD_VISITOR_HPP
+
+#include "RecordStream.hpp"
+#include "RecordVisitorDetails.hpp"
+#include "Visitor.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Visitor of the records of a record stream (see RecordStream).
+///
+/// The records are dispatched from their stable tag (see META_StableTag) to
+/// the visit method of their visitable, which receives a RecordView of the
+/// record: the records are read in place (e.g. from a MappedRecordFile) and
+/// no visitable is created. The fallbacks are the ones of the Visitor: a
+/// record without visit method is visited as its nearest ancestor, and a
+/// record with an unknown stable tag or a payload smaller than its record
+/// type (see META_VisitableRecord) as the base class of the hierarchy, whose
+/// visit method must check the size of the records.
+/// For example:
+/// \code
+///     class EventVisitor : public RecordVisitor<Event, void>
+///     {
+///         public:
+///             META_Visitor(EventVisitor, replay)
+///
+///             EventVisitor()
+///             {
+///                 META_Visitables(Click, KeyPress);
+///             }
+///
+///         private:
+///             void replay(RecordView<Event> const & event);
+///             void replay(RecordView<Click> const & click); // click->x, ...
+///             void replay(RecordView<KeyPress> const & key);
+///     };
+///
+///     MappedRecordFile file;
+///     if(file.open("events.log")) visitor.visitStream(file.stream());
+/// \endcode
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base, typename ReturnType = void, typename ...Args>
+class RecordVisitor
+{
+    public:
+        //! Type passing an extra argument through the dispatch (see
+        /// visitor_details::VisitorArgument)
+        template <typename T>
+        using ArgumentType = visitor_details::VisitorArgumentType<T>;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Perform the visitation of the given record.
+        /// \param record Header of the record (followed by its payload).
+        /// \return The result of the visitation.
+        ////////////////////////////////////////////////////////////////////////
+        ReturnType operator()(RecordHeader const & record, ArgumentType<Args> ...args);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Perform the visitation of every record of a stream, in order.
+        /// The arguments are passed to every visitation: the visit methods
+        /// must not consume them.
+        /// \return The number of records visited.
+        ////////////////////////////////////////////////////////////////////////
+        std::size_t visitStream(RecordStream const & stream, ArgumentType<Args> ...args);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Call the visit method of the given visitable with a view of
+        /// the record.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename VisitorImpl, typename Visitable, typename Invoker>
+        static ReturnType thunk(
+            RecordVisitor & visitor, RecordHeader const & record, ArgumentType<Args> ...args
+        );
+
+    public:
+        using BaseType   = Base;
+        using Thunk      =
+            ReturnType (*)(RecordVisitor &, RecordHeader const &, ArgumentType<Args>...);
+        using VTableType = visitor_details::RecordVisitorVTable<Base const, Thunk>;
+        using RType      = ReturnType;
+
+        //! Class used by META_Visitables to retrieve the vtable of a visitor
+        template <typename VisitorImpl, typename Invoker, typename ...VisitedList>
+        using VTableGetter =
+            visitor_details::GetVisitorVTable<VisitorImpl, Invoker, VisitedList...>;
+
+    private:
+        template <typename VisitorImpl, typename Invoker, typename ...VisitedList>
+        friend struct VisitorVTableSetter;
+
+        VTableType const * m_vtable; ///< Vtable pointer
+};
+
+
+#include "RecordVisitor.inl"
+
+#endif //RECORD_VISITOR_HPP
@@ -0,0 +1,64 @@
+#ifndef RECORD_VISITOR_INL
+#define RECORD_VISITOR_INL
+
+#include "RecordVisitor.hpp"
+
+template <typename Base, typename ReturnType, typename ...Args>
+inline ReturnType RecordVisitor<Base, ReturnType, Args...>::operator()(
+    RecordHeader const & record, ArgumentType<Args> ...args
+)
+{
+    std::size_t const tag = m_vtable->find(record.tag);
+
+#if META_VISITOR_INSTRUMENTATION
+    visitor_details::DispatchProbe const probe(m_vtable->statsId(), tag);
+#endif
+
+    Thunk thunk = (*m_vtable)[tag];
+
+    return thunk(*this, record, visitor_details::ForwardArgument<Args>(args)...);
+}
+
+template <typename Base, typename ReturnType, typename ...Args>
+inline std::size_t RecordVisitor<Base, ReturnType, Args...>::visitStream(
+    RecordStream const & stream, ArgumentType<Args> ...args
+)
+{
+    std::size_t count = 0u;
+
+    for(RecordHeader const & record : stream)
+    {
+        (*this)(record, visitor_details::ForwardArgument<Args>(args)...);
+        ++count;
+    }
+
+    return count;
+}
+
+template <typename Base, typename ReturnType, typename ...Args>
+template <typename VisitorImpl, typename Visitable, typename Invoker>
+inline ReturnType RecordVisitor<Base, ReturnType, Args...>::thunk(
+    RecordVisitor & v, RecordHeader const & record, ArgumentType<Args> ...args
+)
+{
+    VisitorImpl & visitor = static_cast<VisitorImpl&>(v);
+
+    // The records smaller than their record type (e.g. written by an older
+    // version of the program) are visited as the base class
+    if(record.size < visitor_details::GetVisitableRecordSize<Visitable>::value)
+    {
+        RecordView<Base> base(record);
+
+        return Invoker::Invoke(
+            visitor, base, visitor_details::ForwardArgument<Args>(args)...
+        );
+    }
+
+    RecordView<Visitable> view(record);
+
+    return Invoker::Invoke(
+        visitor, view, visitor_details::ForwardArgument<Args>(args)...
+    );
+}
+
+#endif //RECORD_VISITOR_INL
@@ -0,0 +1,191 @@
+#ifndef RECORD_VISITOR_DETAILS_HPP
+#define RECORD_VISITOR_DETAILS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "VisitorDetails.hpp"
+
+namespace visitor_details {
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Virtual table of a RecordVisitor: the vtable of the runtime tags and
+/// an open addressing index from the stable tags to the runtime tags.
+///
+/// The index is built with the table, from the stable tags registered at that
+/// time. The stable tags registered later are found in the hierarchy (under
+/// its lock), the unknown ones (written by another program) are dispatched to
+/// the base class of the hierarchy. Both results are cached (lock free), so a
+/// stream of records missing from the index only takes the lock once per
+/// stable tag.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base, typename Func>
+class RecordVisitorVTable : public VisitorVTable<Base, Func>
+{
+    public:
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Constructor.
+        /// \param size Number of slots (must cover every registered tag).
+        ////////////////////////////////////////////////////////////////////////
+        explicit RecordVisitorVTable(std::size_t size):
+            VisitorVTable<Base, Func>(size), m_mask(0u), m_rootTag(0u)
+        {
+            for(LateStableTag & entry : m_lateStableTags)
+            {
+                entry.sequence.store(0u, std::memory_order_relaxed);
+                entry.stableTag.store(0u, std::memory_order_relaxed);
+                entry.tag.store(0u, std::memory_order_relaxed);
+            }
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Resolve the fallbacks (see VisitorVTable) and build the
+        /// index of the stable tags.
+        ////////////////////////////////////////////////////////////////////////
+        void resolveFallbacks()
+        {
+            VisitorVTable<Base, Func>::resolveFallbacks();
+
+            m_rootTag = GetVisitableTag<Base, Base>();
+
+            std::lock_guard<std::mutex> lock(HierarchyParentTable<Base>::GetMutex());
+
+            std::unordered_map<std::uint64_t, std::size_t> const & stableTags =
+                HierarchyStableTagTable<Base>::Get();
+
+            // Load factor of at most 1/2 (and an empty slot to end the probes)
+            std::size_t capacity = 2u;
+            while(capacity < 2u * stableTags.size()) capacity *= 2u;
+
+            m_entries.assign(capacity, Entry{0u, 0u});
+            m_mask = capacity - 1u;
+
+            for(auto const & stableTag : stableTags)
+            {
+                std::size_t i = RecordVisitorVTable::Hash(stableTag.first) & m_mask;
+
+                while(m_entries[i].stableTag != 0u) i = (i + 1u) & m_mask;
+
+                m_entries[i] = Entry{stableTag.first, stableTag.second};
+            }
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the runtime tag of a stable tag.
+        ////////////////////////////////////////////////////////////////////////
+        std::size_t find(std::uint64_t stableTag) const
+        {
+            std::size_t i = RecordVisitorVTable::Hash(stableTag) & m_mask;
+
+            for(;;)
+            {
+                Entry const & entry = m_entries[i];
+
+                // An empty entry ends the probes (even for the stable tag 0)
+                if(entry.stableTag == 0u) return this->resolveUnknownStableTag(stableTag);
+                if(entry.stableTag == stableTag) return entry.tag;
+
+                i = (i + 1u) & m_mask;
+            }
+        }
+
+    private:
+        static std::size_t Hash(std::uint64_t stableTag)
+        {
+            return static_cast<std::size_t>((stableTag * 0x9E3779B97F4A7C15ull) >> 32);
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Find a stable tag missing from the index in the hierarchy.
+        /// The results, including the stable tags dispatched to the base
+        /// class, are cached by stable tag until another stable tag is
+        /// registered: the hierarchy is only searched (under its lock) on a
+        /// miss of the cache.
+        ////////////////////////////////////////////////////////////////////////
+        std::size_t resolveUnknownStableTag(std::uint64_t stableTag) const
+        {
+            if(stableTag == 0u) return m_rootTag;
+
+            // Read before the search: a registration meanwhile invalidates it
+            std::uint32_t const generation =
+                HierarchyStableTagTable<Base>::Generation().load(std::memory_order_acquire);
+
+            LateStableTag & cached =
+                m_lateStableTags[RecordVisitorVTable::Hash(stableTag) % LateStableTagCacheSize];
+
+            // Entry: (generation << 32) | tag, read under the sequence lock
+            std::uint32_t sequence = cached.sequence.load(std::memory_order_acquire);
+
+            if((sequence & 1u) == 0u
+                && cached.stableTag.load(std::memory_order_relaxed) == stableTag)
+            {
+                std::uint64_t const entry = cached.tag.load(std::memory_order_relaxed);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                if(cached.sequence.load(std::memory_order_relaxed) == sequence
+                    && (entry >> 32) == generation)
+                {
+                    return static_cast<std::size_t>(entry & 0xFFFFFFFFu);
+                }
+            }
+
+            std::size_t tag = FindVisitableTag<Base>(stableTag);
+            if(tag == 0u) tag = m_rootTag;
+
+            // Only one writer at a time, the others leave the entry as it is
+            sequence = cached.sequence.load(std::memory_order_relaxed);
+
+            if(tag <= 0xFFFFFFFFu && (sequence & 1u) == 0u
+                && cached.sequence.compare_exchange_strong(
+                    sequence, sequence + 1u, std::memory_order_relaxed
+                ))
+            {
+                std::atomic_thread_fence(std::memory_order_release);
+
+                cached.stableTag.store(stableTag, std::memory_order_relaxed);
+                cached.tag.store(
+                    static_cast<std::uint64_t>(generation) << 32 | tag, std::memory_order_relaxed
+                );
+
+                cached.sequence.store(sequence + 2u, std::memory_order_release);
+            }
+
+            return tag;
+        }
+
+    private:
+        static constexpr std::size_t LateStableTagCacheSize = 16u;
+
+        //! Entry of the index (empty if the stable tag is 0)
+        struct Entry
+        {
+            std::uint64_t stableTag;
+            std::size_t tag;
+        };
+
+        std::vector<Entry> m_entries; ///< Index of the stable tags
+        std::size_t m_mask;           ///< Capacity of the index - 1
+        std::size_t m_rootTag;        ///< Tag of the base of the hierarchy
+
+        //! Cached lookup of a stable tag missing from the index (the sequence
+        /// is odd while the entry is written)
+        struct LateStableTag
+        {
+            std::atomic<std::uint32_t> sequence;
+            std::atomic<std::uint64_t> stableTag;
+            std::atomic<std::uint64_t> tag;
+        };
+
+        //! Stable tags registered after the index has been built, or unknown
+        mutable LateStableTag m_lateStableTags[LateStableTagCacheSize];
+};
+
+} // visitor_details
+
+
+#endif //RECORD_VISITOR_DETAILS_HPP
@@ -0,0 +1,120 @@
+#ifndef TREE_TRAVERSAL_HPP
+#define TREE_TRAVERSAL_HPP
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "VisitorDetails.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Action returned by the visit methods of a traversal.
+////////////////////////////////////////////////////////////////////////////////
+enum class TraversalAction
+{
+    Continue, ///< Visit the children of the node
+    Prune,    ///< Skip the children of the node (pre-order and breadth-first)
+    Stop      ///< End the traversal
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Iterative traversal of a tree of visitables (e.g. a scene graph).
+///
+/// The walks are driven by an explicit stack (or queue), so deep trees do not
+/// overflow the call stack, and the nodes visited next are prefetched a few
+/// steps ahead. The visitor returns a TraversalAction (or void to visit every
+/// node), and the children of a node are given by a function:
+/// \code
+///     // Range of children (references, pointers or smart pointers)
+///     auto children = [](Node & node) -> std::vector<Node *> const &
+///     {
+///         return node.children();
+///     };
+///
+///     TreeTraversal<Node> traversal;
+///     traversal.preOrder(cullVisitor, root, children, frustum);
+/// \endcode
+/// A traversal keeps its stack between the walks: reuse it to avoid the
+/// allocations.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base>
+class TreeTraversal
+{
+    public:
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Constructor.
+        /// \param prefetchDistance Number of nodes prefetched ahead of the
+        ///                         visited one (0 to disable the prefetching).
+        ////////////////////////////////////////////////////////////////////////
+        explicit TreeTraversal(std::size_t prefetchDistance = 8u);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Visit a node, then its children (in their order).
+        /// \param visitor  Visitor returning a TraversalAction or void.
+        /// \param root     Root of the tree.
+        /// \param children Function returning the range of children of a node.
+        /// \param params   Parameters passed to every visitation.
+        /// \return False if the traversal was stopped.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Visitor, typename Children, typename ...Params>
+        bool preOrder(
+            Visitor & visitor, Base & root, Children const & children,
+            Params const & ...params
+        );
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Visit the children of a node (in their order), then the node.
+        /// Prune has no effect (the children are already visited).
+        /// \return False if the traversal was stopped.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Visitor, typename Children, typename ...Params>
+        bool postOrder(
+            Visitor & visitor, Base & root, Children const & children,
+            Params const & ...params
+        );
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Visit the nodes level by level.
+        /// \return False if the traversal was stopped.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Visitor, typename Children, typename ...Params>
+        bool breadthFirst(
+            Visitor & visitor, Base & root, Children const & children,
+            Params const & ...params
+        );
+
+    private:
+        //! Node waiting in the stack or the queue
+        struct Entry
+        {
+            Base * node;   ///< Node
+            bool expanded; ///< Children pushed (post-order)
+        };
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Push the children of a node, the first one on top.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Children>
+        void pushChildren(Base & node, Children const & children);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Append the children of a node to the queue.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Children>
+        void enqueueChildren(Base & node, Children const & children);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Prefetch the node at the given position (if any).
+        ////////////////////////////////////////////////////////////////////////
+        void prefetch(std::size_t position) const;
+
+    private:
+        std::vector<Entry> m_nodes;     ///< Stack or queue of nodes
+        std::size_t m_prefetchDistance; ///< Nodes prefetched ahead
+};
+
+
+#include "TreeTraversal.inl"
+
+#endif //TREE_TRAVERSAL_HPP
@@ -0,0 +1,224 @@
+#ifndef TREE_TRAVERSAL_INL
+#define TREE_TRAVERSAL_INL
+
+#include "TreeTraversal.hpp"
+
+#include <algorithm>
+
+namespace visitor_details {
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Hint the processor to load the cache line at the given address.
+////////////////////////////////////////////////////////////////////////////////
+inline void Prefetch(void const * address)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address);
+#else
+    static_cast<void>(address);
+#endif
+}
+
+//! Visit a node with a visitor returning void: continue
+template <typename Visitor, typename Base, typename ...Params>
+TraversalAction VisitNode(
+    std::true_type /* void */, Visitor & visitor, Base & node, Params const & ...params
+)
+{
+    visitor(node, params...);
+    return TraversalAction::Continue;
+}
+
+//! Visit a node with a visitor returning a TraversalAction
+template <typename Visitor, typename Base, typename ...Params>
+TraversalAction VisitNode(
+    std::false_type /* void */, Visitor & visitor, Base & node, Params const & ...params
+)
+{
+    static_assert(
+        std::is_convertible<typename Visitor::RType, TraversalAction>::value,
+        "Traversal visitors return a TraversalAction or void"
+    );
+
+    return visitor(node, params...);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Visit a node of a traversal.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Visitor, typename Base, typename ...Params>
+TraversalAction VisitNode(Visitor & visitor, Base & node, Params const & ...params)
+{
+    return VisitNode(
+        std::is_void<typename Visitor::RType>(), visitor, node, params...
+    );
+}
+
+} // visitor_details
+
+
+template <typename Base>
+inline TreeTraversal<Base>::TreeTraversal(std::size_t prefetchDistance):
+    m_prefetchDistance(prefetchDistance)
+{
+
+}
+
+template <typename Base>
+template <typename Visitor, typename Children, typename ...Params>
+inline bool TreeTraversal<Base>::preOrder(
+    Visitor & visitor, Base & root, Children const & children,
+    Params const & ...params
+)
+{
+    m_nodes.clear();
+    m_nodes.push_back(Entry{&root, false});
+
+    while(!m_nodes.empty())
+    {
+        Base & node = *m_nodes.back().node;
+        m_nodes.pop_back();
+
+        // Node visited a few steps ahead (if the nodes above it are leaves)
+        if(m_nodes.size() >= m_prefetchDistance && m_prefetchDistance > 0u)
+        {
+            this->prefetch(m_nodes.size() - m_prefetchDistance);
+        }
+
+        TraversalAction const action = visitor_details::VisitNode(visitor, node, params...);
+
+        if(action == TraversalAction::Stop)
+        {
+            m_nodes.clear();
+            return false;
+        }
+
+        if(action == TraversalAction::Continue) this->pushChildren(node, children);
+    }
+
+    return true;
+}
+
+template <typename Base>
+template <typename Visitor, typename Children, typename ...Params>
+inline bool TreeTraversal<Base>::postOrder(
+    Visitor & visitor, Base & root, Children const & children,
+    Params const & ...params
+)
+{
+    m_nodes.clear();
+    m_nodes.push_back(Entry{&root, false});
+
+    while(!m_nodes.empty())
+    {
+        Entry & entry = m_nodes.back();
+
+        if(!entry.expanded)
+        {
+            // Visit the node once its children have been visited
+            entry.expanded = true;
+            this->pushChildren(*entry.node, children);
+
+            continue;
+        }
+
+        Base & node = *entry.node;
+        m_nodes.pop_back();
+
+        TraversalAction const action = visitor_details::VisitNode(visitor, node, params...);
+
+        if(action == TraversalAction::Stop)
+        {
+            m_nodes.clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <typename Base>
+template <typename Visitor, typename Children, typename ...Params>
+inline bool TreeTraversal<Base>::breadthFirst(
+    Visitor & visitor, Base & root, Children const & children,
+    Params const & ...params
+)
+{
+    // Minimum number of visited nodes before the queue is compacted
+    static constexpr std::size_t MinCompaction = 4096u;
+
+    m_nodes.clear();
+    m_nodes.push_back(Entry{&root, false});
+
+    std::size_t head = 0u;
+
+    while(head < m_nodes.size())
+    {
+        // The queue is the visit order: the prefetching is exact
+        if(m_prefetchDistance > 0u) this->prefetch(head + m_prefetchDistance);
+
+        Base & node = *m_nodes[head++].node;
+
+        TraversalAction const action = visitor_details::VisitNode(visitor, node, params...);
+
+        if(action == TraversalAction::Stop)
+        {
+            m_nodes.clear();
+            return false;
+        }
+
+        if(action == TraversalAction::Continue) this->enqueueChildren(node, children);
+
+        // Drop the visited nodes once they fill half of the queue
+        if(head >= MinCompaction && head * 2u >= m_nodes.size())
+        {
+            m_nodes.erase(m_nodes.begin(), m_nodes.begin() + head);
+            head = 0u;
+        }
+    }
+
+    m_nodes.clear();
+
+    return true;
+}
+
+template <typename Base>
+template <typename Children>
+inline void TreeTraversal<Base>::pushChildren(Base & node, Children const & children)
+{
+    std::size_t const first = m_nodes.size();
+
+    for(auto && child : children(node))
+    {
+        m_nodes.push_back(Entry{&visitor_details::ToVisitable<Base>(child), false});
+    }
+
+    // First child on top of the stack
+    std::reverse(m_nodes.begin() + first, m_nodes.end());
+
+    // The first children are visited next
+    std::size_t const prefetched = std::min(m_prefetchDistance, m_nodes.size() - first);
+
+    for(std::size_t i = 1u; i <= prefetched; ++i)
+    {
+        this->prefetch(m_nodes.size() - i);
+    }
+}
+
+template <typename Base>
+template <typename Children>
+inline void TreeTraversal<Base>::enqueueChildren(Base & node, Children const & children)
+{
+    for(auto && child : children(node))
+    {
+        m_nodes.push_back(Entry{&visitor_details::ToVisitable<Base>(child), false});
+    }
+}
+
+template <typename Base>
+inline void TreeTraversal<Base>::prefetch(std::size_t position) const
+{
+    if(position < m_nodes.size()) visitor_details::Prefetch(m_nodes[position].node);
+}
+
+#endif //TREE_TRAVERSAL_INL
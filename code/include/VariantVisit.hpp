@@ -0,0 +1,63 @@
+#ifndef VARIANT_VISIT_HPP
+#define VARIANT_VISIT_HPP
+
+#if __cplusplus < 201703L
+    #error "VariantVisit.hpp requires C++17 (std::variant)"
+#endif
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "VisitableHandle.hpp"
+#include "VisitorDetails.hpp"
+
+namespace visitor_details {
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Visit the alternative of a variant from the given one: the index of
+/// the variant is compared with the indices of the alternatives (a switch once
+/// compiled), then the alternative is dispatched on its tag.
+////////////////////////////////////////////////////////////////////////////////
+template <std::size_t Index, typename Visitor, typename Variant, typename ...Params>
+typename Visitor::RType VisitVariantAlternative(
+    Visitor & visitor, Variant & variant, std::size_t index, Params && ...params
+);
+
+} // visitor_details
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Visit a variant of visitables stored by value with a visitor of
+/// their hierarchy.
+///
+/// The index of the variant is mapped at compile time to the tag of the
+/// alternative, which is then dispatched by the vtable of the visitor (nearest
+/// ancestor fallback, runtime overrides): the visit methods of the visitor are
+/// reused as they are, without a std::visit overload set.
+/// \code
+///     using ShapeValue = std::variant<Circle, Polygon, PolyPolygon>;
+///
+///     std::vector<ShapeValue> shapes;
+///
+///     VisitVariant(visitor, shapes[0], 1.f);
+///     VisitVariantRange(visitor, shapes.begin(), shapes.end(), 1.f);
+/// \endcode
+/// Every alternative must derive from the base class of the visitor (a const
+/// variant needs a visitor of a const hierarchy). A variant valueless by
+/// exception throws std::bad_variant_access, like std::visit.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Visitor, typename Variant, typename ...Params>
+typename Visitor::RType VisitVariant(Visitor & visitor, Variant & variant, Params && ...params);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Visit a range of variants in order (see VisitVariant).
+////////////////////////////////////////////////////////////////////////////////
+template <typename Visitor, typename InputIt, typename ...Params>
+void VisitVariantRange(Visitor & visitor, InputIt first, InputIt last, Params const & ...params);
+
+
+#include "VariantVisit.inl"
+
+#endif //VARIANT_VISIT_HPP
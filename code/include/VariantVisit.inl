@@ -0,0 +1,77 @@
+#ifndef VARIANT_VISIT_INL
+#define VARIANT_VISIT_INL
+
+#include "VariantVisit.hpp"
+
+namespace visitor_details {
+
+//! Check that the alternatives of a variant are visitables of a hierarchy
+template <typename Base, typename Variant>
+struct IsVariantOfVisitables;
+
+template <typename Base, typename ...Alternatives>
+struct IsVariantOfVisitables<Base, std::variant<Alternatives...>>:
+    std::conjunction<std::is_base_of<std::remove_const_t<Base>, Alternatives>...>
+{
+
+};
+
+template <typename Base, typename ...Alternatives>
+struct IsVariantOfVisitables<Base, std::variant<Alternatives...> const>:
+    IsVariantOfVisitables<Base, std::variant<Alternatives...>>
+{
+
+};
+
+template <std::size_t Index, typename Visitor, typename Variant, typename ...Params>
+typename Visitor::RType VisitVariantAlternative(
+    Visitor & visitor, Variant & variant, std::size_t index, Params && ...params
+)
+{
+    using Base = typename Visitor::BaseType;
+    using Alternative = std::variant_alternative_t<Index, std::remove_const_t<Variant>>;
+
+    // The last alternative is not compared: the index is valid
+    if constexpr(Index + 1u < std::variant_size_v<std::remove_const_t<Variant>>)
+    {
+        if(index != Index)
+        {
+            return VisitVariantAlternative<Index + 1u>(
+                visitor, variant, index, std::forward<Params>(params)...
+            );
+        }
+    }
+
+    Base & visitable = *std::get_if<Index>(&variant);
+
+    return visitor(
+        VisitableHandle<Base>(&visitable, GetVisitableTag<Alternative, Base>()),
+        std::forward<Params>(params)...
+    );
+}
+
+} // visitor_details
+
+
+template <typename Visitor, typename Variant, typename ...Params>
+inline typename Visitor::RType VisitVariant(Visitor & visitor, Variant & variant, Params && ...params)
+{
+    static_assert(
+        visitor_details::IsVariantOfVisitables<typename Visitor::BaseType, Variant>::value,
+        "The alternatives of the variant must derive from the base class of the visitor"
+    );
+
+    if(variant.valueless_by_exception()) throw std::bad_variant_access();
+
+    return visitor_details::VisitVariantAlternative<0u>(
+        visitor, variant, variant.index(), std::forward<Params>(params)...
+    );
+}
+
+template <typename Visitor, typename InputIt, typename ...Params>
+inline void VisitVariantRange(Visitor & visitor, InputIt first, InputIt last, Params const & ...params)
+{
+    for(; first != last; ++first) VisitVariant(visitor, *first, params...);
+}
+
+#endif //VARIANT_VISIT_INL
@@ -0,0 +1,159 @@
+#ifndef VISIT_JOURNAL_HPP
+#define VISIT_JOURNAL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "VisitableHandle.hpp"
+#include "VisitorDetails.hpp"
+
+//! Order of the visitables collected from a VisitJournal
+enum class JournalOrder
+{
+    Recorded, ///< Order of their first record (per thread, then by thread)
+    ByTag     ///< Grouped by tag (the thunk is resolved once per group)
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Journal of the visitables changed since the last collection, so a
+/// frame update visits the changed visitables only.
+///
+/// The mutations record the visitable with its tag. Each thread appends to
+/// its own buffer, registered in the journal on the first record of the
+/// thread with a compare-and-swap: recording takes no lock and is not shared
+/// between the threads. The collection deduplicates the records and returns
+/// handles, to be visited by any visitor:
+/// \code
+///     VisitJournal<Node> journal;
+///
+///     // Mutations (any thread)
+///     node.setTransform(transform);
+///     journal.record(node);
+///
+///     // Frame update
+///     VisitableHandleVector<Node> changed;
+///     journal.collectByDepth(changed, [](Node & node) { return node.depth(); });
+///
+///     for(VisitableHandle<Node> const & node : changed) updater(node, frame);
+/// \endcode
+/// Visitor::visitRange groups the visitables by type: it keeps the order of
+/// the handles only after a collection by tag.
+/// The collection clears the journal: it must not run concurrently with the
+/// records (e.g. it runs between the update jobs of two frames). The buffers
+/// of the threads are kept (with their capacity) until the journal is
+/// destroyed, so a journal is meant to be long-lived.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base>
+class VisitJournal
+{
+    public:
+        VisitJournal();
+        ~VisitJournal();
+
+        VisitJournal(VisitJournal const &) = delete;
+        VisitJournal & operator=(VisitJournal const &) = delete;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Record a changed visitable (in the buffer of the calling
+        /// thread). A visitable can be recorded any number of times.
+        ////////////////////////////////////////////////////////////////////////
+        void record(Base & visitable);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Record a changed visitable whose tag is known.
+        ////////////////////////////////////////////////////////////////////////
+        void record(VisitableHandle<Base> const & handle);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Collect the recorded visitables (once each) and clear the
+        /// journal.
+        /// \param handles Handles of the visitables (replaced).
+        /// \param order   Order of the handles.
+        /// \return The number of visitables.
+        ////////////////////////////////////////////////////////////////////////
+        std::size_t collect(
+            VisitableHandleVector<Base> & handles,
+            JournalOrder order = JournalOrder::Recorded
+        );
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Collect the recorded visitables (once each) by increasing
+        /// depth, so the parents come before their children in a hierarchy,
+        /// and clear the journal. The order of the visitables of the same
+        /// depth is the recorded order.
+        /// \param depth Function returning the depth of a visitable (called
+        ///              once per visitable).
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Depth>
+        std::size_t collectByDepth(VisitableHandleVector<Base> & handles, Depth depth);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Visit the recorded visitables (once each, in the recorded
+        /// order) and clear the journal.
+        /// \return The number of visitables.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Visitor, typename ...Params>
+        std::size_t visit(Visitor & visitor, Params const & ...params);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the number of records (duplicates included).
+        ////////////////////////////////////////////////////////////////////////
+        std::size_t size() const;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Drop the records.
+        ////////////////////////////////////////////////////////////////////////
+        void clear();
+
+    private:
+        //! Record of a visitable
+        struct Entry
+        {
+            Base * visitable;     ///< Changed visitable
+            std::size_t tag;      ///< Tag of the visitable
+            std::size_t order;    ///< Sort key (sequence, tag or depth)
+            std::size_t sequence; ///< Index in the gathered records
+        };
+
+        //! Buffer of the records of a thread
+        struct ThreadBuffer
+        {
+            std::vector<Entry> entries;
+            ThreadBuffer * next;
+        };
+
+        //! Buffer of a journal for the calling thread
+        struct LocalBuffer
+        {
+            std::uint64_t journal;  ///< Id of the journal
+            ThreadBuffer * buffer;  ///< Buffer of the thread
+        };
+
+        //! Return the buffer of the calling thread (registered on first use)
+        ThreadBuffer & localBuffer();
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Gather the records of the threads, keep the first record of
+        /// each visitable and clear the buffers.
+        ////////////////////////////////////////////////////////////////////////
+        void gather();
+
+        //! Sort the gathered records by order and write their handles
+        std::size_t sortTo(VisitableHandleVector<Base> & handles);
+
+        //! Buffers of the journals of the calling thread
+        static std::vector<LocalBuffer> & LocalBuffers();
+
+    private:
+        std::uint64_t m_id;                    ///< Unique id (never reused)
+        std::atomic<ThreadBuffer *> m_buffers; ///< Buffers of the threads
+        std::vector<Entry> m_gathered;         ///< Gathered records (scratch)
+        VisitableHandleVector<Base> m_handles; ///< Visited handles (scratch)
+};
+
+
+#include "VisitJournal.inl"
+
+#endif //VISIT_JOURNAL_HPP
@@ -0,0 +1,199 @@
+#ifndef VISIT_JOURNAL_INL
+#define VISIT_JOURNAL_INL
+
+#include "VisitJournal.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace visitor_details {
+
+//! Draw the id of a new journal
+inline std::uint64_t NextJournalId()
+{
+    static std::atomic<std::uint64_t> s_id(0u);
+    return s_id.fetch_add(1u, std::memory_order_relaxed);
+}
+
+} // visitor_details
+
+
+template <typename Base>
+inline VisitJournal<Base>::VisitJournal():
+    m_id(visitor_details::NextJournalId()), m_buffers(nullptr)
+{
+
+}
+
+template <typename Base>
+inline VisitJournal<Base>::~VisitJournal()
+{
+    ThreadBuffer * buffer = m_buffers.load(std::memory_order_acquire);
+
+    while(buffer)
+    {
+        ThreadBuffer * const next = buffer->next;
+        delete buffer;
+        buffer = next;
+    }
+}
+
+template <typename Base>
+inline void VisitJournal<Base>::record(Base & visitable)
+{
+    this->localBuffer().entries.push_back(
+        Entry{&visitable, visitor_details::GetDispatchTag(visitable), 0u, 0u}
+    );
+}
+
+template <typename Base>
+inline void VisitJournal<Base>::record(VisitableHandle<Base> const & handle)
+{
+    this->localBuffer().entries.push_back(Entry{handle.get(), handle.tag(), 0u, 0u});
+}
+
+template <typename Base>
+inline std::size_t VisitJournal<Base>::collect(
+    VisitableHandleVector<Base> & handles, JournalOrder order
+)
+{
+    this->gather();
+
+    // Stable: the recorded order within the groups of a tag
+    if(order == JournalOrder::ByTag)
+    {
+        for(Entry & entry : m_gathered) entry.order = entry.tag;
+    }
+
+    return this->sortTo(handles);
+}
+
+template <typename Base>
+template <typename Depth>
+inline std::size_t VisitJournal<Base>::collectByDepth(
+    VisitableHandleVector<Base> & handles, Depth depth
+)
+{
+    this->gather();
+
+    for(Entry & entry : m_gathered)
+    {
+        entry.order = static_cast<std::size_t>(depth(*entry.visitable));
+    }
+
+    return this->sortTo(handles);
+}
+
+template <typename Base>
+template <typename Visitor, typename ...Params>
+inline std::size_t VisitJournal<Base>::visit(Visitor & visitor, Params const & ...params)
+{
+    std::size_t const count = this->collect(m_handles);
+
+    for(VisitableHandle<Base> const & handle : m_handles) visitor(handle, params...);
+
+    return count;
+}
+
+template <typename Base>
+inline std::size_t VisitJournal<Base>::size() const
+{
+    std::size_t size = 0u;
+
+    for(ThreadBuffer * buffer = m_buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next)
+    {
+        size += buffer->entries.size();
+    }
+
+    return size;
+}
+
+template <typename Base>
+inline void VisitJournal<Base>::clear()
+{
+    for(ThreadBuffer * buffer = m_buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next)
+    {
+        buffer->entries.clear();
+    }
+}
+
+template <typename Base>
+inline typename VisitJournal<Base>::ThreadBuffer & VisitJournal<Base>::localBuffer()
+{
+    std::vector<LocalBuffer> & locals = LocalBuffers();
+
+    // Most threads record in one or two journals
+    for(std::size_t i = locals.size(); i-- > 0u;)
+    {
+        if(locals[i].journal == m_id) return *locals[i].buffer;
+    }
+
+    ThreadBuffer * const buffer = new ThreadBuffer();
+    buffer->next = m_buffers.load(std::memory_order_relaxed);
+
+    while(!m_buffers.compare_exchange_weak(
+        buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed
+    ));
+
+    locals.push_back(LocalBuffer{m_id, buffer});
+
+    return *buffer;
+}
+
+template <typename Base>
+inline void VisitJournal<Base>::gather()
+{
+    m_gathered.clear();
+
+    for(ThreadBuffer * buffer = m_buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next)
+    {
+        m_gathered.insert(m_gathered.end(), buffer->entries.begin(), buffer->entries.end());
+        buffer->entries.clear();
+    }
+
+    for(std::size_t i = 0; i < m_gathered.size(); ++i)
+    {
+        m_gathered[i].order = i;
+        m_gathered[i].sequence = i;
+    }
+
+    // Keep the first record of each visitable
+    std::sort(m_gathered.begin(), m_gathered.end(), [](Entry const & a, Entry const & b)
+    {
+        return a.visitable != b.visitable ?
+            std::less<Base *>()(a.visitable, b.visitable) : a.sequence < b.sequence;
+    });
+
+    m_gathered.erase(
+        std::unique(m_gathered.begin(), m_gathered.end(), [](Entry const & a, Entry const & b)
+        {
+            return a.visitable == b.visitable;
+        }),
+        m_gathered.end()
+    );
+}
+
+template <typename Base>
+inline std::size_t VisitJournal<Base>::sortTo(VisitableHandleVector<Base> & handles)
+{
+    std::sort(m_gathered.begin(), m_gathered.end(), [](Entry const & a, Entry const & b)
+    {
+        return a.order != b.order ? a.order < b.order : a.sequence < b.sequence;
+    });
+
+    handles.clear();
+    handles.reserve(m_gathered.size());
+
+    for(Entry const & entry : m_gathered) handles.emplace_back(entry.visitable, entry.tag);
+
+    return handles.size();
+}
+
+template <typename Base>
+inline std::vector<typename VisitJournal<Base>::LocalBuffer> & VisitJournal<Base>::LocalBuffers()
+{
+    static thread_local std::vector<LocalBuffer> buffers;
+    return buffers;
+}
+
+#endif //VISIT_JOURNAL_INL
@@ -0,0 +1,388 @@
+#ifndef VISIT_TASK_HPP
+#define VISIT_TASK_HPP
+
+#if __cplusplus < 202002L || !defined(__cpp_impl_coroutine)
+    #error "VisitTask.hpp requires C++20 coroutines (CMake option VISITOR_CXX20)"
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "VisitorDetails.hpp"
+
+template <typename R>
+class Task;
+
+namespace visitor_details {
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Per-thread cache of coroutine frames.
+///
+/// The frames are cached by size class, so the frames of the visits started by
+/// a pipeline are recycled instead of being allocated for each visit. A frame
+/// can be freed by another thread: it goes to the cache of that thread.
+////////////////////////////////////////////////////////////////////////////////
+class CoroutineFramePool
+{
+    public:
+        static void * Allocate(std::size_t size);
+        static void Deallocate(void * frame, std::size_t size);
+
+    private:
+        static constexpr std::size_t Granularity = 64u;    ///< Size classes step
+        static constexpr std::size_t ClassCount = 16u;     ///< Frames up to 1 KiB
+        static constexpr std::size_t MaxCachedFrames = 64u; ///< Per size class
+
+        //! Free frame (linked in the cache)
+        struct FreeFrame
+        {
+            FreeFrame * next;
+        };
+
+        //! Free frames of a thread
+        struct Cache
+        {
+            FreeFrame * frames[ClassCount] = { };
+            std::size_t counts[ClassCount] = { };
+
+            ~Cache();
+        };
+
+        static Cache & LocalCache();
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Common part of the promises of the tasks: lazy start, frames from the
+/// CoroutineFramePool and continuation resumed on completion.
+////////////////////////////////////////////////////////////////////////////////
+class TaskPromiseBase
+{
+    public:
+        //! Resume the continuation (symmetric transfer)
+        struct FinalAwaiter
+        {
+            bool await_ready() const noexcept { return false; }
+
+            template <typename Promise>
+            std::coroutine_handle<> await_suspend(
+                std::coroutine_handle<Promise> coroutine
+            ) noexcept;
+
+            void await_resume() const noexcept { }
+        };
+
+        static void * operator new(std::size_t size);
+        static void operator delete(void * frame, std::size_t size);
+
+        std::suspend_always initial_suspend() const noexcept { return { }; }
+        FinalAwaiter final_suspend() const noexcept { return { }; }
+
+        void unhandled_exception() { m_exception = std::current_exception(); }
+
+        //! Coroutine resumed when the task completes
+        void setContinuation(std::coroutine_handle<> continuation) { m_continuation = continuation; }
+
+    protected:
+        //! Rethrow the exception of the task, if any
+        void rethrow() const;
+
+    protected:
+        std::coroutine_handle<> m_continuation; ///< Awaiting coroutine
+        std::exception_ptr m_exception;         ///< Exception of the task
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Promise of a Task<R>.
+////////////////////////////////////////////////////////////////////////////////
+template <typename R>
+class TaskPromise : public TaskPromiseBase
+{
+    public:
+        Task<R> get_return_object();
+
+        template <typename Value>
+        void return_value(Value && value) { m_value.emplace(std::forward<Value>(value)); }
+
+        //! Move the result out (or rethrow the exception of the task)
+        R result();
+
+    private:
+        std::optional<R> m_value; ///< Result of the task
+};
+
+template <>
+class TaskPromise<void> : public TaskPromiseBase
+{
+    public:
+        Task<void> get_return_object();
+
+        void return_void() { }
+
+        //! Rethrow the exception of the task, if any
+        void result() { this->rethrow(); }
+};
+
+//! Result type of a task (T for Task<T>)
+template <typename TaskType>
+struct TaskResult;
+
+template <typename R>
+struct TaskResult<Task<R>>
+{
+    using Type = R;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Coroutine started and destroyed by its owner, which is notified of
+/// its completion: the visits of a pipeline and the waiter of SyncWait.
+////////////////////////////////////////////////////////////////////////////////
+class DetachedTask
+{
+    public:
+        class promise_type : public TaskPromiseBase
+        {
+            public:
+                //! Notify the owner (and resume the coroutine returned)
+                struct NotifyAwaiter
+                {
+                    bool await_ready() const noexcept { return false; }
+
+                    std::coroutine_handle<> await_suspend(
+                        std::coroutine_handle<promise_type> coroutine
+                    ) noexcept;
+
+                    void await_resume() const noexcept { }
+                };
+
+                DetachedTask get_return_object();
+
+                NotifyAwaiter final_suspend() const noexcept { return { }; }
+
+                void return_void() { }
+
+                //! Exception of the coroutine, if any
+                std::exception_ptr exception() const { return m_exception; }
+
+                //! Called on completion, returns the coroutine to resume
+                std::coroutine_handle<> (*notify)(void * context) = nullptr;
+                void * context = nullptr; ///< Context of notify
+        };
+
+        using Handle = std::coroutine_handle<promise_type>;
+
+        explicit DetachedTask(Handle coroutine): m_coroutine(coroutine) { }
+
+        //! Coroutine (owned by the caller)
+        Handle release() const { return m_coroutine; }
+
+    private:
+        Handle m_coroutine; ///< Coroutine
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Visits in flight of a pipeline and queue of their completions.
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+class PipelineState
+{
+    public:
+        //! Progress of a visit
+        enum Status { Starting, Running, Completed };
+
+        //! Slot of a visit in flight (T is the StoredResult of the visits)
+        struct Slot
+        {
+            PipelineState * state;                   ///< Owner
+            std::size_t id;                          ///< Index of the slot
+            std::size_t index;                       ///< Index of the visitable
+            DetachedTask::Handle coroutine;          ///< Visit
+            std::optional<T> value;                  ///< Result of the visit
+            std::atomic<int> status;                 ///< Status of the visit
+        };
+
+        //! Wait for the next completed visit
+        struct CompletionAwaiter
+        {
+            PipelineState & state;
+
+            bool await_ready() const noexcept { return false; }
+            bool await_suspend(std::coroutine_handle<> coroutine);
+            Slot & await_resume();
+        };
+
+        explicit PipelineState(std::size_t maxInFlight);
+
+        //! Take a free slot (there must be one)
+        Slot & acquire();
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Start the visit of a slot.
+        /// \return True if the visit has completed before start returns: it is
+        /// then not queued, so the synchronous visits do not take the lock.
+        ////////////////////////////////////////////////////////////////////////
+        bool start(Slot & slot);
+
+        //! Give a slot back once its visit has been handled
+        void release(Slot & slot);
+
+        //! Suspend the pipeline until a visit completes
+        CompletionAwaiter nextCompletion() { return CompletionAwaiter{*this}; }
+
+        //! Queue a completed slot, return the pipeline if it was waiting
+        static std::coroutine_handle<> Complete(void * slot);
+
+    private:
+        std::vector<Slot> m_slots;            ///< Slots of the visits
+        std::vector<std::size_t> m_free;      ///< Free slots
+
+        std::mutex m_mutex;                   ///< Protect the completions
+        std::deque<std::size_t> m_completed;  ///< Completed slots
+        std::coroutine_handle<> m_waiting;    ///< Pipeline waiting for them
+};
+
+//! Type storing the result of a Task<T> (a completion flag for Task<void>)
+template <typename T>
+using StoredResult = typename std::conditional<std::is_void<T>::value, bool, T>::type;
+
+//! Run a task and store its result
+template <typename T>
+DetachedTask RunTask(Task<T> task, std::optional<T> & value);
+
+inline DetachedTask RunTask(Task<void> task, std::optional<bool> & value);
+
+//! Event signaled by the waiter of SyncWait
+struct SyncWaitEvent
+{
+    std::mutex mutex;
+    std::condition_variable signal;
+    bool done = false;
+
+    static std::coroutine_handle<> Notify(void * event);
+};
+
+} // visitor_details
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Coroutine task returned by asynchronous visit methods:
+/// Visitor<Base, Task<R>, Args...>.
+///
+/// A task is lazy: it starts when it is awaited (co_await, SyncWait or a
+/// PipelinedVisit), and resumes its awaiting coroutine on completion. The
+/// frames of the tasks are recycled per thread (see CoroutineFramePool).
+/// \code
+///     class Loader : public Visitor<Shape, Task<std::size_t>>
+///     {
+///         public:
+///             META_Visitor(Loader, load)
+///
+///             Task<std::size_t> load(Shape & shape) { co_return 0u; }
+///
+///             Task<std::size_t> load(Polygon & polygon)
+///             {
+///                 Mesh mesh = co_await m_io.read(polygon.path());
+///                 co_return mesh.size();
+///             }
+///     };
+/// \endcode
+/// The parameters of the visit methods are copied in the coroutine frame:
+/// parameters passed by reference must outlive the task.
+////////////////////////////////////////////////////////////////////////////////
+template <typename R = void>
+class Task
+{
+    public:
+        using promise_type = visitor_details::TaskPromise<R>;
+        using Handle       = std::coroutine_handle<promise_type>;
+
+        //! Awaiter of a task: start it and resume the awaiting coroutine on
+        //! completion
+        struct Awaiter
+        {
+            Handle coroutine;
+
+            bool await_ready() const noexcept { return !coroutine || coroutine.done(); }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                coroutine.promise().setContinuation(awaiting);
+                return coroutine;
+            }
+
+            R await_resume() { return coroutine.promise().result(); }
+        };
+
+        Task() noexcept;
+        explicit Task(Handle coroutine) noexcept;
+        Task(Task && other) noexcept;
+        Task & operator=(Task && other) noexcept;
+        ~Task();
+
+        Task(Task const &) = delete;
+        Task & operator=(Task const &) = delete;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Tell whether the task has completed.
+        ////////////////////////////////////////////////////////////////////////
+        bool ready() const noexcept;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Await the task (its result is moved out: a task is awaited
+        /// once).
+        ////////////////////////////////////////////////////////////////////////
+        Awaiter operator co_await() const noexcept { return Awaiter{m_coroutine}; }
+
+    private:
+        Handle m_coroutine; ///< Coroutine of the task
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Visit a range with an asynchronous visitor, keeping up to
+/// maxInFlight visits in flight.
+///
+/// A visit is started as soon as a slot is free, and onResult is called as the
+/// visits complete (in their completion order): onResult(index, result), or
+/// onResult(index) for Task<void>, where index is the position of the
+/// visitable in the range. The pipeline is resumed by the coroutines
+/// completing the visits, possibly on other threads: the visitor and onResult
+/// are only used by one thread at a time.
+/// If a visit (or onResult) throws, even synchronously before returning its
+/// task, no new visit is started, the results of the visits in flight are
+/// dropped and the first exception is rethrown once they have completed.
+/// \param visitor     Visitor returning Task<R>.
+/// \param first       Beginning of the range (references, pointers or handles).
+/// \param last        End of the range.
+/// \param maxInFlight Maximum number of visits in flight (at least 1).
+/// \param onResult    Handler of the results.
+/// \param params      Parameters (copied in the pipeline) passed to every visit.
+/// \return A task returning the number of visits completed without exception.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Visitor, typename InputIt, typename OnResult, typename ...Params>
+Task<std::size_t> PipelinedVisit(
+    Visitor & visitor,
+    InputIt first, InputIt last,
+    std::size_t maxInFlight,
+    OnResult onResult,
+    Params ...params
+);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Run a task and block the calling thread until it completes.
+/// \return The result of the task (its exception is rethrown).
+////////////////////////////////////////////////////////////////////////////////
+template <typename R>
+R SyncWait(Task<R> task);
+
+
+#include "VisitTask.inl"
+
+#endif //VISIT_TASK_HPP
@@ -0,0 +1,454 @@
+#ifndef VISIT_TASK_INL
+#define VISIT_TASK_INL
+
+#include "VisitTask.hpp"
+
+#include <cassert>
+#include <new>
+#include <utility>
+
+namespace visitor_details {
+
+/// CoroutineFramePool ///
+
+inline void * CoroutineFramePool::Allocate(std::size_t size)
+{
+    std::size_t const sizeClass = (size + Granularity - 1u) / Granularity - 1u;
+
+    if(sizeClass >= ClassCount) return ::operator new(size);
+
+    Cache & cache = LocalCache();
+
+    if(FreeFrame * const frame = cache.frames[sizeClass])
+    {
+        cache.frames[sizeClass] = frame->next;
+        --cache.counts[sizeClass];
+
+        return frame;
+    }
+
+    return ::operator new((sizeClass + 1u) * Granularity);
+}
+
+inline void CoroutineFramePool::Deallocate(void * frame, std::size_t size)
+{
+    std::size_t const sizeClass = (size + Granularity - 1u) / Granularity - 1u;
+
+    if(sizeClass >= ClassCount)
+    {
+        ::operator delete(frame);
+        return;
+    }
+
+    Cache & cache = LocalCache();
+
+    if(cache.counts[sizeClass] == MaxCachedFrames)
+    {
+        ::operator delete(frame);
+        return;
+    }
+
+    FreeFrame * const freeFrame = ::new (frame) FreeFrame;
+    freeFrame->next = cache.frames[sizeClass];
+
+    cache.frames[sizeClass] = freeFrame;
+    ++cache.counts[sizeClass];
+}
+
+inline CoroutineFramePool::Cache::~Cache()
+{
+    for(FreeFrame * frame : frames)
+    {
+        while(frame)
+        {
+            FreeFrame * const next = frame->next;
+            ::operator delete(frame);
+            frame = next;
+        }
+    }
+}
+
+inline CoroutineFramePool::Cache & CoroutineFramePool::LocalCache()
+{
+    static thread_local Cache cache;
+    return cache;
+}
+
+
+/// TaskPromiseBase ///
+
+template <typename Promise>
+inline std::coroutine_handle<> TaskPromiseBase::FinalAwaiter::await_suspend(
+    std::coroutine_handle<Promise> coroutine
+) noexcept
+{
+    std::coroutine_handle<> const continuation = coroutine.promise().m_continuation;
+
+    return continuation ? continuation : std::noop_coroutine();
+}
+
+inline void * TaskPromiseBase::operator new(std::size_t size)
+{
+    return CoroutineFramePool::Allocate(size);
+}
+
+inline void TaskPromiseBase::operator delete(void * frame, std::size_t size)
+{
+    CoroutineFramePool::Deallocate(frame, size);
+}
+
+inline void TaskPromiseBase::rethrow() const
+{
+    if(m_exception) std::rethrow_exception(m_exception);
+}
+
+
+/// TaskPromise ///
+
+template <typename R>
+inline Task<R> TaskPromise<R>::get_return_object()
+{
+    return Task<R>(Task<R>::Handle::from_promise(*this));
+}
+
+template <typename R>
+inline R TaskPromise<R>::result()
+{
+    this->rethrow();
+
+    return std::move(*m_value);
+}
+
+inline Task<void> TaskPromise<void>::get_return_object()
+{
+    return Task<void>(Task<void>::Handle::from_promise(*this));
+}
+
+
+/// DetachedTask ///
+
+inline std::coroutine_handle<> DetachedTask::promise_type::NotifyAwaiter::await_suspend(
+    std::coroutine_handle<promise_type> coroutine
+) noexcept
+{
+    promise_type & promise = coroutine.promise();
+
+    // The owner may destroy the coroutine as soon as it is notified
+    return promise.notify(promise.context);
+}
+
+inline DetachedTask DetachedTask::promise_type::get_return_object()
+{
+    return DetachedTask(Handle::from_promise(*this));
+}
+
+template <typename T>
+inline DetachedTask RunTask(Task<T> task, std::optional<T> & value)
+{
+    value.emplace(co_await task);
+}
+
+inline DetachedTask RunTask(Task<void> task, std::optional<bool> & value)
+{
+    co_await task;
+    value.emplace(true);
+}
+
+
+/// PipelineState ///
+
+template <typename T>
+inline PipelineState<T>::PipelineState(std::size_t maxInFlight):
+    m_slots(maxInFlight)
+{
+    m_free.reserve(maxInFlight);
+
+    for(std::size_t id = maxInFlight; id-- > 0u;)
+    {
+        m_slots[id].state = this;
+        m_slots[id].id = id;
+        m_free.push_back(id);
+    }
+}
+
+template <typename T>
+inline typename PipelineState<T>::Slot & PipelineState<T>::acquire()
+{
+    assert(!m_free.empty() && "No free slot");
+
+    Slot & slot = m_slots[m_free.back()];
+    m_free.pop_back();
+
+    return slot;
+}
+
+template <typename T>
+inline bool PipelineState<T>::start(Slot & slot)
+{
+    slot.status.store(Starting, std::memory_order_relaxed);
+    slot.coroutine.resume();
+
+    return slot.status.exchange(Running, std::memory_order_acq_rel) == Completed;
+}
+
+template <typename T>
+inline void PipelineState<T>::release(Slot & slot)
+{
+    slot.coroutine.destroy();
+    slot.coroutine = nullptr;
+    slot.value.reset();
+
+    m_free.push_back(slot.id);
+}
+
+template <typename T>
+inline std::coroutine_handle<> PipelineState<T>::Complete(void * context)
+{
+    Slot & slot = *static_cast<Slot *>(context);
+    PipelineState & state = *slot.state;
+
+    // Completed while starting: start reports it to the pipeline
+    if(slot.status.exchange(Completed, std::memory_order_acq_rel) == Starting)
+    {
+        return std::noop_coroutine();
+    }
+
+    std::lock_guard<std::mutex> lock(state.m_mutex);
+
+    state.m_completed.push_back(slot.id);
+
+    std::coroutine_handle<> const waiting = state.m_waiting;
+    state.m_waiting = nullptr;
+
+    return waiting ? waiting : std::noop_coroutine();
+}
+
+template <typename T>
+inline bool PipelineState<T>::CompletionAwaiter::await_suspend(
+    std::coroutine_handle<> coroutine
+)
+{
+    std::lock_guard<std::mutex> lock(state.m_mutex);
+
+    // Resumed by the next completion, unless there is one already
+    if(!state.m_completed.empty()) return false;
+
+    state.m_waiting = coroutine;
+    return true;
+}
+
+template <typename T>
+inline typename PipelineState<T>::Slot & PipelineState<T>::CompletionAwaiter::await_resume()
+{
+    std::lock_guard<std::mutex> lock(state.m_mutex);
+
+    Slot & slot = state.m_slots[state.m_completed.front()];
+    state.m_completed.pop_front();
+
+    return slot;
+}
+
+
+/// SyncWaitEvent ///
+
+inline std::coroutine_handle<> SyncWaitEvent::Notify(void * context)
+{
+    SyncWaitEvent & event = *static_cast<SyncWaitEvent *>(context);
+
+    // Signaled under the lock: the waiter destroys the event once woken up
+    std::lock_guard<std::mutex> lock(event.mutex);
+
+    event.done = true;
+    event.signal.notify_one();
+
+    return std::noop_coroutine();
+}
+
+
+//! Pass the result of a visit to the result handler
+template <typename T, typename OnResult>
+inline void HandleResult(OnResult & onResult, std::size_t index, std::optional<T> & value, std::false_type /* void */)
+{
+    onResult(index, std::move(*value));
+}
+
+template <typename OnResult>
+inline void HandleResult(OnResult & onResult, std::size_t index, std::optional<bool> &, std::true_type /* void */)
+{
+    onResult(index);
+}
+
+} // visitor_details
+
+
+/// Task ///
+
+template <typename R>
+inline Task<R>::Task() noexcept:
+    m_coroutine(nullptr)
+{
+
+}
+
+template <typename R>
+inline Task<R>::Task(Handle coroutine) noexcept:
+    m_coroutine(coroutine)
+{
+
+}
+
+template <typename R>
+inline Task<R>::Task(Task && other) noexcept:
+    m_coroutine(other.m_coroutine)
+{
+    other.m_coroutine = nullptr;
+}
+
+template <typename R>
+inline Task<R> & Task<R>::operator=(Task && other) noexcept
+{
+    if(this != &other)
+    {
+        if(m_coroutine) m_coroutine.destroy();
+
+        m_coroutine = other.m_coroutine;
+        other.m_coroutine = nullptr;
+    }
+
+    return *this;
+}
+
+template <typename R>
+inline Task<R>::~Task()
+{
+    if(m_coroutine) m_coroutine.destroy();
+}
+
+template <typename R>
+inline bool Task<R>::ready() const noexcept
+{
+    return m_coroutine && m_coroutine.done();
+}
+
+
+template <typename Visitor, typename InputIt, typename OnResult, typename ...Params>
+Task<std::size_t> PipelinedVisit(
+    Visitor & visitor,
+    InputIt first, InputIt last,
+    std::size_t maxInFlight,
+    OnResult onResult,
+    Params ...params
+)
+{
+    using Base = typename Visitor::BaseType;
+    using Result = typename visitor_details::TaskResult<typename Visitor::RType>::Type;
+    using State = visitor_details::PipelineState<visitor_details::StoredResult<Result>>;
+
+    assert(maxInFlight > 0u && "A pipeline needs at least one visit in flight");
+
+    State state(maxInFlight);
+
+    std::size_t index = 0u;
+    std::size_t inFlight = 0u;
+    std::size_t completed = 0u;
+    std::exception_ptr exception;
+
+    // Handle a completed visit and free its slot
+    auto const finish = [&](typename State::Slot & slot)
+    {
+        --inFlight;
+
+        if(std::exception_ptr const visitException = slot.coroutine.promise().exception())
+        {
+            if(!exception) exception = visitException;
+        }
+        else if(!exception)
+        {
+            try
+            {
+                visitor_details::HandleResult(
+                    onResult, slot.index, slot.value, std::is_void<Result>()
+                );
+                ++completed;
+            }
+            catch(...)
+            {
+                exception = std::current_exception();
+            }
+        }
+
+        state.release(slot);
+    };
+
+    for(;;)
+    {
+        // Fill the free slots
+        while(!exception && first != last && inFlight < maxInFlight)
+        {
+            typename State::Slot & slot = state.acquire();
+
+            try
+            {
+                slot.coroutine = visitor_details::RunTask(
+                    visitor(visitor_details::ToVisited<Base>(*first), params...), slot.value
+                ).release();
+            }
+            catch(...)
+            {
+                // The visitor threw before returning its task: stop as for a
+                // failed visit, once the visits in flight have completed (the
+                // slot is not given back, no visit is started anymore)
+                exception = std::current_exception();
+                break;
+            }
+
+            slot.index = index++;
+            slot.coroutine.promise().notify = &State::Complete;
+            slot.coroutine.promise().context = &slot;
+
+            ++first;
+            ++inFlight;
+
+            if(state.start(slot)) finish(slot);
+        }
+
+        if(inFlight == 0u) break;
+
+        finish(co_await state.nextCompletion());
+    }
+
+    if(exception) std::rethrow_exception(exception);
+
+    co_return completed;
+}
+
+template <typename R>
+R SyncWait(Task<R> task)
+{
+    using Stored = visitor_details::StoredResult<R>;
+
+    visitor_details::SyncWaitEvent event;
+    std::optional<Stored> value;
+
+    visitor_details::DetachedTask::Handle const waiter =
+        visitor_details::RunTask(std::move(task), value).release();
+
+    waiter.promise().notify = &visitor_details::SyncWaitEvent::Notify;
+    waiter.promise().context = &event;
+
+    waiter.resume();
+
+    {
+        std::unique_lock<std::mutex> lock(event.mutex);
+        event.signal.wait(lock, [&event]() { return event.done; });
+    }
+
+    std::exception_ptr const exception = waiter.promise().exception();
+    waiter.destroy();
+
+    if(exception) std::rethrow_exception(exception);
+
+    if constexpr(!std::is_void<R>::value) return std::move(*value);
+}
+
+#endif //VISIT_TASK_INL
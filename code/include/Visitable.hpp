@@ -31,22 +31,31 @@ struct Visitable
 };
 
 /// \brief Macro helper defining a virtual function in every Visitable class
-/// to return its invocation info.
-/// This function allows to fallback falling through the type hierarchy
-/// (recursively) to find the nearest base class conversion.
+/// to return its tag and recording its fallback class.
+/// The fallback class is used when the hierarchy registers the tags: the
+/// visitors then resolve the nearest base class conversion of every visitable
+/// when building their vtable, not during the dispatch.
+/// The classes of an intrusive hierarchy must use META_IntrusiveVisitable
+/// instead (they would keep the tag of their parent): it does not compile.
 /// \param VisitableImpl     Type of the visitable class.
 /// \param VisitableFallback Ancestor visitable class to use as fallback.
 #define META_Visitable(VisitableImpl, VisitableFallback) \
-    virtual visitor_details::InvocationInfo visitable_invocation_info( \
-        std::vector<bool> const & statusTable \
-    ) \
+    _META_VISITABLE_(VisitableImpl, VisitableFallback, false)
+
+/// \brief Implementation of META_Visitable and META_IntrusiveVisitable,
+/// checking that the macros match the hierarchy.
+#define _META_VISITABLE_(VisitableImpl, VisitableFallback, Intrusive) \
+    using VisitableFallbackType = VisitableFallback; \
+    \
+    virtual std::size_t visitable_tag() const \
     { \
-        std::size_t tag = this->getTagHelper(this); \
-        if(tag < statusTable.size() && statusTable[tag]) \
-        { \
-            return visitor_details::InvocationInfo(tag, this); \
-        } \
-        return VisitableFallback::visitable_invocation_info(statusTable); \
+        static_assert( \
+            visitor_details::IsIntrusiveVisitable<VisitableImpl>::value == Intrusive, \
+            "The classes of an intrusive hierarchy must use META_IntrusiveVisitable" \
+            " (and only them)" \
+        ); \
+        \
+        return this->getTagHelper(this); \
     }
 
 
@@ -55,6 +64,26 @@ struct Visitable
     META_Visitable(VisitableImpl, VisitableImpl)
 
 
+/// \brief Macro helper giving a stable tag to a visitable class: unlike its
+/// runtime tag, the stable tag does not depend on the initialization order, so
+/// it can be persisted or shared between processes (see RecordVisitor).
+/// Two visitables of a hierarchy with the same stable tag abort the program
+/// when they are registered.
+/// \param IdOrName Non-zero id, or name hashed at compile time (e.g. the
+///                 qualified name of the class). The stable tag 0 means no
+///                 stable tag: it is rejected at compile time.
+#define META_StableTag(IdOrName) \
+    static constexpr std::uint64_t visitable_stable_tag() \
+    { \
+        static_assert( \
+            visitor_details::MakeStableTag(IdOrName) != 0u, \
+            "The stable tag 0 is reserved for the visitables without stable tag" \
+        ); \
+        \
+        return visitor_details::MakeStableTag(IdOrName); \
+    }
+
+
 #include "Visitable.inl"
 
 #endif //VISITABLE_HPP
@@ -0,0 +1,198 @@
+#ifndef VISITABLE_COLLECTION_HPP
+#define VISITABLE_COLLECTION_HPP
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "VisitorDetails.hpp"
+
+namespace visitor_details {
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Segment of a VisitableCollection: contiguous visitables of a single
+/// type, seen through their base class.
+///
+/// The base class subobjects are found from the first one and the size of the
+/// visitables, so the visitation loops do not call any virtual function.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base>
+class CollectionSegment
+{
+    public:
+        virtual ~CollectionSegment() { }
+
+        //! Number of visitables
+        std::size_t size() const { return m_size; }
+
+        //! Visitable at the given index
+        Base & visitable(std::size_t i)
+        {
+            return *reinterpret_cast<Base *>(
+                reinterpret_cast<unsigned char *>(m_first) + i * m_stride
+            );
+        }
+
+        //! Visitable at the given index
+        Base const & visitable(std::size_t i) const
+        {
+            return *reinterpret_cast<Base const *>(
+                reinterpret_cast<unsigned char const *>(m_first) + i * m_stride
+            );
+        }
+
+        //! Destroy every visitable
+        virtual void clear() = 0;
+
+    protected:
+        explicit CollectionSegment(std::size_t stride):
+            m_first(nullptr), m_stride(stride), m_size(0u)
+        {
+
+        }
+
+    protected:
+        Base * m_first;       ///< Base subobject of the first visitable
+        std::size_t m_stride; ///< Size of the visitables
+        std::size_t m_size;   ///< Number of visitables
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Segment storing the visitables of type Visitable.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base, typename Visitable>
+class TypedCollectionSegment : public CollectionSegment<Base>
+{
+    public:
+        TypedCollectionSegment():
+            CollectionSegment<Base>(sizeof(Visitable))
+        {
+
+        }
+
+        template <typename ...Params>
+        Visitable & emplace(Params && ...params)
+        {
+            m_visitables.emplace_back(std::forward<Params>(params)...);
+            this->update();
+
+            return m_visitables.back();
+        }
+
+        void reserve(std::size_t capacity)
+        {
+            m_visitables.reserve(capacity);
+            this->update();
+        }
+
+        virtual void clear()
+        {
+            m_visitables.clear();
+            this->update();
+        }
+
+    private:
+        //! Update the view of the base class after a change of the storage
+        void update()
+        {
+            this->m_first = m_visitables.empty() ?
+                nullptr : static_cast<Base *>(m_visitables.data());
+            this->m_size = m_visitables.size();
+        }
+
+    private:
+        std::vector<Visitable> m_visitables; ///< Visitables
+};
+
+} // visitor_details
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Container of visitables storing each visitable type in its own
+/// contiguous segment, keyed by the tag of the type.
+///
+/// Visiting the collection (Visitor::visitCollection) resolves the thunk once
+/// per segment and then walks densely packed visitables, instead of chasing a
+/// pointer and reading the tag of every visitable:
+/// \code
+///     VisitableCollection<Shape> shapes;
+///     shapes.emplace<Circle>(1.f);
+///     shapes.insert(Polygon());
+///
+///     visitor.visitCollection(shapes, args);
+/// \endcode
+/// The visitables are owned by the collection and stored by value, so their
+/// type must be movable and must be its exact dynamic type (its class must
+/// declare META_Visitable). Inserting into a segment may move its visitables
+/// (as a std::vector): references into a segment are invalidated.
+/// The visitables are visited segment by segment, in tag order.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base>
+class VisitableCollection
+{
+    public:
+        using Segment = visitor_details::CollectionSegment<Base>;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Construct a visitable at the end of its segment.
+        /// \return The new visitable.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Visitable, typename ...Params>
+        Visitable & emplace(Params && ...params);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Copy or move a visitable at the end of its segment.
+        /// \return The new visitable.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Visitable>
+        typename std::decay<Visitable>::type & insert(Visitable && visitable);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Reserve the storage of the segment of Visitable.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Visitable>
+        void reserve(std::size_t capacity);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the number of visitables.
+        ////////////////////////////////////////////////////////////////////////
+        std::size_t size() const;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return whether the collection is empty.
+        ////////////////////////////////////////////////////////////////////////
+        bool empty() const;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Destroy every visitable (the segments are kept).
+        ////////////////////////////////////////////////////////////////////////
+        void clear();
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the number of segment slots (greatest tag + 1).
+        ////////////////////////////////////////////////////////////////////////
+        std::size_t segmentCount() const;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the segment of the visitables with the given tag
+        /// (null if no such visitable has been inserted).
+        ////////////////////////////////////////////////////////////////////////
+        Segment * segment(std::size_t tag);
+        Segment const * segment(std::size_t tag) const;
+
+    private:
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the segment of Visitable (created if needed).
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Visitable>
+        visitor_details::TypedCollectionSegment<Base, Visitable> & typedSegment();
+
+    private:
+        std::vector<std::unique_ptr<Segment>> m_segments; ///< Segments by tag
+};
+
+
+#include "VisitableCollection.inl"
+
+#endif //VISITABLE_COLLECTION_HPP
@@ -0,0 +1,109 @@
+#ifndef VISITABLE_COLLECTION_INL
+#define VISITABLE_COLLECTION_INL
+
+#include "VisitableCollection.hpp"
+
+#include <cassert>
+#include <utility>
+
+template <typename Base>
+template <typename Visitable, typename ...Params>
+inline Visitable & VisitableCollection<Base>::emplace(Params && ...params)
+{
+    Visitable & visitable =
+        this->typedSegment<Visitable>().emplace(std::forward<Params>(params)...);
+
+    assert(visitor_details::GetDispatchTag(static_cast<Base &>(visitable))
+        == (visitor_details::GetVisitableTag<Visitable, Base>())
+        && "The visitable class must declare META_Visitable");
+
+    return visitable;
+}
+
+template <typename Base>
+template <typename Visitable>
+inline typename std::decay<Visitable>::type &
+VisitableCollection<Base>::insert(Visitable && visitable)
+{
+    return this->emplace<typename std::decay<Visitable>::type>(
+        std::forward<Visitable>(visitable)
+    );
+}
+
+template <typename Base>
+template <typename Visitable>
+inline void VisitableCollection<Base>::reserve(std::size_t capacity)
+{
+    this->typedSegment<Visitable>().reserve(capacity);
+}
+
+template <typename Base>
+inline std::size_t VisitableCollection<Base>::size() const
+{
+    std::size_t size = 0u;
+
+    for(std::unique_ptr<Segment> const & segment : m_segments)
+    {
+        if(segment) size += segment->size();
+    }
+
+    return size;
+}
+
+template <typename Base>
+inline bool VisitableCollection<Base>::empty() const
+{
+    return this->size() == 0u;
+}
+
+template <typename Base>
+inline void VisitableCollection<Base>::clear()
+{
+    for(std::unique_ptr<Segment> & segment : m_segments)
+    {
+        if(segment) segment->clear();
+    }
+}
+
+template <typename Base>
+inline std::size_t VisitableCollection<Base>::segmentCount() const
+{
+    return m_segments.size();
+}
+
+template <typename Base>
+inline typename VisitableCollection<Base>::Segment *
+VisitableCollection<Base>::segment(std::size_t tag)
+{
+    return m_segments[tag].get();
+}
+
+template <typename Base>
+inline typename VisitableCollection<Base>::Segment const *
+VisitableCollection<Base>::segment(std::size_t tag) const
+{
+    return m_segments[tag].get();
+}
+
+template <typename Base>
+template <typename Visitable>
+inline visitor_details::TypedCollectionSegment<Base, Visitable> &
+VisitableCollection<Base>::typedSegment()
+{
+    static_assert(
+        std::is_base_of<Base, Visitable>::value,
+        "Visitable must derive from the base class of the collection"
+    );
+
+    using TypedSegment = visitor_details::TypedCollectionSegment<Base, Visitable>;
+
+    std::size_t const tag = visitor_details::GetVisitableTag<Visitable, Base>();
+
+    if(tag >= m_segments.size()) m_segments.resize(tag + 1);
+
+    if(!m_segments[tag]) m_segments[tag].reset(new TypedSegment());
+
+    return static_cast<TypedSegment &>(*m_segments[tag]);
+}
+
+#endif //VISITABLE_COLLECTION_INL
@@ -0,0 +1,143 @@
+#ifndef VISITABLE_HANDLE_HPP
+#define VISITABLE_HANDLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "VisitorDetails.hpp"
+
+//! Pack the tag of the handles into the unused high bits of the pointer (1) or
+/// store it in a 16-bit field next to the pointer (0, default). Packing is only
+/// valid where every address of a visitable fits in 48 bits: not with 5-level
+/// paging, tagged pointers or some allocators, so it must be enabled explicitly
+/// (see the CMake option VISITOR_PACKED_HANDLES).
+#ifndef META_VISITABLE_HANDLE_PACKED
+    #define META_VISITABLE_HANDLE_PACKED 0
+#endif
+
+#if META_VISITABLE_HANDLE_PACKED && !(defined(__x86_64__) || defined(_M_X64) \
+    || defined(__aarch64__) || defined(_M_ARM64))
+    #error "META_VISITABLE_HANDLE_PACKED requires a 64-bit x86 or ARM platform"
+#endif
+
+namespace visitor_details {
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Storage of a pointer and of a 16-bit tag.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base, bool Packed = (META_VISITABLE_HANDLE_PACKED != 0)>
+class HandleStorage
+{
+    public:
+        HandleStorage(Base * pointer, std::size_t tag);
+
+        Base * pointer() const { return m_pointer; }
+        std::size_t tag() const { return m_tag; }
+
+    private:
+        Base * m_pointer;    ///< Visitable
+        std::uint16_t m_tag; ///< Tag of the visitable
+};
+
+// Specialization storing the tag in the 16 high bits of the pointer
+template <typename Base>
+class HandleStorage<Base, true>
+{
+    public:
+        HandleStorage(Base * pointer, std::size_t tag);
+
+        Base * pointer() const;
+        std::size_t tag() const { return static_cast<std::size_t>(m_bits >> PointerBits); }
+
+    private:
+        static constexpr unsigned PointerBits = 48u;
+        static constexpr std::uintptr_t PointerMask =
+            (std::uintptr_t(1) << PointerBits) - 1u;
+
+        std::uintptr_t m_bits; ///< Tag (high bits) and pointer (low bits)
+};
+
+} // visitor_details
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Non-owning pointer to a visitable carrying the tag of the visitable.
+///
+/// The tag is read once when the handle is created. The visitors then resolve
+/// the thunk from the handle alone, and the batch and parallel visitations
+/// group the handles by type without touching the memory of the visitables:
+/// the visitable is only loaded by the visit method itself.
+/// \code
+///     VisitableHandleVector<Shape> shapes;
+///     shapes.emplace_back(&circle);
+///
+///     visitor(shapes[0], args);                            // Dispatch on the handle
+///     visitor.visitRange(shapes.begin(), shapes.end(), args); // Bucket on the handles
+/// \endcode
+///
+/// The tag is stored in a 16-bit field next to the pointer, or packed in the
+/// high bits of the pointer if META_VISITABLE_HANDLE_PACKED is defined to 1
+/// and the addresses fit in 48 bits, so a handle has the size of a pointer.
+/// In both cases, the hierarchy must have less than 65536 tags: creating a
+/// handle to a visitable with a larger tag aborts the program, in every build.
+/// A handle becomes stale if the visitable is destroyed, as a raw pointer.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base>
+class VisitableHandle
+{
+    public:
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Constructor of a null handle.
+        ////////////////////////////////////////////////////////////////////////
+        VisitableHandle();
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Constructor: read the tag of the visitable.
+        /// \param visitable Visitable (not null).
+        ////////////////////////////////////////////////////////////////////////
+        VisitableHandle(Base * visitable);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Constructor from a known tag: the visitable is not touched
+        /// (e.g. GetVisitableTag<Circle, Shape>() for a newly created Circle).
+        /// \param visitable Visitable (not null).
+        /// \param tag       Tag of the dynamic type of the visitable.
+        ////////////////////////////////////////////////////////////////////////
+        VisitableHandle(Base * visitable, std::size_t tag);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Conversion from a handle to a non-const visitable.
+        ////////////////////////////////////////////////////////////////////////
+        template <
+            typename Other,
+            typename = typename std::enable_if<
+                std::is_same<Other const, Base>::value && !std::is_same<Other, Base>::value
+            >::type
+        >
+        VisitableHandle(VisitableHandle<Other> const & other);
+
+        //! Visitable (null for a null handle)
+        Base * get() const { return m_storage.pointer(); }
+
+        //! Tag of the visitable
+        std::size_t tag() const { return m_storage.tag(); }
+
+        Base & operator*() const { return *this->get(); }
+        Base * operator->() const { return this->get(); }
+
+        explicit operator bool() const { return this->get() != nullptr; }
+
+    private:
+        visitor_details::HandleStorage<Base> m_storage; ///< Pointer and tag
+};
+
+//! Container of visitable handles
+template <typename Base>
+using VisitableHandleVector = std::vector<VisitableHandle<Base>>;
+
+
+#include "VisitableHandle.inl"
+
+#endif //VISITABLE_HANDLE_HPP
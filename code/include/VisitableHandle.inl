@@ -0,0 +1,88 @@
+#ifndef VISITABLE_HANDLE_INL
+#define VISITABLE_HANDLE_INL
+
+#include "VisitableHandle.hpp"
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+namespace visitor_details {
+
+//! Largest tag which can be stored in a handle
+static constexpr std::size_t MaxHandleTag = 0xFFFFu;
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Abort if the tag does not fit in a handle.
+/// A truncated tag would dispatch the visitable to the visit method of another
+/// class (in the visitors and in everything storing handles: fused visitors,
+/// journals, variants, channels), so the check is done in every build.
+////////////////////////////////////////////////////////////////////////////////
+inline void CheckHandleTag(std::size_t tag)
+{
+    if(tag > MaxHandleTag)
+    {
+        std::fprintf(stderr,
+            "Visitable tag %zu does not fit in a handle (at most %zu tags per hierarchy)\n",
+            tag, MaxHandleTag + 1u
+        );
+        std::abort();
+    }
+}
+
+template <typename Base, bool Packed>
+inline HandleStorage<Base, Packed>::HandleStorage(Base * pointer, std::size_t tag):
+    m_pointer(pointer), m_tag(static_cast<std::uint16_t>(tag))
+{
+    CheckHandleTag(tag);
+}
+
+template <typename Base>
+inline HandleStorage<Base, true>::HandleStorage(Base * pointer, std::size_t tag):
+    m_bits(reinterpret_cast<std::uintptr_t>(pointer)
+        | (static_cast<std::uintptr_t>(tag) << PointerBits))
+{
+    CheckHandleTag(tag);
+    assert((reinterpret_cast<std::uintptr_t>(pointer) & ~PointerMask) == 0u
+        && "Address does not fit in 48 bits (disable META_VISITABLE_HANDLE_PACKED)");
+}
+
+template <typename Base>
+inline Base * HandleStorage<Base, true>::pointer() const
+{
+    return reinterpret_cast<Base *>(m_bits & PointerMask);
+}
+
+} // visitor_details
+
+
+template <typename Base>
+inline VisitableHandle<Base>::VisitableHandle():
+    m_storage(nullptr, 0u)
+{
+
+}
+
+template <typename Base>
+inline VisitableHandle<Base>::VisitableHandle(Base * visitable):
+    m_storage(visitable, visitor_details::GetDispatchTag(*visitable))
+{
+
+}
+
+template <typename Base>
+inline VisitableHandle<Base>::VisitableHandle(Base * visitable, std::size_t tag):
+    m_storage(visitable, tag)
+{
+    assert(tag == visitor_details::GetDispatchTag(*visitable) && "Wrong visitable tag");
+}
+
+template <typename Base>
+template <typename Other, typename>
+inline VisitableHandle<Base>::VisitableHandle(VisitableHandle<Other> const & other):
+    m_storage(other.get(), other.tag())
+{
+
+}
+
+#endif //VISITABLE_HANDLE_INL
@@ -1,6 +1,7 @@
 #ifndef VISITOR_HPP
 #define VISITOR_HPP
 
+#include "VisitableHandle.hpp"
 #include "VisitorDetails.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -45,36 +46,219 @@
 ///     result = nv(meta, 9000.f);    // Call NodeVisitor::visit(Group &, float)
 ///
 /// \endcode
+///
+/// The extra arguments (Args) are passed by value when they are small and
+/// trivially copyable, by const reference otherwise, and as declared when they
+/// are references (see visitor_details::VisitorArgument).
+///
+/// The vtable can be overridden per instance (see overrideVisits) while other
+/// threads dispatch with the visitor. A replaced vtable is freed once every
+/// thread has left the dispatches which may use it (epoch-based reclamation):
+/// a dispatch blocked in a visit method only delays the reclamation.
 ////////////////////////////////////////////////////////////////////////////////
 template <typename Base, typename ReturnType = void, typename ...Args>
 class Visitor
 {
     public:
+        //! Type passing an extra argument through the dispatch: small
+        /// trivially copyable arguments by value, the others by const
+        /// reference (see visitor_details::VisitorArgument)
+        template <typename T>
+        using ArgumentType = visitor_details::VisitorArgumentType<T>;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Default constructor (the vtable is set by META_Visitables).
+        ////////////////////////////////////////////////////////////////////////
+        Visitor();
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Copy constructor: the overridden vtable of the visitor is
+        /// copied, so the copy does not depend on the lifetime of the visitor.
+        ////////////////////////////////////////////////////////////////////////
+        Visitor(Visitor const & other);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Copy assignment (see the copy constructor).
+        ////////////////////////////////////////////////////////////////////////
+        Visitor & operator=(Visitor const & other);
+
         ////////////////////////////////////////////////////////////////////////
         /// \brief Perform the visitation of the given visitable.
         /// Double dispatch is performed via a custom vtable.
         /// \param b Visitable to visit.
         /// \return The result of the visitation.
         ////////////////////////////////////////////////////////////////////////
-        ReturnType operator()(Base & b, Args && ...args);
+        ReturnType operator()(Base & b, ArgumentType<Args> ...args);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Perform the visitation of the visitable of a handle.
+        /// The thunk is resolved from the tag of the handle: only the visit
+        /// method touches the visitable.
+        /// \param handle Handle of the visitable to visit (not null).
+        /// \return The result of the visitation.
+        ////////////////////////////////////////////////////////////////////////
+        ReturnType operator()(
+            VisitableHandle<Base> const & handle, ArgumentType<Args> ...args
+        );
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Perform the visitation of a range of visitables.
+        /// The visitables are grouped by dynamic type before the dispatch so
+        /// each thunk is called in a tight loop over its visitables (the order
+        /// of the visitations is therefore not the order of the range).
+        /// The arguments are passed to every visitation: the visit methods
+        /// must not consume them.
+        /// \param first Beginning of the range (references, pointers or
+        ///              handles).
+        /// \param last  End of the range.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename InputIt>
+        void visitRange(InputIt first, InputIt last, ArgumentType<Args> ...args);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Perform the visitation of a range of visitables and write
+        /// the results in the original order (see visitRange).
+        /// \param first  Beginning of the range (references, pointers or
+        ///               handles).
+        /// \param last   End of the range.
+        /// \param result Beginning of the output range (random access).
+        /// \return The end of the output range.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename InputIt, typename OutputIt>
+        OutputIt transformRange(
+            InputIt first, InputIt last, OutputIt result, ArgumentType<Args> ...args
+        );
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Perform the visitation of a VisitableCollection.
+        /// The thunk is resolved once per segment, then called on every
+        /// visitable of the segment. The arguments are passed to every
+        /// visitation: the visit methods must not consume them.
+        /// \param collection Collection to visit (const for a const visitor).
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Collection>
+        void visitCollection(Collection & collection, ArgumentType<Args> ...args);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Perform the visitation of the given visitable, checking the
+        /// hot visitables first (see META_HotVisitables).
+        /// The visit methods of the hot visitables are called directly (and
+        /// can be inlined), the other visitables are dispatched by the vtable.
+        /// While the vtable is overridden (see overrideVisits), every
+        /// visitable is dispatched by the vtable, so the overrides apply to
+        /// the hot visitables too.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename VisitorImpl, typename Invoker, typename ...HotVisitables>
+        ReturnType visitHot(Base & b, ArgumentType<Args> ...args);
+
+        template <typename VisitorImpl, typename Invoker, typename ...HotVisitables>
+        ReturnType visitHot(
+            VisitableHandle<Base> const & handle, ArgumentType<Args> ...args
+        );
 
         ////////////////////////////////////////////////////////////////////////
         /// \brief Call the right function from the vtable by using a thunk.
         ////////////////////////////////////////////////////////////////////////
         template <typename VisitorImpl, typename Visitable, typename Invoker>
-        ReturnType thunk(Base & b, Args && ...args);
+        static ReturnType thunk(Visitor & visitor, Base & b, ArgumentType<Args> ...args);
 
     public:
         using BaseType   = Base;
-        using Thunk      = ReturnType (Visitor::*)(Base &, Args && ...);
+        using Thunk      = ReturnType (*)(Visitor &, Base &, ArgumentType<Args>...);
         using VTableType = visitor_details::VisitorVTable<Base const, Thunk>;
         using RType      = ReturnType;
 
+        //! Class used by META_Visitables to retrieve the vtable of a visitor
+        template <typename VisitorImpl, typename Invoker, typename ...VisitedList>
+        using VTableGetter =
+            visitor_details::GetVisitorVTable<VisitorImpl, Invoker, VisitedList...>;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Override the visit methods of the given visitables for this
+        /// visitor instance: they are called through the given invoker (see
+        /// META_VisitInvoker). The visitables falling back to an overridden
+        /// visitable are overridden too.
+        ///
+        /// The vtable is copied, modified, then published with an atomic swap:
+        /// other threads can keep dispatching with the visitor meanwhile. The
+        /// overrides must be changed from one thread at a time.
+        /// The hot visitables (see META_HotVisitables) are dispatched by the
+        /// vtable until resetVTable: their inline shortcut is disabled.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename VisitorImpl, typename Invoker, typename ...Visitables>
+        void overrideVisits();
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Override the thunk of the given visitable for this visitor
+        /// instance (see overrideVisits).
+        ////////////////////////////////////////////////////////////////////////
+        template <typename Visitable>
+        void overrideThunk(Thunk thunk);
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Remove every override: go back to the vtable set by
+        /// META_Visitables.
+        ////////////////////////////////////////////////////////////////////////
+        void resetVTable();
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Free the vtables replaced by the overrides which no dispatch
+        /// uses anymore.
+        /// A dispatch started before the swap may still use a replaced vtable,
+        /// so it is retired with the current epoch and freed once every thread
+        /// has left such dispatches (see visitor_details::VTableEpochs). The
+        /// overrides and resetVTable already reclaim the retired vtables: this
+        /// call only frees the ones retired since, and is safe at any time.
+        ////////////////////////////////////////////////////////////////////////
+        void reclaimVTables();
+
     private:
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Compare the tag with the hot visitables, then fall back to
+        /// the vtable.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename VisitorImpl, typename Invoker, typename Hot, typename ...Tail>
+        ReturnType dispatchHot(
+            visitor_details::ThunkTag<Hot, Tail...>,
+            std::size_t tag, Base & b, ArgumentType<Args> ...args
+        );
+
+        template <typename VisitorImpl, typename Invoker>
+        ReturnType dispatchHot(
+            visitor_details::ThunkTag<>,
+            std::size_t tag, Base & b, ArgumentType<Args> ...args
+        );
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the thunk of the tag in the published vtable.
+        /// The static vtables are never freed: only an overridden vtable is
+        /// read under an epoch guard.
+        ////////////////////////////////////////////////////////////////////////
+        Thunk getThunk(std::size_t tag) const;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the published vtable: it is only valid while the
+        /// caller holds an epoch guard (or changes the overrides).
+        ////////////////////////////////////////////////////////////////////////
+        VTableType const & vtable() const;
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Publish a copy of the current vtable with the given thunks.
+        ////////////////////////////////////////////////////////////////////////
+        void publishVTable(
+            std::size_t const * tags, Thunk const * thunks, std::size_t count
+        );
+
+    private:
+        using Overrides = visitor_details::VisitorVTableOverrides<VTableType>;
+
         template <typename VisitorImpl, typename Invoker, typename ...VisitedList>
         friend struct VisitorVTableSetter;
 
-        VTableType const * m_vtable; ///< Vtable pointer
+        std::atomic<VTableType const *> m_vtable;       ///< Vtable pointer
+        std::atomic<VTableType const *> m_staticVTable; ///< Vtable of META_Visitables
+        std::unique_ptr<Overrides> m_overrides;         ///< Tables of the overrides
+        std::atomic<bool> m_overridden;                 ///< Overridden vtable published
 };
 
 
@@ -86,14 +270,86 @@ class Visitor
 #define META_Visitor(/*Visitor [, VisitInvoker]*/...) \
     _SELECT_META_VISITOR_(__VA_ARGS__)
 
+//! Define an invoker calling the visit methods with the given name, used to
+/// override the visit methods of a visitor at runtime (see overrideVisits).
+/// Example:
+///  META_VisitInvoker(DebugDrawInvoker, debugDraw)
+///  visitor.overrideVisits<ShapeVisitor, DebugDrawInvoker, Circle>();
+#define META_VisitInvoker(Invoker, VisitInvoker) \
+    struct Invoker \
+    { \
+        _META_VISITOR_INVOKE_(VisitInvoker) \
+    };
+
 //! Must be called in each visitor constructor to build the virtual table of the visitor.
-/// The parameters are the class with are visitable by this visitor.
+/// The parameters are the class with are visitable by this visitor. The hot
+/// visitables of the visitor (see META_HotVisitables) are added to the list.
 #define META_Visitables(...) \
     VisitorVTableSetter< \
         visitor_invoker_details::VisitorType, \
         visitor_invoker_details::InvokerType, \
         __VA_ARGS__ \
-    >::SetVTable(*this)
+    >::SetVTable(*this, visitor_hot_details::Visitables())
+
+//! Hot visitables of the visitors without META_HotVisitables (found by
+/// META_Visitables when the visitor does not declare its own)
+struct visitor_hot_details
+{
+    using Visitables = visitor_details::ThunkTag<>;
+};
+
+//! Declare the vtable of a visitor (with the visitables listed in the same order
+/// as in META_Visitables) as instantiated in another translation unit, with
+/// META_InstantiateVisitorVTable: the vtable and the thunks of the visitor are
+/// not compiled in the translation units including this declaration. To be
+/// placed at global scope, after the visitor class.
+/// The hot visitables of the visitor (see META_HotVisitables) follow the list.
+/// Example:
+///  META_ExternVisitorVTable(ShapeVisitor, Circle, Polygon); // ShapeVisitor.hpp
+///  META_InstantiateVisitorVTable(ShapeVisitor, Circle, Polygon); // ShapeVisitor.cpp
+#define META_ExternVisitorVTable(VisitorImpl, ...) \
+    extern template struct visitor_details::GetVisitorVTable< \
+        VisitorImpl, \
+        VisitorImpl::visitor_invoker_details::InvokerType, \
+        __VA_ARGS__ \
+    >
+
+//! Instantiate the vtable of a visitor declared with META_ExternVisitorVTable
+/// (in a single translation unit).
+#define META_InstantiateVisitorVTable(VisitorImpl, ...) \
+    template struct visitor_details::GetVisitorVTable< \
+        VisitorImpl, \
+        VisitorImpl::visitor_invoker_details::InvokerType, \
+        __VA_ARGS__ \
+    >
+
+//! Can be placed in a visitor class (after META_Visitor) to list its hot
+/// visitables: the operator() of the visitor then compares the tag with the
+/// tags of these visitables first and calls their visit method directly, before
+/// falling back to the vtable. It pays off when a few types get most of the
+/// dispatches (see ExportHotVisitables to list them from a profile).
+/// The hot visitables are added to the vtable (after the visitables listed in
+/// META_Visitables): a hot visitable and its subclasses are visited as if it
+/// was listed in META_Visitables, the tag comparison is only a shortcut for the
+/// hot visitables themselves.
+/// Example:
+///  META_HotVisitables(Circle, Polygon)
+#define META_HotVisitables(...) \
+    struct visitor_hot_details \
+    { \
+        using Visitables = visitor_details::ThunkTag<__VA_ARGS__>; \
+    }; \
+    \
+    template <typename HotVisitable, typename ...HotArgs> \
+    typename visitor_invoker_details::VisitorType::RType \
+    operator()(HotVisitable && visitable, HotArgs && ...args) \
+    { \
+        return this->template visitHot< \
+            typename visitor_invoker_details::VisitorType, \
+            typename visitor_invoker_details::InvokerType, \
+            __VA_ARGS__ \
+        >(std::forward<HotVisitable>(visitable), std::forward<HotArgs>(args)...); \
+    }
 
 
 #include "Visitor.inl"
@@ -22,30 +22,358 @@ struct GetVisitMethodArgumentType<Visitable, Base const>
 
 
 template <typename Base, typename ReturnType, typename ...Args>
-inline ReturnType Visitor<Base, ReturnType, Args...>::operator()(Base & b, Args && ...args)
+inline Visitor<Base, ReturnType, Args...>::Visitor():
+    m_vtable(nullptr), m_staticVTable(nullptr), m_overridden(false)
 {
-    // Retrieve the invocation info of the Visitable
-    auto info = b.visitable_invocation_info(m_vtable->getStatusTable());
 
-    // Fetch thunk
-    Thunk thunk = (*m_vtable)[info.vtableIndex];
+}
 
-    // Pointer to member function syntax
-    return (this->*thunk)(*static_cast<Base *>(info.visitable), std::forward<Args>(args)...);
+template <typename Base, typename ReturnType, typename ...Args>
+inline Visitor<Base, ReturnType, Args...>::Visitor(Visitor const & other):
+    m_vtable(nullptr), m_staticVTable(nullptr), m_overridden(false)
+{
+    *this = other;
+}
+
+template <typename Base, typename ReturnType, typename ...Args>
+inline Visitor<Base, ReturnType, Args...> &
+Visitor<Base, ReturnType, Args...>::operator=(Visitor const & other)
+{
+    if(this == &other) return *this;
+
+    // The other visitor may replace its table meanwhile
+    visitor_details::VTableEpochs::Guard const guard;
+
+    VTableType const * const vtable = other.m_vtable.load(std::memory_order_seq_cst);
+    VTableType const * const staticVTable =
+        other.m_staticVTable.load(std::memory_order_relaxed);
+
+    m_staticVTable.store(staticVTable, std::memory_order_relaxed);
+    m_overridden.store(vtable != staticVTable, std::memory_order_relaxed);
+
+    if(vtable == staticVTable)
+    {
+        if(m_overrides) m_overrides->reset(m_vtable, staticVTable);
+        else m_vtable.store(vtable, std::memory_order_release);
+
+        return *this;
+    }
+
+    if(!m_overrides) m_overrides.reset(new Overrides());
+
+    // Copy the overridden table: it belongs to the other visitor
+    m_overrides->publish(
+        m_vtable, std::unique_ptr<VTableType>(new VTableType(*vtable, vtable->size()))
+    );
+
+    return *this;
+}
+
+template <typename Base, typename ReturnType, typename ...Args>
+inline ReturnType Visitor<Base, ReturnType, Args...>::operator()(
+    Base & b, ArgumentType<Args> ...args
+)
+{
+    std::size_t const tag = visitor_details::GetDispatchTag(b);
+
+#if META_VISITOR_INSTRUMENTATION
+    // The overridden copies keep the statistics id of the static vtable
+    visitor_details::DispatchProbe const probe(
+        m_staticVTable.load(std::memory_order_relaxed)->statsId(), tag
+    );
+#endif
+
+    // Fetch the thunk of the Visitable (fallback is resolved in the vtable)
+    Thunk thunk = this->getThunk(tag);
+
+    return thunk(*this, b, visitor_details::ForwardArgument<Args>(args)...);
+}
+
+template <typename Base, typename ReturnType, typename ...Args>
+inline ReturnType Visitor<Base, ReturnType, Args...>::operator()(
+    VisitableHandle<Base> const & handle, ArgumentType<Args> ...args
+)
+{
+#if META_VISITOR_INSTRUMENTATION
+    visitor_details::DispatchProbe const probe(
+        m_staticVTable.load(std::memory_order_relaxed)->statsId(), handle.tag()
+    );
+#endif
+
+    Thunk thunk = this->getThunk(handle.tag());
+
+    return thunk(*this, *handle, visitor_details::ForwardArgument<Args>(args)...);
+}
+
+template <typename Base, typename ReturnType, typename ...Args>
+template <typename VisitorImpl, typename Invoker, typename ...HotVisitables>
+inline ReturnType Visitor<Base, ReturnType, Args...>::visitHot(
+    Base & b, ArgumentType<Args> ...args
+)
+{
+    std::size_t const tag = visitor_details::GetDispatchTag(b);
+
+#if META_VISITOR_INSTRUMENTATION
+    visitor_details::DispatchProbe const probe(
+        m_staticVTable.load(std::memory_order_relaxed)->statsId(), tag
+    );
+#endif
+
+    // The overrides apply to the hot visitables: dispatch by the vtable
+    if(m_overridden.load(std::memory_order_relaxed))
+    {
+        return this->dispatchHot<VisitorImpl, Invoker>(
+            visitor_details::ThunkTag<>(),
+            tag, b, visitor_details::ForwardArgument<Args>(args)...
+        );
+    }
+
+    return this->dispatchHot<VisitorImpl, Invoker>(
+        visitor_details::ThunkTag<HotVisitables...>(),
+        tag, b, visitor_details::ForwardArgument<Args>(args)...
+    );
+}
+
+template <typename Base, typename ReturnType, typename ...Args>
+template <typename VisitorImpl, typename Invoker, typename ...HotVisitables>
+inline ReturnType Visitor<Base, ReturnType, Args...>::visitHot(
+    VisitableHandle<Base> const & handle, ArgumentType<Args> ...args
+)
+{
+#if META_VISITOR_INSTRUMENTATION
+    visitor_details::DispatchProbe const probe(
+        m_staticVTable.load(std::memory_order_relaxed)->statsId(), handle.tag()
+    );
+#endif
+
+    // The overrides apply to the hot visitables: dispatch by the vtable
+    if(m_overridden.load(std::memory_order_relaxed))
+    {
+        return this->dispatchHot<VisitorImpl, Invoker>(
+            visitor_details::ThunkTag<>(),
+            handle.tag(), *handle, visitor_details::ForwardArgument<Args>(args)...
+        );
+    }
+
+    return this->dispatchHot<VisitorImpl, Invoker>(
+        visitor_details::ThunkTag<HotVisitables...>(),
+        handle.tag(), *handle, visitor_details::ForwardArgument<Args>(args)...
+    );
+}
+
+template <typename Base, typename ReturnType, typename ...Args>
+template <typename VisitorImpl, typename Invoker, typename Hot, typename ...Tail>
+inline ReturnType Visitor<Base, ReturnType, Args...>::dispatchHot(
+    visitor_details::ThunkTag<Hot, Tail...>,
+    std::size_t tag, Base & b, ArgumentType<Args> ...args
+)
+{
+    if(tag == visitor_details::GetVisitableTag<Hot, Base>())
+    {
+        return Visitor::thunk<VisitorImpl, Hot, Invoker>(
+            *this, b, visitor_details::ForwardArgument<Args>(args)...
+        );
+    }
+
+    return this->dispatchHot<VisitorImpl, Invoker>(
+        visitor_details::ThunkTag<Tail...>(),
+        tag, b, visitor_details::ForwardArgument<Args>(args)...
+    );
+}
+
+template <typename Base, typename ReturnType, typename ...Args>
+template <typename VisitorImpl, typename Invoker>
+inline ReturnType Visitor<Base, ReturnType, Args...>::dispatchHot(
+    visitor_details::ThunkTag<>,
+    std::size_t tag, Base & b, ArgumentType<Args> ...args
+)
+{
+    Thunk thunk = this->getThunk(tag);
+
+    return thunk(*this, b, visitor_details::ForwardArgument<Args>(args)...);
+}
+
+template <typename Base, typename ReturnType, typename ...Args>
+template <typename InputIt>
+inline void Visitor<Base, ReturnType, Args...>::visitRange(
+    InputIt first, InputIt last, ArgumentType<Args> ...args
+)
+{
+    visitor_details::VTableEpochs::Guard const guard;
+
+    VTableType const & vtable = this->vtable();
+
+    visitor_details::VisitableBuckets<Base> const buckets(first, last, vtable);
+
+    for(std::size_t slot = 0; slot < buckets.slotCount(); ++slot)
+    {
+        Thunk const thunk = vtable[slot];
+
+        for(std::size_t i = buckets.begin(slot); i < buckets.end(slot); ++i)
+        {
+            thunk(
+                *this, buckets.visitable(i), visitor_details::ForwardArgument<Args>(args)...
+            );
+        }
+    }
+}
+
+template <typename Base, typename ReturnType, typename ...Args>
+template <typename InputIt, typename OutputIt>
+inline OutputIt Visitor<Base, ReturnType, Args...>::transformRange(
+    InputIt first, InputIt last, OutputIt result, ArgumentType<Args> ...args
+)
+{
+    visitor_details::VTableEpochs::Guard const guard;
+
+    VTableType const & vtable = this->vtable();
+
+    visitor_details::VisitableBuckets<Base> const buckets(first, last, vtable);
+
+    for(std::size_t slot = 0; slot < buckets.slotCount(); ++slot)
+    {
+        Thunk const thunk = vtable[slot];
+
+        for(std::size_t i = buckets.begin(slot); i < buckets.end(slot); ++i)
+        {
+            result[buckets.index(i)] = thunk(
+                *this, buckets.visitable(i), visitor_details::ForwardArgument<Args>(args)...
+            );
+        }
+    }
+
+    return result + buckets.size();
+}
+
+template <typename Base, typename ReturnType, typename ...Args>
+template <typename Collection>
+inline void Visitor<Base, ReturnType, Args...>::visitCollection(
+    Collection & collection, ArgumentType<Args> ...args
+)
+{
+    visitor_details::VTableEpochs::Guard const guard;
+
+    VTableType const & vtable = this->vtable();
+
+    for(std::size_t tag = 0; tag < collection.segmentCount(); ++tag)
+    {
+        auto * const segment = collection.segment(tag);
+
+        if(!segment || segment->size() == 0u) continue;
+
+        Thunk const thunk = vtable[tag];
+
+        for(std::size_t i = 0; i < segment->size(); ++i)
+        {
+            thunk(
+                *this, segment->visitable(i), visitor_details::ForwardArgument<Args>(args)...
+            );
+        }
+    }
+}
+
+template <typename Base, typename ReturnType, typename ...Args>
+template <typename VisitorImpl, typename Invoker, typename ...Visitables>
+inline void Visitor<Base, ReturnType, Args...>::overrideVisits()
+{
+    std::size_t const tags[] = {
+        visitor_details::GetVisitableTag<Visitables, Base>()...
+    };
+
+    Thunk const thunks[] = {
+        &Visitor::template thunk<VisitorImpl, Visitables, Invoker>...
+    };
+
+    this->publishVTable(tags, thunks, sizeof...(Visitables));
+}
+
+template <typename Base, typename ReturnType, typename ...Args>
+template <typename Visitable>
+inline void Visitor<Base, ReturnType, Args...>::overrideThunk(Thunk thunk)
+{
+    std::size_t const tag = visitor_details::GetVisitableTag<Visitable, Base>();
+
+    this->publishVTable(&tag, &thunk, 1u);
+}
+
+template <typename Base, typename ReturnType, typename ...Args>
+inline void Visitor<Base, ReturnType, Args...>::resetVTable()
+{
+    if(!m_overrides) return;
+
+    m_overrides->reset(m_vtable, m_staticVTable.load(std::memory_order_relaxed));
+    m_overridden.store(false, std::memory_order_relaxed);
+}
+
+template <typename Base, typename ReturnType, typename ...Args>
+inline void Visitor<Base, ReturnType, Args...>::reclaimVTables()
+{
+    if(m_overrides) m_overrides->reclaim();
+}
+
+template <typename Base, typename ReturnType, typename ...Args>
+inline typename Visitor<Base, ReturnType, Args...>::Thunk
+Visitor<Base, ReturnType, Args...>::getThunk(std::size_t tag) const
+{
+    VTableType const * const vtable = m_vtable.load(std::memory_order_acquire);
+
+    if(vtable == m_staticVTable.load(std::memory_order_relaxed)) return (*vtable)[tag];
+
+    // Overridden table: announce the epoch before reloading the pointer
+    visitor_details::VTableEpochs::Guard const guard;
+
+    return this->vtable()[tag];
+}
+
+template <typename Base, typename ReturnType, typename ...Args>
+inline typename Visitor<Base, ReturnType, Args...>::VTableType const &
+Visitor<Base, ReturnType, Args...>::vtable() const
+{
+    // Same cost as a plain load on the usual targets (sequentially consistent
+    // for the epoch guards, see visitor_details::VTableEpochs::Guard)
+    return *m_vtable.load(std::memory_order_seq_cst);
+}
+
+template <typename Base, typename ReturnType, typename ...Args>
+inline void Visitor<Base, ReturnType, Args...>::publishVTable(
+    std::size_t const * tags, Thunk const * thunks, std::size_t count
+)
+{
+    VTableType const & current = this->vtable();
+
+    if(!m_overrides) m_overrides.reset(new Overrides());
+
+    // Copy-on-write: the published tables are never modified (the copy covers
+    // the visitables registered since the creation of the current table)
+    std::unique_ptr<VTableType> vtable(
+        new VTableType(current, visitor_details::RegisterVisitableTags<Base>())
+    );
+
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        vtable->replace(tags[i], thunks[i]);
+    }
+
+    m_overrides->publish(m_vtable, std::move(vtable));
+    m_overridden.store(true, std::memory_order_relaxed);
 }
 
 template <typename Base, typename ReturnType, typename ...Args>
 template <typename VisitorImpl, typename Visitable, typename Invoker>
-inline ReturnType Visitor<Base, ReturnType, Args...>::thunk(Base & b, Args && ...args)
+inline ReturnType Visitor<Base, ReturnType, Args...>::thunk(
+    Visitor & v, Base & b, ArgumentType<Args> ...args
+)
 {
     using VisitableType =
         typename visitor_details::GetVisitMethodArgumentType<Visitable, Base>::Type;
 
-    VisitorImpl & visitor = static_cast<VisitorImpl&>(*this);
+    VisitorImpl & visitor = static_cast<VisitorImpl&>(v);
 
     VisitableType & visitable = static_cast<VisitableType &>(b);
 
-    return Invoker::Invoke(visitor, visitable, std::forward<Args>(args)...);
+    return Invoker::Invoke(
+        visitor, visitable, visitor_details::ForwardArgument<Args>(args)...
+    );
 }
 
 
@@ -61,7 +389,37 @@ struct VisitorVTableSetter
     {
         // Instantiate the static vtable and set the vtable pointer
         visitor.m_vtable =
-            visitor_details::GetVisitorVTable<Visitor, Invoker, VisitedList...>();
+            typename Visitor::template VTableGetter<Visitor, Invoker, VisitedList...>();
+        VisitorVTableSetter::SetStaticVTable(visitor, 0);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Set the vtable of the visited list followed by the hot
+    /// visitables (see META_HotVisitables).
+    ////////////////////////////////////////////////////////////////////////////
+    template <typename ...HotVisitables>
+    static void SetVTable(Visitor & visitor, visitor_details::ThunkTag<HotVisitables...>)
+    {
+        visitor.m_vtable = typename Visitor::template VTableGetter<
+            Visitor, Invoker, VisitedList..., HotVisitables...
+        >();
+        VisitorVTableSetter::SetStaticVTable(visitor, 0);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Keep the static vtable of a Visitor (its overridden vtables are
+    /// read under an epoch guard). The other visitors only have the pointer.
+    ////////////////////////////////////////////////////////////////////////////
+    template <typename V>
+    static auto SetStaticVTable(V & visitor, int) -> decltype(void(visitor.m_staticVTable))
+    {
+        visitor.m_staticVTable.store(visitor.m_vtable.load());
+    }
+
+    template <typename V>
+    static void SetStaticVTable(V &, long)
+    {
+
     }
 };
 
@@ -78,16 +436,21 @@ struct visitor_invoker_details \
     using InvokerType = \
     struct  \
     { \
-        template <typename VisitorImpl, typename VisitableImpl, typename ...Args> \
-        static typename VisitorImpl::RType Invoke( \
-            VisitorImpl & visitor, VisitableImpl & visitable, Args && ...args \
-        ) \
-        { \
-            return visitor.VisitInvoker(visitable, std::forward<Args>(args)...); \
-        } \
+        _META_VISITOR_INVOKE_(VisitInvoker) \
     }; \
 }; \
 
+//! Internal macro defining the Invoke method of an invoker calling the visit
+/// methods named <VisitInvoker>
+#define _META_VISITOR_INVOKE_(VisitInvoker) \
+    template <typename VisitorImpl, typename VisitableImpl, typename ...Args> \
+    static typename VisitorImpl::RType Invoke( \
+        VisitorImpl & visitor, VisitableImpl & visitable, Args && ...args \
+    ) \
+    { \
+        return visitor.VisitInvoker(visitable, std::forward<Args>(args)...); \
+    }
+
 
 #define _META_VISITOR_1_(VisitorImpl) \
 	_META_VISITOR_DEFAULT_(VisitorImpl)
@@ -1,9 +1,25 @@
 #ifndef VISITOR_DETAILS_HPP
 #define VISITOR_DETAILS_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 
+// Dispatch statistics (only the dump API without META_VISITOR_INSTRUMENTATION)
+#include "VisitorStats.hpp"
+
+template <typename Base>
+class VisitableHandle;
+
 namespace visitor_details {
 
 /////////////////////////////// TAG GOUNTER ////////////////////////////////////
@@ -11,6 +27,7 @@ namespace visitor_details {
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief Generate a tag counter for each visitable hierarchy to keep track of
 /// the next available tag.
+/// The counter is only accessed under the lock of the HierarchyParentTable.
 ////////////////////////////////////////////////////////////////////////////////
 template <typename Base>
 struct HierarchyTagCounter
@@ -22,81 +39,928 @@ template <typename Base>
 std::size_t HierarchyTagCounter<Base>::s_counter = 0u;
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Store the tag of the parent of every visitable class in a hierarchy
+/// (indexed by tag). The base class of the hierarchy is its own parent.
+///
+/// Function-local statics are used because the table can be filled during the
+/// static initialization of any translation unit. Every access to the table
+/// must hold the lock returned by GetMutex().
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base>
+struct HierarchyParentTable
+{
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Return the parent table of the hierarchy.
+    ////////////////////////////////////////////////////////////////////////////
+    static std::vector<std::size_t> & Get()
+    {
+        static std::vector<std::size_t> s_parents(1, 0u); // Tag 0 is unused
+        return s_parents;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Return the mutex protecting the registration of the hierarchy.
+    ////////////////////////////////////////////////////////////////////////////
+    static std::mutex & GetMutex()
+    {
+        static std::mutex s_mutex;
+        return s_mutex;
+    }
+};
+
+
+#if META_VISITOR_INSTRUMENTATION
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Store the name of every visitable class in a hierarchy (indexed by
+/// tag), for the dispatch statistics.
+/// Every access to the table must hold the lock of the HierarchyParentTable.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base>
+struct HierarchyNameTable
+{
+    static std::vector<std::string> & Get()
+    {
+        static std::vector<std::string> s_names(1); // Tag 0 is unused
+        return s_names;
+    }
+};
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Map the stable tags of a hierarchy (see META_StableTag) to their
+/// runtime tags.
+/// Every access to the table must hold the lock of the HierarchyParentTable.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base>
+struct HierarchyStableTagTable
+{
+    static std::unordered_map<std::uint64_t, std::size_t> & Get()
+    {
+        static std::unordered_map<std::uint64_t, std::size_t> s_tags;
+        return s_tags;
+    }
+
+    //! Number of stable tags registered, to invalidate the cached lookups
+    static std::atomic<std::uint32_t> & Generation()
+    {
+        static std::atomic<std::uint32_t> s_generation(0u);
+        return s_generation;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Hash a name into a stable tag (64-bit FNV-1a).
+////////////////////////////////////////////////////////////////////////////////
+constexpr std::uint64_t HashStableName(
+    char const * name, std::uint64_t hash = 14695981039346656037ull
+)
+{
+    return *name ? HashStableName(
+        name + 1, (hash ^ static_cast<unsigned char>(*name)) * 1099511628211ull
+    ) : hash;
+}
+
+//! Stable tag from a user-supplied id (non-zero, see META_StableTag). Any
+/// integer type matches exactly, so the literal 0 reaches the check of
+/// META_StableTag instead of being ambiguous with a null name.
+template <typename Id>
+constexpr typename std::enable_if<std::is_integral<Id>::value, std::uint64_t>::type
+MakeStableTag(Id id)
+{
+    return static_cast<std::uint64_t>(id);
+}
+
+//! Stable tag from the hash of a name
+constexpr std::uint64_t MakeStableTag(char const * name)
+{
+    return HashStableName(name);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Return the stable tag of a visitable (0 if it has none).
+////////////////////////////////////////////////////////////////////////////////
+template <typename Visitable>
+struct GetStableTag
+{
+    private:
+        template <typename V>
+        static constexpr std::uint64_t Get(decltype(V::visitable_stable_tag()) *)
+        {
+            return V::visitable_stable_tag();
+        }
+
+        template <typename V>
+        static constexpr std::uint64_t Get(...)
+        {
+            return 0u;
+        }
+
+    public:
+        static constexpr std::uint64_t value = Get<Visitable>(nullptr);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Tell whether the visitable declares its own stable tag (a stable
+/// tag inherited from its fallback does not count).
+////////////////////////////////////////////////////////////////////////////////
+template <typename Visitable>
+struct HasStableTag
+{
+    using Fallback = typename Visitable::VisitableFallbackType;
+
+    static constexpr bool value = GetStableTag<Visitable>::value != 0u && (
+        std::is_same<Fallback, Visitable>::value
+        || GetStableTag<Fallback>::value != GetStableTag<Visitable>::value
+    );
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Record the stable tag of a visitable, checking for collisions (the
+/// program is aborted on collision).
+/// Must be called under the lock of the HierarchyParentTable.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Visitable, typename Base>
+void RegisterStableTag(std::size_t tag, std::true_type /* stable */)
+{
+    std::uint64_t const stableTag = GetStableTag<Visitable>::value;
+
+    auto const inserted =
+        HierarchyStableTagTable<Base const>::Get().emplace(stableTag, tag);
+
+    if(inserted.second)
+    {
+        HierarchyStableTagTable<Base const>::Generation().fetch_add(
+            1u, std::memory_order_release
+        );
+    }
+
+    // Dispatching the records of one visitable to another would be silent:
+    // abort, in every build
+    if(!inserted.second && inserted.first->second != tag)
+    {
+        std::fprintf(stderr,
+            "Stable tag collision: two visitables have the stable tag %016llx\n",
+            static_cast<unsigned long long>(stableTag)
+        );
+        std::abort();
+    }
+}
+
+template <typename Visitable, typename Base>
+void RegisterStableTag(std::size_t, std::false_type /* stable */)
+{
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Return the runtime tag of a stable tag of the hierarchy, 0 if no
+/// visitable of this program declares it.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base>
+std::size_t FindVisitableTag(std::uint64_t stableTag)
+{
+    std::lock_guard<std::mutex> lock(HierarchyParentTable<Base const>::GetMutex());
+
+    std::unordered_map<std::uint64_t, std::size_t> const & tags =
+        HierarchyStableTagTable<Base const>::Get();
+
+    auto const it = tags.find(stableTag);
+
+    return it != tags.end() ? it->second : 0u;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief Store a tag for every visitable class in a hierarchy.
+///
+/// The tag is 0 until the visitable is registered, and it is published with
+/// release semantics once its parent tag has been recorded.
 ////////////////////////////////////////////////////////////////////////////////
 template <typename Visitable, typename Base>
 struct VisitableTagHolder
 {
-    static std::size_t s_tag; ///< Visitable tag
+    static std::atomic<std::size_t> s_tag;  ///< Visitable tag
+    static std::size_t const s_registered;  ///< Register the tag at startup
 };
 
+template <typename Visitable, typename Base>
+std::size_t RegisterVisitableTag();
+
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief Get the tag of a visitable class in a hierarchy.
+/// Once the visitable is registered, this is a single acquire load.
 /// \return The tag of a visitable class in a hierarchy.
 ////////////////////////////////////////////////////////////////////////////////
 template <typename Visitable, typename Base>
 std::size_t GetVisitableTag()
 {
-    std::size_t & tag = VisitableTagHolder<Visitable const, Base const>::s_tag;
+    using TagHolder = VisitableTagHolder<Visitable const, Base const>;
+
+    // Force the registration of the tag during the static initialization
+    (void) TagHolder::s_registered;
+
+    std::size_t const tag = TagHolder::s_tag.load(std::memory_order_acquire);
 
     // If the tag has not been generated yet, generate it and return it
-    return tag == 0 ? (tag = ++HierarchyTagCounter<Base const>::s_counter) : tag;
+    return tag == 0 ? RegisterVisitableTag<Visitable, Base>() : tag;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Generate the tag of a visitable class and record its parent tag.
+/// The ancestors are registered first so a parent tag is always lower than the
+/// tags of its children.
+/// Concurrent registrations of the same visitable yield the same tag.
+/// \return The tag of the visitable.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Visitable, typename Base>
+std::size_t RegisterVisitableTag()
+{
+    using Fallback = typename Visitable::VisitableFallbackType;
+    using TagHolder = VisitableTagHolder<Visitable const, Base const>;
+
+    bool const isRoot = std::is_same<Fallback const, Visitable const>::value;
+
+    // Register the parent before taking the lock (the mutex is not recursive)
+    std::size_t const parentTag = isRoot ? 0u : GetVisitableTag<Fallback, Base>();
+
+    std::lock_guard<std::mutex> lock(HierarchyParentTable<Base const>::GetMutex());
+
+    // Another thread may have registered the visitable in the meantime
+    std::size_t tag = TagHolder::s_tag.load(std::memory_order_relaxed);
+
+    if(tag == 0)
+    {
+        tag = ++HierarchyTagCounter<Base const>::s_counter;
+
+        std::vector<std::size_t> & parents = HierarchyParentTable<Base const>::Get();
+        parents.resize(tag + 1, 0u);
+        parents[tag] = isRoot ? tag : parentTag;
+
+#if META_VISITOR_INSTRUMENTATION
+        std::vector<std::string> & names = HierarchyNameTable<Base const>::Get();
+        names.resize(tag + 1);
+        names[tag] = TypeName(typeid(Visitable).name());
+#endif
+
+        RegisterStableTag<Visitable, Base>(
+            tag, std::integral_constant<bool, HasStableTag<Visitable>::value>()
+        );
+
+        TagHolder::s_tag.store(tag, std::memory_order_release);
+    }
+
+    return tag;
 }
 
 template <typename Visitable, typename Base>
-std::size_t
-VisitableTagHolder<Visitable, Base>::s_tag = GetVisitableTag<Visitable, Base>();
+std::atomic<std::size_t> VisitableTagHolder<Visitable, Base>::s_tag(0u);
+
+template <typename Visitable, typename Base>
+std::size_t const
+VisitableTagHolder<Visitable, Base>::s_registered = GetVisitableTag<Visitable, Base>();
+
+
+//! Marker base class of the visitables storing their tag (IntrusiveVisitable)
+struct IntrusiveVisitableMarker { };
+
+//! Tell whether a visitable stores its tag (IntrusiveVisitable)
+template <typename Visitable>
+using IsIntrusiveVisitable = std::is_base_of<IntrusiveVisitableMarker, Visitable>;
+
+template <typename Base>
+std::size_t GetDispatchTag(Base & b, std::false_type /* intrusive */)
+{
+    return b.visitable_tag();
+}
+
+template <typename Base>
+std::size_t GetDispatchTag(Base & b, std::true_type /* intrusive */)
+{
+    return b.visitable_intrusive_tag();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Get the tag used to dispatch a visitable: the tag stored in the
+/// visitable for the intrusive visitables, the virtual visitable_tag() for
+/// the other ones.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base>
+std::size_t GetDispatchTag(Base & b)
+{
+    return GetDispatchTag(b, IsIntrusiveVisitable<Base>());
+}
 
 
 ////////////////////////////// VIRTUAL TABLE ////////////////////////////////////
 
+//! Size of a cache line, used to align the vtables
+static constexpr std::size_t CacheLineSize = 64u;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief Class representing a virtual table used for visit dispatch.
+///
+/// The table is sized once from the number of tags of the hierarchy and
+/// stored in a single cache-line aligned allocation. A null entry marks a slot
+/// which has not been registered yet: once the fallbacks are resolved, every
+/// slot holds a function.
+/// The registered slots are also flagged after the functions, in the same
+/// allocation (the dispatch only reads the functions): the fallbacks never
+/// compare the functions, which may share an address once identical thunks are
+/// folded by the linker (CMake option VISITOR_FOLD_THUNKS).
 ////////////////////////////////////////////////////////////////////////////////
 template <typename Base, typename Func>
 class VisitorVTable
 {
     public:
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Constructor.
+        /// \param size Number of slots (must cover every registered tag).
+        ////////////////////////////////////////////////////////////////////////
+        explicit VisitorVTable(std::size_t size):
+            m_storage(new unsigned char[size * (sizeof(Func) + 1u) + CacheLineSize]),
+            m_table(nullptr),
+            m_registered(nullptr),
+            m_size(size)
+        {
+            void * storage = m_storage.get();
+            std::size_t space = size * (sizeof(Func) + 1u) + CacheLineSize;
+
+            m_table = static_cast<Func *>(
+                std::align(CacheLineSize, size * (sizeof(Func) + 1u), storage, space)
+            );
+            m_registered = reinterpret_cast<unsigned char *>(m_table + m_size);
+
+            std::uninitialized_fill_n(m_table, m_size, Func(nullptr));
+            std::fill_n(m_registered, m_size, 0u);
+
+            for(std::atomic<std::uint64_t> & entry : m_lateTags)
+            {
+                entry.store(0u, std::memory_order_relaxed);
+            }
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Copy constructor, growing the table if needed.
+        /// \param other Table to copy (resolved).
+        /// \param size  Minimal number of slots: the new slots hold the
+        ///              function of their nearest ancestor.
+        ////////////////////////////////////////////////////////////////////////
+        VisitorVTable(VisitorVTable const & other, std::size_t size):
+            VisitorVTable(std::max(size, other.m_size))
+        {
+            for(std::size_t tag = 0; tag < m_size; ++tag)
+            {
+                m_table[tag] = other[tag];
+            }
+
+            std::copy_n(other.m_registered, other.m_size, m_registered);
+
+#if META_VISITOR_INSTRUMENTATION
+            m_statsId = other.m_statsId;
+#endif
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Register the function handling the given visitable.
+        ////////////////////////////////////////////////////////////////////////
         template <typename Visitable>
         void add(Func f)
         {
-            std::size_t index = GetVisitableTag<Visitable, Base>();
+            std::size_t const tag = GetVisitableTag<Visitable, Base>();
+
+            m_table[tag] = f;
+            m_registered[tag] = 1;
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Fill every empty slot of the table with the function of the
+        /// nearest registered ancestor.
+        /// Must be called once every function has been added.
+        ////////////////////////////////////////////////////////////////////////
+        void resolveFallbacks()
+        {
+            std::lock_guard<std::mutex> lock(HierarchyParentTable<Base>::GetMutex());
+
+            std::vector<std::size_t> const & parents =
+                HierarchyParentTable<Base>::Get();
+
+            // Parent tags are lower than children ones: a single pass suffices
+            for(std::size_t tag = 1; tag < m_size; ++tag)
+            {
+                if(!m_table[tag]) m_table[tag] = m_table[parents[tag]];
+            }
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Replace the function of a resolved slot, and of the slots of
+        /// the descendants falling back to it. The slot is then registered.
+        ////////////////////////////////////////////////////////////////////////
+        void replace(std::size_t tag, Func f)
+        {
+            std::lock_guard<std::mutex> lock(HierarchyParentTable<Base>::GetMutex());
+
+            std::vector<std::size_t> const & parents =
+                HierarchyParentTable<Base>::Get();
+
+            std::vector<char> replaced(m_size, 0);
+            replaced[tag] = 1;
+            m_table[tag] = f;
+            m_registered[tag] = 1;
+
+            // Parent tags are lower than children ones: a single pass suffices
+            for(std::size_t child = tag + 1; child < m_size; ++child)
+            {
+                if(replaced[parents[child]] && !m_registered[child])
+                {
+                    replaced[child] = 1;
+                    m_table[child] = f;
+                }
+            }
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the function handling the visitable with the given tag.
+        ////////////////////////////////////////////////////////////////////////
+        Func operator[](std::size_t tag) const
+        {
+            if(tag >= m_size) tag = this->resolveUnknownTag(tag);
+
+            return m_table[tag];
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the slot of the visitable with the given tag: the tag
+        /// itself or, for a visitable registered after the table has been
+        /// built, the slot of its nearest ancestor.
+        ////////////////////////////////////////////////////////////////////////
+        std::size_t slot(std::size_t tag) const
+        {
+            return tag < m_size ? tag : this->resolveUnknownTag(tag);
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the number of slots of the table.
+        ////////////////////////////////////////////////////////////////////////
+        std::size_t size() const
+        {
+            return m_size;
+        }
+
+#if META_VISITOR_INSTRUMENTATION
+        //! Id of the statistics of the visitor owning the table
+        std::size_t statsId() const { return m_statsId; }
+        void setStatsId(std::size_t statsId) { m_statsId = statsId; }
+#endif
+
+    private:
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the slot of a visitable registered after the table
+        /// has been built: its nearest ancestor with a slot.
+        /// The slots are cached by tag (lock free), so the hierarchy is only
+        /// walked (under its lock) on a miss of the cache.
+        ////////////////////////////////////////////////////////////////////////
+        std::size_t resolveUnknownTag(std::size_t tag) const
+        {
+            std::atomic<std::uint64_t> & cached = m_lateTags[tag % LateTagCacheSize];
+
+            // Entry: (tag << 32) | slot, so a single load reads both
+            std::uint64_t const entry = cached.load(std::memory_order_relaxed);
+            if((entry >> 32) == tag) return static_cast<std::size_t>(entry & 0xFFFFFFFFu);
+
+            std::size_t slot = tag;
+
+            {
+                std::lock_guard<std::mutex> lock(HierarchyParentTable<Base>::GetMutex());
+
+                std::vector<std::size_t> const & parents =
+                    HierarchyParentTable<Base>::Get();
+
+                while(slot >= m_size) slot = parents[slot];
+            }
+
+            if(tag <= 0xFFFFFFFFu)
+            {
+                cached.store(
+                    static_cast<std::uint64_t>(tag) << 32 | slot, std::memory_order_relaxed
+                );
+            }
+
+            return slot;
+        }
+
+    private:
+        static constexpr std::size_t LateTagCacheSize = 16u;
+
+        std::unique_ptr<unsigned char[]> m_storage; ///< Unaligned allocation
+        Func * m_table;                             ///< Functions table
+        unsigned char * m_registered;               ///< Registered slots
+        std::size_t m_size;                         ///< Number of slots
+
+        //! Slots of the visitables registered after the table has been built
+        mutable std::atomic<std::uint64_t> m_lateTags[LateTagCacheSize];
+#if META_VISITOR_INSTRUMENTATION
+        std::size_t m_statsId = 0u;                 ///< Statistics id
+#endif
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Epochs protecting the vtables replaced by the overrides.
+///
+/// A thread dispatching with an overridden table announces the global epoch
+/// (see Guard) before loading the table pointer. A replaced table is retired
+/// with the epoch of its replacement and freed once every thread has either
+/// left its dispatch or announced a later epoch: no dispatch can still use it.
+////////////////////////////////////////////////////////////////////////////////
+class VTableEpochs
+{
+    public:
+        static constexpr std::uint64_t Inactive = ~std::uint64_t(0);
+
+    private:
+        //! Announcement of a thread
+        struct Reader
+        {
+            std::atomic<std::uint64_t> epoch{Inactive}; ///< Announced epoch
+            std::size_t depth = 0u;                     ///< Nested guards
+            char padding[CacheLineSize];                ///< No false sharing
+        };
+
+    public:
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Announce the epoch of the calling thread for its lifetime
+        /// (the guards can be nested).
+        ////////////////////////////////////////////////////////////////////////
+        class Guard
+        {
+            public:
+                Guard(): m_reader(VTableEpochs::Local())
+                {
+                    // Announce before loading the table: the sequentially
+                    // consistent store and loads (of the announcements by
+                    // Oldest, of the table pointers by the guarded reads)
+                    // ensure either the reclaiming thread sees the epoch or
+                    // the reader sees the replacement table
+                    if(m_reader.depth++ == 0u)
+                    {
+                        m_reader.epoch.store(
+                            Epoch().load(std::memory_order_acquire), std::memory_order_seq_cst
+                        );
+                    }
+                }
+
+                ~Guard()
+                {
+                    if(--m_reader.depth == 0u)
+                    {
+                        m_reader.epoch.store(Inactive, std::memory_order_release);
+                    }
+                }
+
+                Guard(Guard const &) = delete;
+                Guard & operator=(Guard const &) = delete;
+
+            private:
+                Reader & m_reader;
+        };
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Start a new epoch once a replaced table is unpublished (by a
+        /// sequentially consistent store).
+        /// \return The epoch the replaced table is retired with.
+        ////////////////////////////////////////////////////////////////////////
+        static std::uint64_t Advance()
+        {
+            return Epoch().fetch_add(1u, std::memory_order_acq_rel);
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the oldest epoch announced by a thread (Inactive if
+        /// no thread is dispatching): the tables retired before it are free.
+        ////////////////////////////////////////////////////////////////////////
+        static std::uint64_t Oldest()
+        {
+            Registry & registry = Registry::Get();
+
+            std::lock_guard<std::mutex> lock(registry.mutex);
+
+            std::uint64_t oldest = Inactive;
+
+            for(std::unique_ptr<Reader> const & reader : registry.readers)
+            {
+                oldest = std::min(oldest, reader->epoch.load(std::memory_order_seq_cst));
+            }
+
+            return oldest;
+        }
+
+    private:
+        //! Readers of the threads (reused once their thread exits)
+        struct Registry
+        {
+            static Registry & Get()
+            {
+                static Registry registry;
+                return registry;
+            }
+
+            std::mutex mutex;
+            std::vector<std::unique_ptr<Reader>> readers;
+            std::vector<Reader *> free;
+        };
 
-            if(index >= m_table.size())
+        //! Hand the reader back to the registry at the exit of the thread
+        struct LocalReader
+        {
+            LocalReader(): reader(nullptr)
             {
-                // Find function for Base if it exists
-                std::size_t const baseTag = GetVisitableTag<Base, Base>();
+                Registry & registry = Registry::Get();
+
+                std::lock_guard<std::mutex> lock(registry.mutex);
+
+                if(registry.free.empty())
+                {
+                    registry.readers.emplace_back(new Reader());
+                    reader = registry.readers.back().get();
+                }
+                else
+                {
+                    reader = registry.free.back();
+                    registry.free.pop_back();
+                }
+            }
 
-                Func defaultFunc =
-                    (baseTag >= m_table.size()) ? nullptr : m_table[baseTag];
+            ~LocalReader()
+            {
+                Registry & registry = Registry::Get();
 
-                // Expand the table and fill the holes with the default handler
-                m_table.resize(index + 1, defaultFunc);
-                m_status.resize(index + 1, false);
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                registry.free.push_back(reader);
             }
 
-            m_table[index] = f;
-            m_status[index] = true;
+            Reader * reader;
+        };
+
+        static std::atomic<std::uint64_t> & Epoch()
+        {
+            static std::atomic<std::uint64_t> epoch{0u};
+            return epoch;
         }
 
-        Func operator[](std::size_t index) const
+        static Reader & Local()
         {
-            if(index >= m_table.size()) index = GetVisitableTag<Base, Base>();
+            static thread_local LocalReader local;
+            return *local.reader;
+        }
+};
+
 
-            return m_table[index];
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Tables overriding the static vtable of a visitor instance.
+///
+/// The tables are never modified once published (copy-on-write). A replaced
+/// table may still be used by a dispatch in flight on another thread, so it is
+/// retired with the current epoch (see VTableEpochs) and freed by the first
+/// publish, reset or reclaim() once no dispatch can use it. The retired list
+/// thus only holds the tables of the dispatches still in flight.
+////////////////////////////////////////////////////////////////////////////////
+template <typename VTable>
+class VisitorVTableOverrides
+{
+    public:
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Take the ownership of a new table, publish it and retire the
+        /// current one.
+        /// \param slot Vtable pointer of the visitor.
+        ////////////////////////////////////////////////////////////////////////
+        void publish(std::atomic<VTable const *> & slot, std::unique_ptr<VTable> vtable)
+        {
+            std::unique_ptr<VTable const> replaced = std::move(m_current);
+
+            m_current = std::move(vtable);
+            slot.store(m_current.get(), std::memory_order_seq_cst);
+
+            this->retire(std::move(replaced));
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Publish a static vtable and retire the current table.
+        /// \param slot Vtable pointer of the visitor.
+        ////////////////////////////////////////////////////////////////////////
+        void reset(std::atomic<VTable const *> & slot, VTable const * staticVTable)
+        {
+            std::unique_ptr<VTable const> replaced = std::move(m_current);
+
+            slot.store(staticVTable, std::memory_order_seq_cst);
+
+            this->retire(std::move(replaced));
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Free the retired tables no dispatch can use anymore.
+        ////////////////////////////////////////////////////////////////////////
+        void reclaim()
+        {
+            if(m_retired.empty()) return;
+
+            std::uint64_t const oldest = VTableEpochs::Oldest();
+
+            m_retired.erase(
+                std::remove_if(
+                    m_retired.begin(), m_retired.end(),
+                    [oldest](Retired const & retired) { return retired.epoch < oldest; }
+                ),
+                m_retired.end()
+            );
         }
 
-        std::vector<bool> const & getStatusTable() const
+    private:
+        //! Replaced table and the epoch it was unpublished in
+        struct Retired
         {
-            return m_status;
+            std::uint64_t epoch;
+            std::unique_ptr<VTable const> vtable;
+        };
+
+        void retire(std::unique_ptr<VTable const> vtable)
+        {
+            if(vtable) m_retired.push_back(Retired{VTableEpochs::Advance(), std::move(vtable)});
+
+            this->reclaim();
         }
 
     private:
-        std::vector<Func> m_table;  ///< Functions table
-        std::vector<bool> m_status; ///< Used slots of the functions table
+        std::unique_ptr<VTable const> m_current; ///< Published table
+        std::vector<Retired> m_retired;          ///< Replaced tables
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Register the tags of the given visitables (and of their ancestors).
+/// \return The number of tags of the hierarchy.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base, typename ...VisitedList>
+std::size_t RegisterVisitableTags()
+{
+    std::size_t const tags[] = {
+        GetVisitableTag<Base, Base>(), GetVisitableTag<VisitedList, Base>()...
+    };
+    (void) tags;
+
+    std::lock_guard<std::mutex> lock(HierarchyParentTable<Base const>::GetMutex());
+
+    return HierarchyParentTable<Base const>::Get().size();
+}
+
+
+#if META_VISITOR_INSTRUMENTATION
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Return the parent of a tag of the hierarchy.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base>
+std::size_t GetParentTag(std::size_t tag)
+{
+    std::lock_guard<std::mutex> lock(HierarchyParentTable<Base>::GetMutex());
+
+    return HierarchyParentTable<Base>::Get()[tag];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Return the name of the visitable class of a tag of the hierarchy.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base>
+std::string GetVisitableName(std::size_t tag)
+{
+    std::lock_guard<std::mutex> lock(HierarchyParentTable<Base>::GetMutex());
+
+    return HierarchyNameTable<Base>::Get()[tag];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Register the statistics of a visitor from its vtable, before its
+/// fallbacks are resolved (the non-null slots are the visited classes).
+/// \return The id of the statistics.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Visitor, typename VTable>
+std::size_t RegisterVisitorVTableStats(VTable const & vtable)
+{
+    using Base = typename Visitor::BaseType const;
+
+    VisitorStatsInfo info;
+    info.name = TypeName(typeid(Visitor).name());
+    info.parent = &GetParentTag<Base>;
+    info.typeName = &GetVisitableName<Base>;
+    info.handlers.resize(vtable.size(), 0u);
+    info.depths.resize(vtable.size(), 0u);
+
+    {
+        std::lock_guard<std::mutex> lock(HierarchyParentTable<Base>::GetMutex());
+
+        std::vector<std::size_t> const & parents = HierarchyParentTable<Base>::Get();
+
+        // Parent tags are lower than children ones: a single pass suffices
+        for(std::size_t tag = 1; tag < vtable.size(); ++tag)
+        {
+            if(vtable[tag])
+            {
+                info.handlers[tag] = tag;
+            }
+            else
+            {
+                info.handlers[tag] = info.handlers[parents[tag]];
+                info.depths[tag] = info.depths[parents[tag]] + 1u;
+            }
+        }
+    }
+
+    return RegisterVisitorStats(std::move(info));
+}
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Type used to pass an extra argument of a visitor through its thunks.
+///
+/// Small trivially copyable arguments are passed by value (in registers),
+/// the others by const reference. Reference arguments are kept as declared:
+/// declare an argument T && to move it to the visit methods.
+/// Can be specialized to change the policy of a type.
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+struct VisitorArgument
+{
+    static constexpr std::size_t MaxSizeByValue = 2u * sizeof(void *);
+
+    using Type = typename std::conditional<
+        std::is_trivially_copyable<T>::value && sizeof(T) <= MaxSizeByValue,
+        T, T const &
+    >::type;
+};
+
+template <typename T>
+struct VisitorArgument<T &>
+{
+    using Type = T &;
+};
+
+template <typename T>
+struct VisitorArgument<T &&>
+{
+    using Type = T &&;
+};
+
+template <typename T>
+using VisitorArgumentType = typename VisitorArgument<T>::Type;
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Forward an extra argument of a visitor to the next thunk or visit
+/// method (moved when passed by value or declared T &&).
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+inline VisitorArgumentType<T> && ForwardArgument(VisitorArgumentType<T> & arg)
+{
+    return static_cast<VisitorArgumentType<T> &&>(arg);
+}
+
+
+//! Sequence of indices used to unpack a tuple
+template <std::size_t ...Indices>
+struct IndexSequence { };
+
+template <std::size_t N, std::size_t ...Indices>
+struct MakeIndexSequence: MakeIndexSequence<N - 1, N - 1, Indices...> { };
+
+template <std::size_t ...Indices>
+struct MakeIndexSequence<0, Indices...>
+{
+    using Type = IndexSequence<Indices...>;
+};
+
+//! List of the arguments passed through the thunks of a visitor
+template <typename ...Args>
+struct ArgumentList { };
+
+//! Arguments of a thunk type: R (*)(Visitor &, Base &, Args...)
+template <typename Thunk>
+struct ThunkArguments;
+
+template <typename R, typename Visitor, typename Base, typename ...Args>
+struct ThunkArguments<R (*)(Visitor &, Base &, Args...)>
+{
+    using Type = ArgumentList<Args...>;
 };
 
+//! Tell whether every type of the list is the same as the first one
+template <typename ...Types>
+struct AllSame: std::true_type { };
+
+template <typename T, typename ...Tail>
+struct AllSame<T, T, Tail...>: AllSame<T, Tail...> { };
+
+template <typename T, typename U, typename ...Tail>
+struct AllSame<T, U, Tail...>: std::false_type { };
 
 // Thunk tag used to select non-empty variadic overload
 template <typename ...>
@@ -121,13 +985,25 @@ class VisitorVTableCreator
         ////////////////////////////////////////////////////////////////////////
         /// \brief Constructor.
         ////////////////////////////////////////////////////////////////////////
-        VisitorVTableCreator()
+        VisitorVTableCreator():
+            m_vtable(
+                RegisterVisitableTags<
+                    typename Visitor::BaseType, VisitedList...
+                >()
+            )
         {
             // Add Base's visit function to the vtable first
             this->addThunk<typename Visitor::BaseType>();
 
             // Add visit function for each type in VisitedList in the vtable
             this->addThunks(ThunkTag<VisitedList...>());
+
+#if META_VISITOR_INSTRUMENTATION
+            m_vtable.setStatsId(RegisterVisitorVTableStats<Visitor>(m_vtable));
+#endif
+
+            // Resolve the nearest ancestor of every other visitable ahead of time
+            m_vtable.resolveFallbacks();
         }
 
         ////////////////////////////////////////////////////////////////////////
@@ -168,42 +1044,191 @@ class VisitorVTableCreator
 template <typename Visitor, typename Invoker, typename ...VisitedList>
 struct GetVisitorVTable
 {
-    //! Static instance of vtable
-    static VisitorVTableCreator<Visitor, Invoker, VisitedList...> const s_table;
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief Return the static instance of vtable.
+    /// The vtable is built on first use (thread-safe), so a visitor can be
+    /// created from any thread or static initializer.
+    /// Not inline: a translation unit seeing META_ExternVisitorVTable does not
+    /// instantiate the vtable nor the thunks.
+    ////////////////////////////////////////////////////////////////////////////
+    static VisitorVTableCreator<Visitor, Invoker, VisitedList...> const & GetTable();
 
     ////////////////////////////////////////////////////////////////////////////
     /// \brief Return the vtable.
     ////////////////////////////////////////////////////////////////////////////
     operator typename Visitor::VTableType const *() const
     {
-        return &s_table.m_vtable;
+        return &GetTable().m_vtable;
     }
 };
 
 template <typename Visitor, typename Invoker, typename ...VisitedList>
-VisitorVTableCreator<Visitor, Invoker, VisitedList...> const
-GetVisitorVTable<Visitor, Invoker, VisitedList...>::s_table;
+VisitorVTableCreator<Visitor, Invoker, VisitedList...> const &
+GetVisitorVTable<Visitor, Invoker, VisitedList...>::GetTable()
+{
+    static VisitorVTableCreator<Visitor, Invoker, VisitedList...> const s_table;
+    return s_table;
+}
 
 
-//////////////////////////// INVOCATION INFO ///////////////////////////////////
+/////////////////////////////// BATCH VISIT ////////////////////////////////////
 
 ////////////////////////////////////////////////////////////////////////////////
-/// \brief Structure used by the visitor to get the entire information for
-/// making the call - the index to the function and the visitable.
-/// Allow fallback to base classes.
+/// \brief Return the visitable referenced by an element of a range: either a
+/// reference to a visitable or a pointer-like object (raw or smart pointer).
 ////////////////////////////////////////////////////////////////////////////////
-struct InvocationInfo
+template <typename Base>
+Base & ToVisitable(Base & b)
+{
+    return b;
+}
+
+template <typename Base, typename Pointer>
+auto ToVisitable(Pointer const & p) -> decltype(static_cast<Base &>(*p))
 {
-    std::size_t vtableIndex; ///< Index of the function in the vtable
-    void * visitable;        ///< Pointer to the visitable
+    return static_cast<Base &>(*p);
+}
 
-    InvocationInfo(std::size_t index, void * v):
-        vtableIndex(index), visitable(v)
-    {
+//! Tell whether an element of a range is a VisitableHandle
+template <typename Element>
+struct IsVisitableHandle: std::false_type { };
 
-    }
+template <typename Base>
+struct IsVisitableHandle<VisitableHandle<Base>>: std::true_type { };
+
+template <typename Base, typename Element>
+std::size_t GetElementTag(Element & element, std::false_type /* handle */)
+{
+    return GetDispatchTag(ToVisitable<Base>(element));
+}
+
+template <typename Base, typename Element>
+std::size_t GetElementTag(Element & element, std::true_type /* handle */)
+{
+    return element.tag();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Return the tag of the visitable referenced by an element of a range.
+/// The tag of a VisitableHandle is read from the handle, without touching the
+/// visitable.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base, typename Element>
+std::size_t GetElementTag(Element & element)
+{
+    using Handle = IsVisitableHandle<typename std::remove_const<Element>::type>;
+
+    return GetElementTag<Base>(element, Handle());
+}
+
+template <typename Base, typename Element>
+auto ToVisited(Element & element, std::false_type /* handle */)
+    -> decltype(ToVisitable<Base>(element))
+{
+    return ToVisitable<Base>(element);
+}
+
+template <typename Base, typename Element>
+Element & ToVisited(Element & element, std::true_type /* handle */)
+{
+    return element;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Return what a visitor is called with for an element of a range: the
+/// handle itself for a VisitableHandle (dispatched on its tag), the visitable
+/// otherwise.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base, typename Element>
+auto ToVisited(Element & element) -> decltype(
+    ToVisited<Base>(
+        element, IsVisitableHandle<typename std::remove_const<Element>::type>()
+    )
+)
+{
+    using Handle = IsVisitableHandle<typename std::remove_const<Element>::type>;
+
+    return ToVisited<Base>(element, Handle());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Visitables of a range grouped by vtable slot (i.e. by dynamic type).
+///
+/// The tags are read once (from the handles for a range of VisitableHandle)
+/// and the visitables are bucketed with a counting sort, so every bucket can be visited in a tight loop calling the same thunk.
+/// The index of every visitable in the original range is kept to write the
+/// results in the original order.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Base>
+class VisitableBuckets
+{
+    public:
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Constructor.
+        /// \param first  Beginning of the range of visitables.
+        /// \param last   End of the range of visitables.
+        /// \param vtable Vtable used to resolve the slots.
+        ////////////////////////////////////////////////////////////////////////
+        template <typename InputIt, typename VTable>
+        VisitableBuckets(InputIt first, InputIt last, VTable const & vtable):
+            m_offsets(vtable.size() + 1, 0u)
+        {
+            std::vector<Base *> visitables;
+            std::vector<std::size_t> slots;
+
+            for(; first != last; ++first)
+            {
+                auto && element = *first;
+                visitables.push_back(&ToVisitable<Base>(element));
+                slots.push_back(vtable.slot(GetElementTag<Base>(element)));
+            }
+
+            // Counting sort by slot (stable: keep the original order in buckets)
+            for(std::size_t slot : slots) ++m_offsets[slot + 1];
+
+            for(std::size_t slot = 1; slot < m_offsets.size(); ++slot)
+            {
+                m_offsets[slot] += m_offsets[slot - 1];
+            }
+
+            std::vector<std::size_t> next(m_offsets.begin(), m_offsets.end() - 1);
+
+            m_visitables.resize(visitables.size());
+            m_indices.resize(visitables.size());
+
+            for(std::size_t i = 0; i < visitables.size(); ++i)
+            {
+                std::size_t const position = next[slots[i]]++;
+                m_visitables[position] = visitables[i];
+                m_indices[position] = i;
+            }
+        }
+
+        //! Number of slots (buckets may be empty)
+        std::size_t slotCount() const { return m_offsets.size() - 1; }
+
+        //! Position of the first visitable of the bucket of the given slot
+        std::size_t begin(std::size_t slot) const { return m_offsets[slot]; }
+
+        //! Position past the last visitable of the bucket of the given slot
+        std::size_t end(std::size_t slot) const { return m_offsets[slot + 1]; }
+
+        //! Visitable at the given position
+        Base & visitable(std::size_t position) const { return *m_visitables[position]; }
+
+        //! Index in the original range of the visitable at the given position
+        std::size_t index(std::size_t position) const { return m_indices[position]; }
+
+        //! Number of visitables
+        std::size_t size() const { return m_visitables.size(); }
+
+    private:
+        std::vector<Base *> m_visitables;    ///< Visitables sorted by slot
+        std::vector<std::size_t> m_indices;  ///< Original index of the visitables
+        std::vector<std::size_t> m_offsets;  ///< Offsets of the buckets
 };
 
+
 } // visitor_details
 
 
@@ -0,0 +1,245 @@
+#ifndef VISITOR_STATS_HPP
+#define VISITOR_STATS_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+//! Record the dispatches of the visitors (1) or not (0, default).
+/// When disabled, the dispatch code is exactly the uninstrumented one, the
+/// statistics are not compiled and the dump API reports an empty, disabled
+/// set of statistics.
+#ifndef META_VISITOR_INSTRUMENTATION
+    #define META_VISITOR_INSTRUMENTATION 0
+#endif
+
+//! Also measure the latency of every instrumented dispatch in cycles (1) or
+/// not (0, default). Only used when META_VISITOR_INSTRUMENTATION is enabled.
+#ifndef META_VISITOR_INSTRUMENTATION_LATENCY
+    #define META_VISITOR_INSTRUMENTATION_LATENCY 0
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Write the dispatch statistics of every visitor as JSON:
+/// \code
+///     {
+///         "enabled": true, "latency": false,
+///         "visitors": [{
+///             "name": "ShapeVisitor", "dispatches": 42,
+///             "tags": [{"tag": 3, "handler": 2, "depth": 1, "hits": 40, "cycles": 0}, ...],
+///             "depthHistogram": [2, 40]
+///         }, ...]
+///     }
+/// \endcode
+/// For each dispatched tag: "handler" is the tag of the visit method called
+/// (the nearest visited ancestor) and "depth" the number of fallbacks from the
+/// dispatched tag to the handler. "depthHistogram" counts the dispatches by
+/// fallback depth.
+/// The counters are per thread: threads still dispatching may be partially
+/// accounted.
+////////////////////////////////////////////////////////////////////////////////
+void DumpVisitorStats(std::ostream & out);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Return the dispatch statistics as JSON (see DumpVisitorStats).
+////////////////////////////////////////////////////////////////////////////////
+std::string DumpVisitorStats();
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Export the hot visitables of every visitor from the dispatch
+/// statistics, as a header to include in the build:
+/// \code
+///     // ShapeVisitor: 2 hot visitables, 93.1% of 1234 dispatches
+///     #define META_HOT_VISITABLES_ShapeVisitor Circle, Polygon
+/// \endcode
+/// The macro can then be given to META_HotVisitables in the visitor.
+/// The hottest visitables are listed until they cover the given share of the
+/// dispatches of the visitor.
+/// \param out      Output stream.
+/// \param coverage Share of the dispatches to cover (in [0, 1]).
+/// \param maxCount Maximum number of hot visitables per visitor.
+////////////////////////////////////////////////////////////////////////////////
+void ExportHotVisitables(std::ostream & out, double coverage = 0.9, std::size_t maxCount = 4u);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Reset the dispatch statistics (dispatches running concurrently may
+/// be lost or kept).
+////////////////////////////////////////////////////////////////////////////////
+void ResetVisitorStats();
+
+
+#if META_VISITOR_INSTRUMENTATION
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace visitor_details {
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Counters of the dispatches of a (visitor, tag) pair.
+/// Only written by the thread owning them, so they are incremented without
+/// atomic read-modify-write (the atomics only allow concurrent dumps).
+////////////////////////////////////////////////////////////////////////////////
+struct DispatchCounters
+{
+    std::atomic<std::uint64_t> hits;
+    std::atomic<std::uint64_t> cycles;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Dispatch counters of a thread, indexed by visitor and by tag.
+/// The lock is only taken by the owning thread to grow the counters, and by
+/// the dumps.
+////////////////////////////////////////////////////////////////////////////////
+class ThreadDispatchStats
+{
+    public:
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the counters of the calling thread.
+        ////////////////////////////////////////////////////////////////////////
+        static ThreadDispatchStats & Local();
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Return the counters of a (visitor, tag) pair of the thread.
+        ////////////////////////////////////////////////////////////////////////
+        DispatchCounters & counters(std::size_t visitor, std::size_t tag)
+        {
+            if(visitor < m_visitors.size() && tag < m_visitors[visitor].size)
+            {
+                return m_visitors[visitor].counters[tag];
+            }
+
+            return this->grow(visitor, tag);
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Add the counters of a visitor to the given sums (indexed by
+        /// tag, grown if needed).
+        ////////////////////////////////////////////////////////////////////////
+        void accumulate(
+            std::size_t visitor,
+            std::vector<std::uint64_t> & hits,
+            std::vector<std::uint64_t> & cycles
+        );
+
+        ////////////////////////////////////////////////////////////////////////
+        /// \brief Reset the counters.
+        ////////////////////////////////////////////////////////////////////////
+        void reset();
+
+    private:
+        //! Counters of a visitor
+        struct VisitorCounters
+        {
+            std::unique_ptr<DispatchCounters[]> counters;
+            std::size_t size;
+        };
+
+        DispatchCounters & grow(std::size_t visitor, std::size_t tag);
+
+    private:
+        std::mutex m_mutex;                     ///< Protect the growth
+        std::vector<VisitorCounters> m_visitors; ///< Counters by visitor
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Static description of an instrumented visitor.
+////////////////////////////////////////////////////////////////////////////////
+struct VisitorStatsInfo
+{
+    std::string name;                  ///< Name of the visitor type
+    std::vector<std::size_t> handlers; ///< Handler tag of every slot
+    std::vector<std::size_t> depths;   ///< Fallback depth of every slot
+
+    //! Parent of a tag (for the tags registered after the vtable)
+    std::size_t (*parent)(std::size_t);
+
+    //! Name of the visitable class of a tag
+    std::string (*typeName)(std::size_t);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Registry of the instrumented visitors and of the thread counters.
+////////////////////////////////////////////////////////////////////////////////
+struct VisitorStatsRegistry
+{
+    std::mutex mutex;                                         ///< Protect the registry
+    std::vector<VisitorStatsInfo> visitors;                   ///< Visitors by id
+    std::vector<std::unique_ptr<ThreadDispatchStats>> threads; ///< Thread counters
+
+    static VisitorStatsRegistry & Get();
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Register an instrumented visitor.
+/// \return The id of the visitor.
+////////////////////////////////////////////////////////////////////////////////
+std::size_t RegisterVisitorStats(VisitorStatsInfo info);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Return the name of a type (demangled when possible).
+////////////////////////////////////////////////////////////////////////////////
+std::string TypeName(char const * mangled);
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Read the cycle counter (or a steady clock where unavailable).
+////////////////////////////////////////////////////////////////////////////////
+std::uint64_t ReadCycleCounter();
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Record a dispatch in the counters of the calling thread (and its
+/// latency until the end of the scope, if enabled).
+////////////////////////////////////////////////////////////////////////////////
+class DispatchProbe
+{
+    public:
+        DispatchProbe(std::size_t visitor, std::size_t tag);
+        ~DispatchProbe();
+
+        DispatchProbe(DispatchProbe const &) = delete;
+        DispatchProbe & operator=(DispatchProbe const &) = delete;
+
+#if META_VISITOR_INSTRUMENTATION_LATENCY
+    private:
+        // The counters are fetched again at the end: a nested dispatch may
+        // have grown them
+        std::size_t m_visitor; ///< Id of the visitor
+        std::size_t m_tag;     ///< Dispatched tag
+        std::uint64_t m_start; ///< Cycle counter at the dispatch
+#endif
+};
+
+} // visitor_details
+
+
+#include "VisitorStats.inl"
+
+#else
+
+inline void DumpVisitorStats(std::ostream & out)
+{
+    out << "{\"enabled\": false, \"latency\": false, \"visitors\": []}";
+}
+
+inline std::string DumpVisitorStats()
+{
+    return "{\"enabled\": false, \"latency\": false, \"visitors\": []}";
+}
+
+inline void ExportHotVisitables(std::ostream & out, double, std::size_t)
+{
+    out << "// Hot visitables exported from a dispatch profile"
+        << " (see META_HotVisitables)\n";
+}
+
+inline void ResetVisitorStats()
+{
+
+}
+
+#endif
+
+#endif //VISITOR_STATS_HPP
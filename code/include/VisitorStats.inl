@@ -0,0 +1,370 @@
+#ifndef VISITOR_STATS_INL
+#define VISITOR_STATS_INL
+
+#include "VisitorStats.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+#include <typeinfo>
+
+#if defined(__GNUG__)
+    #include <cxxabi.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #include <x86intrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+#endif
+
+namespace visitor_details {
+
+inline ThreadDispatchStats & ThreadDispatchStats::Local()
+{
+    static thread_local ThreadDispatchStats * s_local = nullptr;
+
+    if(!s_local)
+    {
+        // The registry owns the counters so they outlive their thread
+        VisitorStatsRegistry & registry = VisitorStatsRegistry::Get();
+
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.threads.emplace_back(new ThreadDispatchStats());
+        s_local = registry.threads.back().get();
+    }
+
+    return *s_local;
+}
+
+inline DispatchCounters & ThreadDispatchStats::grow(std::size_t visitor, std::size_t tag)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if(visitor >= m_visitors.size())
+    {
+        m_visitors.resize(visitor + 1);
+    }
+
+    VisitorCounters & counters = m_visitors[visitor];
+
+    if(tag >= counters.size)
+    {
+        std::size_t const size = tag + 1 > 2 * counters.size ? tag + 1 : 2 * counters.size;
+
+        std::unique_ptr<DispatchCounters[]> grown(new DispatchCounters[size]);
+
+        for(std::size_t i = 0; i < size; ++i)
+        {
+            std::uint64_t const hits = i < counters.size ?
+                counters.counters[i].hits.load(std::memory_order_relaxed) : 0u;
+            std::uint64_t const cycles = i < counters.size ?
+                counters.counters[i].cycles.load(std::memory_order_relaxed) : 0u;
+
+            grown[i].hits.store(hits, std::memory_order_relaxed);
+            grown[i].cycles.store(cycles, std::memory_order_relaxed);
+        }
+
+        counters.counters = std::move(grown);
+        counters.size = size;
+    }
+
+    return counters.counters[tag];
+}
+
+inline void ThreadDispatchStats::accumulate(
+    std::size_t visitor,
+    std::vector<std::uint64_t> & hits,
+    std::vector<std::uint64_t> & cycles
+)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if(visitor >= m_visitors.size()) return;
+
+    VisitorCounters const & counters = m_visitors[visitor];
+
+    if(counters.size > hits.size())
+    {
+        hits.resize(counters.size, 0u);
+        cycles.resize(counters.size, 0u);
+    }
+
+    for(std::size_t tag = 0; tag < counters.size; ++tag)
+    {
+        hits[tag] += counters.counters[tag].hits.load(std::memory_order_relaxed);
+        cycles[tag] += counters.counters[tag].cycles.load(std::memory_order_relaxed);
+    }
+}
+
+inline void ThreadDispatchStats::reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for(VisitorCounters & counters : m_visitors)
+    {
+        for(std::size_t tag = 0; tag < counters.size; ++tag)
+        {
+            counters.counters[tag].hits.store(0u, std::memory_order_relaxed);
+            counters.counters[tag].cycles.store(0u, std::memory_order_relaxed);
+        }
+    }
+}
+
+inline VisitorStatsRegistry & VisitorStatsRegistry::Get()
+{
+    static VisitorStatsRegistry s_registry;
+    return s_registry;
+}
+
+inline std::size_t RegisterVisitorStats(VisitorStatsInfo info)
+{
+    VisitorStatsRegistry & registry = VisitorStatsRegistry::Get();
+
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.visitors.push_back(std::move(info));
+
+    return registry.visitors.size() - 1;
+}
+
+inline std::string TypeName(char const * mangled)
+{
+#if defined(__GNUG__)
+    int status = 0;
+    char * demangled = abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+
+    if(status == 0 && demangled)
+    {
+        std::string name(demangled);
+        std::free(demangled);
+        return name;
+    }
+#endif
+
+    return mangled;
+}
+
+inline std::uint64_t ReadCycleCounter()
+{
+#if (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))) \
+    || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(
+        std::chrono::steady_clock::now().time_since_epoch().count()
+    );
+#endif
+}
+
+inline DispatchProbe::DispatchProbe(std::size_t visitor, std::size_t tag)
+#if META_VISITOR_INSTRUMENTATION_LATENCY
+    : m_visitor(visitor), m_tag(tag)
+#endif
+{
+    DispatchCounters & counters = ThreadDispatchStats::Local().counters(visitor, tag);
+
+    std::uint64_t const hits = counters.hits.load(std::memory_order_relaxed);
+    counters.hits.store(hits + 1u, std::memory_order_relaxed);
+
+#if META_VISITOR_INSTRUMENTATION_LATENCY
+    m_start = ReadCycleCounter();
+#endif
+}
+
+inline DispatchProbe::~DispatchProbe()
+{
+#if META_VISITOR_INSTRUMENTATION_LATENCY
+    std::uint64_t const end = ReadCycleCounter();
+
+    DispatchCounters & counters =
+        ThreadDispatchStats::Local().counters(m_visitor, m_tag);
+
+    std::uint64_t const cycles = counters.cycles.load(std::memory_order_relaxed);
+    counters.cycles.store(cycles + (end - m_start), std::memory_order_relaxed);
+#endif
+}
+
+//! Escape a string for JSON
+inline std::string JsonEscape(std::string const & s)
+{
+    std::string escaped;
+
+    for(char c : s)
+    {
+        if(c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+
+    return escaped;
+}
+
+} // visitor_details
+
+
+inline void DumpVisitorStats(std::ostream & out)
+{
+    using namespace visitor_details;
+
+    out << "{\"enabled\": true, \"latency\": "
+        << (META_VISITOR_INSTRUMENTATION_LATENCY ? "true" : "false")
+        << ", \"visitors\": [";
+
+    VisitorStatsRegistry & registry = VisitorStatsRegistry::Get();
+
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    for(std::size_t visitor = 0; visitor < registry.visitors.size(); ++visitor)
+    {
+        VisitorStatsInfo const & info = registry.visitors[visitor];
+
+        // Sum the counters of every thread
+        std::vector<std::uint64_t> hits;
+        std::vector<std::uint64_t> cycles;
+
+        for(std::unique_ptr<ThreadDispatchStats> const & thread : registry.threads)
+        {
+            thread->accumulate(visitor, hits, cycles);
+        }
+
+        std::uint64_t dispatches = 0u;
+        std::vector<std::uint64_t> histogram;
+        std::ostringstream tags;
+
+        for(std::size_t tag = 0; tag < hits.size(); ++tag)
+        {
+            if(hits[tag] == 0u) continue;
+
+            // Walk up the tags registered after the vtable to a slot
+            std::size_t slot = tag;
+            std::size_t depth = 0u;
+
+            while(slot >= info.depths.size())
+            {
+                slot = info.parent(slot);
+                ++depth;
+            }
+
+            depth += info.depths[slot];
+
+            if(depth >= histogram.size()) histogram.resize(depth + 1, 0u);
+            histogram[depth] += hits[tag];
+            dispatches += hits[tag];
+
+            tags << (tags.tellp() > 0 ? ", " : "")
+                 << "{\"tag\": " << tag
+                 << ", \"type\": \"" << JsonEscape(info.typeName(tag)) << "\""
+                 << ", \"handler\": " << info.handlers[slot]
+                 << ", \"depth\": " << depth
+                 << ", \"hits\": " << hits[tag]
+                 << ", \"cycles\": " << cycles[tag] << "}";
+        }
+
+        out << (visitor > 0 ? ", " : "")
+            << "{\"name\": \"" << JsonEscape(info.name) << "\""
+            << ", \"dispatches\": " << dispatches
+            << ", \"tags\": [" << tags.str() << "]"
+            << ", \"depthHistogram\": [";
+
+        for(std::size_t depth = 0; depth < histogram.size(); ++depth)
+        {
+            out << (depth > 0 ? ", " : "") << histogram[depth];
+        }
+
+        out << "]}";
+    }
+
+    out << "]}";
+}
+
+inline std::string DumpVisitorStats()
+{
+    std::ostringstream out;
+    DumpVisitorStats(out);
+
+    return out.str();
+}
+
+inline void ExportHotVisitables(std::ostream & out, double coverage, std::size_t maxCount)
+{
+    using namespace visitor_details;
+
+    out << "// Hot visitables exported from a dispatch profile"
+        << " (see META_HotVisitables)\n";
+
+    VisitorStatsRegistry & registry = VisitorStatsRegistry::Get();
+
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    for(std::size_t visitor = 0; visitor < registry.visitors.size(); ++visitor)
+    {
+        VisitorStatsInfo const & info = registry.visitors[visitor];
+
+        std::vector<std::uint64_t> hits;
+        std::vector<std::uint64_t> cycles;
+
+        for(std::unique_ptr<ThreadDispatchStats> const & thread : registry.threads)
+        {
+            thread->accumulate(visitor, hits, cycles);
+        }
+
+        std::uint64_t dispatches = 0u;
+        std::vector<std::size_t> tags;
+
+        for(std::size_t tag = 0; tag < hits.size(); ++tag)
+        {
+            dispatches += hits[tag];
+            if(hits[tag] > 0u) tags.push_back(tag);
+        }
+
+        if(dispatches == 0u) continue;
+
+        // Hottest first
+        std::sort(tags.begin(), tags.end(), [&](std::size_t a, std::size_t b)
+        {
+            return hits[a] > hits[b];
+        });
+
+        std::uint64_t covered = 0u;
+        std::string list;
+        std::size_t count = 0u;
+
+        for(std::size_t tag : tags)
+        {
+            if(count == maxCount || covered >= coverage * dispatches) break;
+
+            list += (count > 0u ? ", " : "") + info.typeName(tag);
+            covered += hits[tag];
+            ++count;
+        }
+
+        // Macro name from the visitor name
+        std::string macro = "META_HOT_VISITABLES_";
+        for(char c : info.name)
+        {
+            macro += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+        }
+
+        out << "// " << info.name << ": " << count << " hot visitables, "
+            << 100.0 * covered / dispatches << "% of " << dispatches
+            << " dispatches\n"
+            << "#define " << macro << " " << list << "\n";
+    }
+}
+
+inline void ResetVisitorStats()
+{
+    using namespace visitor_details;
+
+    VisitorStatsRegistry & registry = VisitorStatsRegistry::Get();
+
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    for(std::unique_ptr<ThreadDispatchStats> const & thread : registry.threads)
+    {
+        thread->reset();
+    }
+}
+
+#endif //VISITOR_STATS_INL
@@ -1,7 +1,10 @@
 #include <cassert>
 #include <iostream>
+#include <iterator>
 #include <string>
 
+#include <ClosedVisitor.hpp>
+#include <ClosedVisitable.hpp>
 #include <Visitor.hpp>
 #include <Visitable.hpp>
 
@@ -185,6 +188,56 @@ class VariadicVisitor : public Visitor<Node, int, int, std::string const &>
         }
 };
 
+class Sprite;
+class AnimatedSprite;
+class Text;
+
+using ItemHierarchy = VisitableHierarchy<Sprite, AnimatedSprite, Text>;
+
+class Sprite : public ClosedVisitable<ItemHierarchy>
+{
+    public:
+        META_BaseVisitable(Sprite)
+};
+
+class AnimatedSprite : public Sprite
+{
+    public:
+        META_Visitable(AnimatedSprite, Sprite)
+};
+
+class Text : public Sprite
+{
+    public:
+        META_Visitable(Text, Sprite)
+};
+
+class ItemVisitor : public ClosedVisitor<ItemHierarchy, int, int>
+{
+    public:
+        META_Visitor(ItemVisitor, render)
+
+        ItemVisitor()
+        {
+            META_Visitables(Text);
+        }
+
+    protected:
+        int render(Sprite & sprite, int layer)
+        {
+            std::cout << "ItemVisitor::render(Sprite = " << &sprite << ", "
+                      << layer << ")" << std::endl;
+            return layer;
+        }
+
+        int render(Text & text, int layer)
+        {
+            std::cout << "ItemVisitor::render(Text = " << &text << ", "
+                      << layer << ")" << std::endl;
+            return layer + 1;
+        }
+};
+
 int main(int argc, char const ** argv)
 {
     Shape shape;
@@ -204,6 +257,14 @@ int main(int argc, char const ** argv)
 
     std::cout << std::endl;
 
+    // Batch visitation (grouped by dynamic type, results in the original order)
+    Shape * shapes[] = { &ppp, &shape, &circle, &polygon, &pp };
+    bool results[5];
+    sv.transformRange(std::begin(shapes), std::end(shapes), results);
+    assert(results[0] && !results[1] && results[2] && results[3] && results[4]);
+
+    std::cout << std::endl;
+
     Node node;
     Group group;
     List list;
@@ -247,5 +308,16 @@ int main(int argc, char const ** argv)
     i = varv(group, 2, "group"); assert(i == 4);
     i = varv(list, 3, "list");  assert(i == 5);
 
+    std::cout << std::endl;
+
+    Sprite sprite;
+    AnimatedSprite animatedSprite;
+    Text text;
+
+    ItemVisitor iv;
+    i = iv(sprite, 1);         assert(i == 1);
+    i = iv(animatedSprite, 2); assert(i == 2);
+    i = iv(text, 3);           assert(i == 4);
+
     return 0;
 }
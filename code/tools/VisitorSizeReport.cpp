@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Size report: bytes of thunks and vtables per visitor in a binary, read from
+// the symbols listed by nm (sizes and demangled names).
+// Usage: VisitorSizeReport <binary> [nm]
+//
+// The thunks are the symbols ...::thunk<VisitorImpl, ...>, the vtables are the
+// symbols of the vtable creators and getters (code, static tables and guard
+// variables), both reported under their first template argument. The thunks
+// folded by the linker (see the CMake option VISITOR_FOLD_THUNKS) share their
+// address: the bytes of an address are counted once, under the first visitor
+// listing it.
+
+//! Sizes of the symbols of a visitor
+struct VisitorSizes
+{
+    std::size_t thunks = 0u;       ///< Number of thunks
+    std::size_t foldedThunks = 0u; ///< Thunks sharing the address of another
+    std::size_t thunkBytes = 0u;   ///< Bytes of code of the thunks
+    std::size_t vtableBytes = 0u;  ///< Bytes of code and data of the vtables
+};
+
+//! Symbol listed by nm
+struct Symbol
+{
+    std::string address;
+    std::size_t size;
+    std::string name;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Return the first template argument of the template whose arguments
+/// start at the given position (after the '<').
+////////////////////////////////////////////////////////////////////////////////
+static std::string FirstTemplateArgument(std::string const & name, std::size_t begin)
+{
+    int depth = 0;
+
+    for(std::size_t i = begin; i < name.size(); ++i)
+    {
+        char const c = name[i];
+
+        if(c == '<' || c == '(') ++depth;
+        else if(c == '>' || c == ')')
+        {
+            if(depth == 0) return name.substr(begin, i - begin);
+            --depth;
+        }
+        else if(c == ',' && depth == 0) return name.substr(begin, i - begin);
+    }
+
+    return name.substr(begin);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Return the position after the '<' of the vtable template named in
+/// the symbol (or npos).
+////////////////////////////////////////////////////////////////////////////////
+static std::size_t FindVTableArguments(std::string const & name)
+{
+    static char const * const Templates[] = {
+        "VisitorVTableCreator<", "GetVisitorVTable<",
+        "GetClosedVisitorVTable<",
+        "MultiVisitorVTableCreator<", "GetMultiVisitorVTable<"
+    };
+
+    std::size_t found = std::string::npos;
+
+    for(char const * vtable : Templates)
+    {
+        std::size_t const position = name.find(std::string("visitor_details::") + vtable);
+
+        if(position < found)
+        {
+            found = position + std::string("visitor_details::").size() +
+                std::string(vtable).size();
+        }
+    }
+
+    return found;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief List the symbols of the binary with their size.
+////////////////////////////////////////////////////////////////////////////////
+static bool ListSymbols(
+    std::string const & binary, std::string const & nm, std::vector<Symbol> & symbols
+)
+{
+    std::string const command = nm + " -C -S --size-sort \"" + binary + "\"";
+
+    FILE * pipe = popen(command.c_str(), "r");
+    if(!pipe) return false;
+
+    std::string line;
+    char buffer[4096];
+
+    while(std::fgets(buffer, sizeof(buffer), pipe))
+    {
+        line += buffer;
+        if(line.empty() || line.back() != '\n') continue;
+
+        // address size type name
+        std::istringstream stream(line);
+        std::string address, size, type;
+
+        if(stream >> address >> size >> type)
+        {
+            Symbol symbol;
+            symbol.address = address;
+            symbol.size = std::stoul(size, nullptr, 16);
+            std::getline(stream >> std::ws, symbol.name);
+
+            symbols.push_back(symbol);
+        }
+
+        line.clear();
+    }
+
+    return pclose(pipe) == 0;
+}
+
+int main(int argc, char ** argv)
+{
+    if(argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <binary> [nm]" << std::endl;
+        return 1;
+    }
+
+    std::vector<Symbol> symbols;
+
+    if(!ListSymbols(argv[1], argc > 2 ? argv[2] : "nm", symbols))
+    {
+        std::cerr << "Failed to list the symbols of " << argv[1] << std::endl;
+        return 1;
+    }
+
+    // Count each address once (the folded symbols share it)
+    std::sort(symbols.begin(), symbols.end(), [](Symbol const & a, Symbol const & b)
+    {
+        return a.address < b.address;
+    });
+
+    std::map<std::string, VisitorSizes> visitors;
+    std::set<std::string> addresses;
+
+    for(Symbol const & symbol : symbols)
+    {
+        std::size_t const thunk = symbol.name.find("::thunk<");
+        std::size_t const vtable = FindVTableArguments(symbol.name);
+
+        if(thunk == std::string::npos && vtable == std::string::npos) continue;
+
+        bool const folded = !addresses.insert(symbol.address).second;
+        std::size_t const bytes = folded ? 0u : symbol.size;
+
+        if(thunk != std::string::npos && thunk < vtable)
+        {
+            VisitorSizes & sizes =
+                visitors[FirstTemplateArgument(symbol.name, thunk + 8u)];
+
+            ++sizes.thunks;
+            if(folded) ++sizes.foldedThunks;
+            sizes.thunkBytes += bytes;
+        }
+        else
+        {
+            visitors[FirstTemplateArgument(symbol.name, vtable)].vtableBytes += bytes;
+        }
+    }
+
+    // Largest visitors first
+    std::vector<std::pair<std::string, VisitorSizes>> sorted(visitors.begin(), visitors.end());
+
+    std::stable_sort(sorted.begin(), sorted.end(), [](
+        std::pair<std::string, VisitorSizes> const & a,
+        std::pair<std::string, VisitorSizes> const & b
+    )
+    {
+        return a.second.thunkBytes + a.second.vtableBytes >
+            b.second.thunkBytes + b.second.vtableBytes;
+    });
+
+    VisitorSizes total;
+
+    std::cout << std::setw(10) << "thunks" << std::setw(10) << "folded"
+              << std::setw(14) << "thunk bytes" << std::setw(14) << "vtable bytes"
+              << "  visitor" << std::endl;
+
+    for(std::pair<std::string, VisitorSizes> const & visitor : sorted)
+    {
+        VisitorSizes const & sizes = visitor.second;
+
+        std::cout << std::setw(10) << sizes.thunks << std::setw(10) << sizes.foldedThunks
+                  << std::setw(14) << sizes.thunkBytes << std::setw(14) << sizes.vtableBytes
+                  << "  " << visitor.first << std::endl;
+
+        total.thunks += sizes.thunks;
+        total.foldedThunks += sizes.foldedThunks;
+        total.thunkBytes += sizes.thunkBytes;
+        total.vtableBytes += sizes.vtableBytes;
+    }
+
+    std::cout << std::setw(10) << total.thunks << std::setw(10) << total.foldedThunks
+              << std::setw(14) << total.thunkBytes << std::setw(14) << total.vtableBytes
+              << "  total (" << visitors.size() << " visitors)" << std::endl;
+
+    return 0;
+}